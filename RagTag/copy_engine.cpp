@@ -0,0 +1,981 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "copy_engine.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <memory>
+#include <set>
+#include <zlib.h>
+
+#ifdef __linux__
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <winioctl.h>
+#endif
+
+namespace {
+  // Runs a function on each index in [0, count) using up to `num_threads` threads, including the
+  // calling thread. Each thread gets its own scratch buffer.
+  void forEachInParallel(const std::size_t count, const int num_threads,
+    const std::function<void(std::size_t, std::vector<char>&)>& function) {
+    std::atomic<std::size_t> next_index{ 0 };
+    const auto work = [&]() {
+      std::vector<char> buffer;
+      for (std::size_t i = next_index++; i < count; i = next_index++) {
+        function(i, buffer);
+      }
+      };
+    const std::size_t num_workers = std::clamp(static_cast<std::size_t>(num_threads),
+      static_cast<std::size_t>(1), std::max(count, static_cast<std::size_t>(1)));
+    std::vector<std::thread> threads;
+    threads.reserve(num_workers - 1);
+    for (std::size_t i = 1; i < num_workers; ++i) {
+      threads.emplace_back(work);
+    }
+    work();  // This thread does its share too.
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  // Folds data into a running CRC-32 on another thread, leaving the caller free to carry on with
+  // I/O. The data must be left alone until the result is obtained.
+  std::future<std::uint32_t> updateCrc32Async(const std::uint32_t crc, const char* const data,
+    const std::size_t size) {
+    return std::async(std::launch::async, [crc, data, size]() {
+      return static_cast<std::uint32_t>(crc32_z(crc, reinterpret_cast<const Bytef*>(data), size));
+      });
+  }
+
+#ifdef __linux__
+  // Owns a file descriptor, closing it when destroyed.
+  class FileDescriptor {
+  public:
+    explicit FileDescriptor(const int fd) : fd_(fd) {}
+    ~FileDescriptor() {
+      if (fd_ >= 0) {
+        close(fd_);
+      }
+    }
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+    int get() const {
+      return fd_;
+    }
+
+    // Closes the descriptor ahead of destruction. Returns false if closing failed, which is how
+    // errors from delayed writes (notably on network shares) come to light.
+    bool closeNow() {
+      const int fd = fd_;
+      fd_ = -1;
+      return ::close(fd) == 0;
+    }
+
+  private:
+    int fd_;
+  };
+
+  // Checks whether a failed kernel copy call means the call can't handle this pair of files, as
+  // opposed to a genuine I/O error.
+  bool isUnsupported(const int error_number) {
+    return error_number == ENOSYS || error_number == EXDEV || error_number == EINVAL
+      || error_number == EOPNOTSUPP;
+  }
+
+  std::error_code lastError() {
+    return std::error_code(errno, std::generic_category());
+  }
+#elif defined(_WIN32)
+  // Largest size passed to ReadFile() or WriteFile() at once.
+  const std::size_t MAX_REQUEST_SIZE = 1 << 30;
+
+  // Alignment of the memory and sizes of unbuffered reads. Sectors never exceed this size.
+  const std::size_t UNBUFFERED_ALIGNMENT = 64 << 10;
+
+  // Owns a file handle, closing it when destroyed.
+  class FileHandle {
+  public:
+    explicit FileHandle(const HANDLE handle) : handle_(handle) {}
+    ~FileHandle() {
+      if (isValid()) {
+        CloseHandle(handle_);
+      }
+    }
+    FileHandle(const FileHandle&) = delete;
+    FileHandle& operator=(const FileHandle&) = delete;
+
+    HANDLE get() const {
+      return handle_;
+    }
+
+    bool isValid() const {
+      return handle_ != INVALID_HANDLE_VALUE;
+    }
+
+    // Closes the handle ahead of destruction. Returns false if closing failed, which is how
+    // errors from delayed writes (notably on network shares) come to light.
+    bool closeNow() {
+      const HANDLE handle = handle_;
+      handle_ = INVALID_HANDLE_VALUE;
+      return CloseHandle(handle) != 0;
+    }
+
+  private:
+    HANDLE handle_;
+  };
+
+  std::error_code lastError() {
+    const DWORD error_number = GetLastError();
+    // Callers compare against these conditions, which the system category doesn't map reliably.
+    if (error_number == ERROR_FILE_EXISTS || error_number == ERROR_ALREADY_EXISTS) {
+      return std::make_error_code(std::errc::file_exists);
+    }
+    if (error_number == ERROR_REQUEST_ABORTED) {
+      return std::make_error_code(std::errc::operation_canceled);
+    }
+    return std::error_code(static_cast<int>(error_number), std::system_category());
+  }
+
+  // Largest region cloned by one FSCTL_DUPLICATE_EXTENTS_TO_FILE request, which mustn't exceed
+  // 4 GB. Being a power of two, it's a whole number of clusters of any volume.
+  const std::uintmax_t MAX_CLONE_SIZE = 1 << 30;
+
+  // Finds the cluster size of the volume holding a directory. Returns an empty optional (leaving
+  // the reason to GetLastError()) if it can't be determined.
+  std::optional<std::uintmax_t> getClusterSize(const std::filesystem::path& directory) {
+    wchar_t volume[MAX_PATH + 1] = {};
+    DWORD sectors_per_cluster = 0;
+    DWORD bytes_per_sector = 0;
+    DWORD num_free_clusters = 0;
+    DWORD num_clusters = 0;
+    if (!GetVolumePathNameW(directory.c_str(), volume, MAX_PATH + 1)
+      || !GetDiskFreeSpaceW(volume, &sectors_per_cluster, &bytes_per_sector, &num_free_clusters,
+        &num_clusters)) {
+      return {};
+    }
+    return static_cast<std::uintmax_t>(sectors_per_cluster) * bytes_per_sector;
+  }
+
+  // State shared with reportCopyProgress() during a call to CopyFileExW().
+  struct CopyProgressContext {
+    std::atomic<std::uintmax_t>* bytes_done;
+    const std::atomic<bool>* is_canceled;
+    std::uintmax_t* bytes_copied;
+  };
+
+  // Progress routine for CopyFileExW(), which adds each step to the batch's running total and
+  // cancels the copy if the batch was canceled.
+  DWORD CALLBACK reportCopyProgress(const LARGE_INTEGER, const LARGE_INTEGER total_transferred,
+    const LARGE_INTEGER, const LARGE_INTEGER, const DWORD, const DWORD, const HANDLE, const HANDLE,
+    const LPVOID data) {
+    auto& context = *static_cast<CopyProgressContext*>(data);  // Alias for convenience
+    const auto transferred = static_cast<std::uintmax_t>(total_transferred.QuadPart);
+    *context.bytes_done += transferred - *context.bytes_copied;
+    *context.bytes_copied = transferred;
+    return *context.is_canceled ? PROGRESS_CANCEL : PROGRESS_CONTINUE;
+  }
+#endif
+}  // namespace
+
+namespace ragtag {
+  int CopyReport::count(const CopyOutcome outcome) const {
+    return static_cast<int>(std::count_if(results.begin(), results.end(),
+      [outcome](const CopyResult& result) {
+        return result.outcome == outcome;
+      }));
+  }
+
+  CopyEngine::CopyEngine(const CopyOptions& options) : options_(options) {}
+
+  CopyEngine::~CopyEngine() {
+    cancel();
+    if (coordinator_.joinable()) {
+      coordinator_.join();
+    }
+  }
+
+  void CopyEngine::start(std::vector<CopyJob> jobs) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (is_running_) {
+        return;
+      }
+      is_running_ = true;
+    }
+    if (coordinator_.joinable()) {
+      coordinator_.join();
+    }
+
+    is_canceled_ = false;
+    bytes_done_ = 0;
+    bytes_total_ = 0;
+    files_done_ = 0;
+    files_total_ = static_cast<int>(jobs.size());
+    report_ = CopyReport();
+    report_.results.reserve(jobs.size());
+    std::set<path_t> destinations;
+    for (auto& job : jobs) {
+      CopyResult result;
+      result.job = std::move(job);
+      if (!destinations.insert(result.job.destination.lexically_normal()).second) {
+        // An earlier job claims this destination, and copies never replace one another.
+        result.outcome = CopyOutcome::CONFLICTED;
+        ++files_done_;
+      }
+      report_.results.push_back(std::move(result));
+    }
+
+    coordinator_ = std::thread(&CopyEngine::runBatch, this);
+  }
+
+  bool CopyEngine::waitFor(const std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return finished_.wait_for(lock, timeout, [this]() {return !is_running_;});
+  }
+
+  CopyProgress CopyEngine::getProgress() const {
+    CopyProgress progress;
+    progress.bytes_done = bytes_done_;
+    progress.bytes_total = bytes_total_;
+    progress.files_done = files_done_;
+    progress.files_total = files_total_;
+    return progress;
+  }
+
+  void CopyEngine::cancel() {
+    is_canceled_ = true;
+  }
+
+  CopyReport CopyEngine::takeReport() {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      finished_.wait(lock, [this]() {return !is_running_;});
+    }
+    if (coordinator_.joinable()) {
+      coordinator_.join();
+    }
+    CopyReport report = std::move(report_);
+    report_ = CopyReport();
+    return report;
+  }
+
+  CopyReport CopyEngine::run(std::vector<CopyJob> jobs, const CopyOptions& options) {
+    CopyEngine engine(options);
+    engine.start(std::move(jobs));
+    return engine.takeReport();
+  }
+
+  bool CopyEngine::writeManifest(const CopyReport& report, const path_t& manifest) {
+    std::ofstream file(manifest, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      return false;
+    }
+    file << "; Generated by RagTag\n";
+    file << std::uppercase << std::hex << std::setfill('0');
+    const path_t base = manifest.parent_path();
+    for (const auto& result : report.results) {
+      const bool is_listed = result.checksum.has_value()
+        && (result.outcome == CopyOutcome::COPIED || result.outcome == CopyOutcome::SKIPPED);
+      if (!is_listed) {
+        continue;
+      }
+      path_t name = base.empty() ? path_t() : result.job.destination.lexically_relative(base);
+      if (name.empty() || *name.begin() == "..") {
+        name = result.job.destination;
+      }
+      const std::u8string utf8_name = name.generic_u8string();
+      file << std::string(utf8_name.begin(), utf8_name.end()) << ' ' << std::setw(8)
+        << *result.checksum << '\n';
+    }
+    file.flush();
+    return static_cast<bool>(file);
+  }
+
+  void CopyEngine::runBatch() {
+    auto& results = report_.results;  // Alias for convenience
+
+    // Measure every source up front so that progress can be reported in bytes. Sources that can't
+    // be measured can't be copied either.
+    std::vector<std::uintmax_t> sizes(results.size(), 0);
+    forEachInParallel(results.size(), options_.num_threads,
+      [&](const std::size_t i, std::vector<char>&) {
+        if (results[i].outcome != CopyOutcome::CANCELED) {
+          return;
+        }
+        std::error_code error;
+        const auto size = std::filesystem::file_size(results[i].job.source, error);
+        if (error) {
+          results[i].outcome = CopyOutcome::FAILED;
+          results[i].error = error;
+          ++files_done_;
+          return;
+        }
+        results[i].bytes = size;
+        sizes[i] = size;
+      });
+    std::uintmax_t bytes_total = 0;
+    for (const auto size : sizes) {
+      bytes_total += size;
+    }
+    // Verified files are read back in full after being copied.
+    bytes_total_ = options_.verify ? 2 * bytes_total : bytes_total;
+
+    // Create the directories the destinations need once each, up front, rather than checking for
+    // them file by file.
+    std::set<path_t> destination_directories;
+    for (const auto& result : results) {
+      if (result.outcome == CopyOutcome::CANCELED) {
+        destination_directories.insert(result.job.destination.parent_path());
+      }
+    }
+    for (const auto& directory : destination_directories) {
+      std::error_code error;
+      if (!directory.empty()) {
+        // Failure surfaces as failed copies of the files bound for this directory.
+        std::filesystem::create_directories(directory, error);
+      }
+    }
+
+    forEachInParallel(results.size(), options_.num_threads,
+      [&](const std::size_t i, std::vector<char>& buffer) {
+        if (results[i].outcome == CopyOutcome::CANCELED && !is_canceled_) {
+          copyFile(results[i], buffer);
+        }
+      });
+
+    report_.was_canceled = is_canceled_ && report_.count(CopyOutcome::CANCELED) > 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      is_running_ = false;
+    }
+    finished_.notify_all();
+  }
+
+  void CopyEngine::copyFile(CopyResult& result, std::vector<char>& buffer) {
+    const CopyJob& job = result.job;  // Alias for convenience
+    // A verified file is read twice: once to copy it and once to check the copy.
+    const std::uintmax_t bytes_share = options_.verify ? 2 * result.bytes : result.bytes;
+    // This file's contribution to `bytes_done_` so far.
+    std::uintmax_t bytes_counted = 0;
+    std::error_code error;
+    const auto source_write_time = std::filesystem::last_write_time(job.source, error);
+
+    const auto finish = [&](const CopyOutcome outcome) {
+      result.outcome = outcome;
+      // Whatever was counted along the way, a finished file counts once, in full, and a canceled
+      // file not at all.
+      bytes_done_ -= bytes_counted;
+      if (outcome != CopyOutcome::CANCELED) {
+        bytes_done_ += bytes_share;
+      }
+      ++files_done_;
+      };
+
+    if (error) {
+      result.error = error;
+      finish(CopyOutcome::FAILED);
+      return;
+    }
+
+    std::error_code status_error;
+    if (std::filesystem::exists(job.destination, status_error)) {
+      std::error_code size_error;
+      std::error_code time_error;
+      bool is_identical = options_.skip_identical
+        && std::filesystem::is_regular_file(job.destination, status_error)
+        && std::filesystem::file_size(job.destination, size_error) == result.bytes && !size_error
+        && std::filesystem::last_write_time(job.destination, time_error) == source_write_time
+        && !time_error;
+      if (is_identical && options_.verify) {
+        // Matching sizes and timestamps don't prove matching contents, so compare both files in
+        // full, reading them side by side.
+        std::uintmax_t source_bytes_read = 0;
+        std::error_code source_error;
+        auto source_checksum = std::async(std::launch::async, [&]() {
+          std::vector<char> source_buffer;
+          return checksumFile(job.source, source_buffer, source_bytes_read, source_error);
+          });
+        std::uintmax_t destination_bytes_read = 0;
+        result.destination_checksum = checksumFile(job.destination, buffer,
+          destination_bytes_read, error);
+        result.checksum = source_checksum.get();
+        bytes_counted += source_bytes_read + destination_bytes_read;
+        if (source_error == std::errc::operation_canceled
+          || error == std::errc::operation_canceled) {
+          finish(CopyOutcome::CANCELED);
+          return;
+        }
+        if (source_error) {
+          result.error = source_error;
+          finish(CopyOutcome::FAILED);
+          return;
+        }
+        // A destination that can't be read is treated as a different file.
+        is_identical = result.destination_checksum.has_value()
+          && result.destination_checksum == result.checksum;
+      }
+      finish(is_identical ? CopyOutcome::SKIPPED : CopyOutcome::CONFLICTED);
+      return;
+    }
+
+    if (options_.mode != CopyMode::COPY) {
+      if (linkFile(job, options_.mode, error)) {
+        result.mode = options_.mode;
+        if (options_.mode == CopyMode::REFLINK) {
+          std::error_code time_error;
+          std::filesystem::last_write_time(job.destination, source_write_time, time_error);
+        }
+        if (options_.verify) {
+          // A link shares its source's data, so reading it once serves as both checksums.
+          std::uintmax_t bytes_read = 0;
+          result.checksum = checksumFile(job.destination, buffer, bytes_read, error);
+          result.destination_checksum = result.checksum;
+          bytes_counted += bytes_read;
+          if (!result.checksum.has_value()) {
+            std::error_code remove_error;
+            std::filesystem::remove(job.destination, remove_error);
+            if (error == std::errc::operation_canceled) {
+              finish(CopyOutcome::CANCELED);
+              return;
+            }
+            result.error = error;
+            finish(CopyOutcome::FAILED);
+            return;
+          }
+        }
+        finish(CopyOutcome::COPIED);
+        return;
+      }
+      if (error == std::errc::file_exists) {
+        finish(CopyOutcome::CONFLICTED);
+        return;
+      }
+      result.fallback_reason = error;
+      error.clear();
+    }
+
+    std::uintmax_t bytes_copied = 0;
+    const bool is_copied = copyContents(job, buffer, bytes_copied, result.checksum, error);
+    bytes_counted += bytes_copied;
+    if (!is_copied) {
+      if (error == std::errc::file_exists) {
+        // Something appeared at the destination since we checked.
+        finish(CopyOutcome::CONFLICTED);
+        return;
+      }
+      std::error_code remove_error;
+      std::filesystem::remove(job.destination, remove_error);
+      if (error == std::errc::operation_canceled) {
+        finish(CopyOutcome::CANCELED);
+        return;
+      }
+      result.error = error;
+      finish(CopyOutcome::FAILED);
+      return;
+    }
+
+    if (options_.verify) {
+      std::uintmax_t bytes_read = 0;
+      result.destination_checksum = checksumFile(job.destination, buffer, bytes_read, error);
+      bytes_counted += bytes_read;
+      if (result.destination_checksum != result.checksum) {
+        // A bad copy must not survive to be skipped as identical if the export is run again.
+        std::error_code remove_error;
+        std::filesystem::remove(job.destination, remove_error);
+        if (error == std::errc::operation_canceled) {
+          finish(CopyOutcome::CANCELED);
+          return;
+        }
+        if (error) {
+          result.error = error;
+          finish(CopyOutcome::FAILED);
+          return;
+        }
+        finish(CopyOutcome::MISMATCHED);
+        return;
+      }
+    }
+
+    // Matching timestamps let skip_identical recognize this copy if the export is run again.
+    std::error_code time_error;
+    std::filesystem::last_write_time(job.destination, source_write_time, time_error);
+    finish(CopyOutcome::COPIED);
+  }
+
+  bool CopyEngine::linkFile(const CopyJob& job, const CopyMode mode, std::error_code& error) {
+    switch (mode) {
+    case CopyMode::HARD_LINK:
+      std::filesystem::create_hard_link(job.source, job.destination, error);
+      return !error;
+    case CopyMode::SYMBOLIC_LINK: {
+      const path_t target = std::filesystem::absolute(job.source, error);
+      if (error) {
+        return false;
+      }
+      std::filesystem::create_symlink(target, job.destination, error);
+      return !error;
+    }
+    case CopyMode::REFLINK: {
+#ifdef __linux__
+      const FileDescriptor source(open(job.source.c_str(), O_RDONLY | O_CLOEXEC));
+      struct stat source_stat {};
+      if (source.get() < 0 || fstat(source.get(), &source_stat) != 0) {
+        error = lastError();
+        return false;
+      }
+      FileDescriptor destination(open(job.destination.c_str(),
+        O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, source_stat.st_mode & 0777));
+      if (destination.get() < 0) {
+        error = lastError();
+        return false;
+      }
+      if (ioctl(destination.get(), FICLONE, source.get()) != 0 || !destination.closeNow()) {
+        error = lastError();
+        std::error_code remove_error;
+        std::filesystem::remove(job.destination, remove_error);
+        return false;
+      }
+      return true;
+#elif defined(_WIN32)
+      // Block cloning (as on ReFS volumes) shares the source's clusters with the destination.
+      const FileHandle source(CreateFileW(job.source.c_str(), GENERIC_READ, FILE_SHARE_READ,
+        nullptr, OPEN_EXISTING, 0, nullptr));
+      LARGE_INTEGER source_size{};
+      BY_HANDLE_FILE_INFORMATION source_info{};
+      if (!source.isValid() || !GetFileSizeEx(source.get(), &source_size)
+        || !GetFileInformationByHandle(source.get(), &source_info)) {
+        error = lastError();
+        return false;
+      }
+      const auto cluster_size = getClusterSize(
+        std::filesystem::absolute(job.destination, error).parent_path());
+      if (error) {
+        return false;
+      }
+      if (!cluster_size.has_value() || *cluster_size == 0) {
+        error = lastError();
+        return false;
+      }
+      FileHandle destination(CreateFileW(job.destination.c_str(), GENERIC_READ | GENERIC_WRITE, 0,
+        nullptr, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr));
+      if (!destination.isValid()) {
+        error = lastError();
+        return false;
+      }
+      const auto abandon = [&]() {
+        error = lastError();
+        destination.closeNow();
+        std::error_code remove_error;
+        std::filesystem::remove(job.destination, remove_error);
+        return false;
+        };
+
+      DWORD num_returned = 0;
+      // Sparse files can only be cloned into sparse files.
+      if ((source_info.dwFileAttributes & FILE_ATTRIBUTE_SPARSE_FILE) != 0
+        && !DeviceIoControl(destination.get(), FSCTL_SET_SPARSE, nullptr, 0, nullptr, 0,
+          &num_returned, nullptr)) {
+        return abandon();
+      }
+      // Clones only land within the destination's existing length.
+      if (!SetFilePointerEx(destination.get(), source_size, nullptr, FILE_BEGIN)
+        || !SetEndOfFile(destination.get())) {
+        return abandon();
+      }
+      // Regions must span whole clusters, but the last may run past the end of the file.
+      const std::uintmax_t size = static_cast<std::uintmax_t>(source_size.QuadPart);
+      const std::uintmax_t clone_size = (size + *cluster_size - 1) / *cluster_size * *cluster_size;
+      for (std::uintmax_t offset = 0; offset < clone_size; offset += MAX_CLONE_SIZE) {
+        DUPLICATE_EXTENTS_DATA extents{};
+        extents.FileHandle = source.get();
+        extents.SourceFileOffset.QuadPart = static_cast<LONGLONG>(offset);
+        extents.TargetFileOffset.QuadPart = static_cast<LONGLONG>(offset);
+        extents.ByteCount.QuadPart = static_cast<LONGLONG>(
+          std::min(MAX_CLONE_SIZE, clone_size - offset));
+        if (!DeviceIoControl(destination.get(), FSCTL_DUPLICATE_EXTENTS_TO_FILE, &extents,
+          sizeof(extents), nullptr, 0, &num_returned, nullptr)) {
+          return abandon();
+        }
+      }
+      if (!destination.closeNow()) {
+        error = lastError();
+        std::error_code remove_error;
+        std::filesystem::remove(job.destination, remove_error);
+        return false;
+      }
+      return true;
+#else
+      // No cloning interface is available on this platform.
+      error = std::make_error_code(std::errc::operation_not_supported);
+      return false;
+#endif
+    }
+    default:
+      error = std::make_error_code(std::errc::invalid_argument);
+      return false;
+    }
+  }
+
+  bool CopyEngine::copyContents(const CopyJob& job, std::vector<char>& buffer,
+    std::uintmax_t& bytes_copied, std::optional<std::uint32_t>& checksum, std::error_code& error) {
+    const std::size_t chunk_size = std::max(options_.chunk_size, static_cast<std::size_t>(1));
+    std::uint32_t crc = 0;
+#ifdef __linux__
+    const FileDescriptor source(open(job.source.c_str(), O_RDONLY | O_CLOEXEC));
+    if (source.get() < 0) {
+      error = lastError();
+      return false;
+    }
+    struct stat source_stat {};
+    if (fstat(source.get(), &source_stat) != 0) {
+      error = lastError();
+      return false;
+    }
+    // O_EXCL makes creation fail if anything exists at the destination, even if it appeared after
+    // copyFile() looked.
+    FileDescriptor destination(open(job.destination.c_str(),
+      O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, source_stat.st_mode & 0777));
+    if (destination.get() < 0) {
+      error = lastError();
+      return false;
+    }
+
+    // Each method moves data from the files' current offsets, so falling back to the next method
+    // mid-file carries on where the previous one stopped. Only buffered copies pass through our
+    // hands to be checksummed.
+    enum class Method { COPY_FILE_RANGE, SENDFILE, BUFFERED };
+    Method method = options_.use_kernel_copy && !options_.verify ? Method::COPY_FILE_RANGE
+      : Method::BUFFERED;
+    while (true) {
+      if (is_canceled_) {
+        error = std::make_error_code(std::errc::operation_canceled);
+        return false;
+      }
+
+      ssize_t count = -1;
+      if (method == Method::COPY_FILE_RANGE) {
+        count = copy_file_range(source.get(), nullptr, destination.get(), nullptr, chunk_size, 0);
+        // Some file systems report nothing to copy rather than failing, so an early end of file
+        // is double-checked with the next method.
+        if ((count < 0 && isUnsupported(errno))
+          || (count == 0 && bytes_copied < static_cast<std::uintmax_t>(source_stat.st_size))) {
+          method = Method::SENDFILE;
+          continue;
+        }
+      }
+      else if (method == Method::SENDFILE) {
+        count = sendfile(destination.get(), source.get(), nullptr, chunk_size);
+        if ((count < 0 && isUnsupported(errno))
+          || (count == 0 && bytes_copied < static_cast<std::uintmax_t>(source_stat.st_size))) {
+          method = Method::BUFFERED;
+          continue;
+        }
+      }
+      else {
+        if (buffer.size() < chunk_size) {
+          buffer.resize(chunk_size);
+        }
+        count = read(source.get(), buffer.data(), chunk_size);
+        // Hash the chunk while it's written out.
+        std::future<std::uint32_t> hash;
+        if (options_.verify && count > 0) {
+          hash = updateCrc32Async(crc, buffer.data(), count);
+        }
+        for (ssize_t written = 0; count > 0 && written < count;) {
+          const ssize_t result = write(destination.get(), buffer.data() + written,
+            count - written);
+          if (result < 0 && errno == EINTR) {
+            continue;
+          }
+          if (result <= 0) {
+            if (result == 0) {
+              errno = EIO;
+            }
+            count = -1;
+            break;
+          }
+          written += result;
+        }
+        if (hash.valid()) {
+          crc = hash.get();
+        }
+      }
+
+      if (count < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        error = lastError();
+        return false;
+      }
+      if (count == 0) {
+        break;
+      }
+      bytes_copied += count;
+      bytes_done_ += count;
+    }
+
+    if (options_.verify) {
+      // Flush the copy to the device and drop it from the cache, so that reading it back checks
+      // what was stored rather than what's still in memory.
+      if (fdatasync(destination.get()) != 0) {
+        error = lastError();
+        return false;
+      }
+      posix_fadvise(destination.get(), 0, 0, POSIX_FADV_DONTNEED);
+      checksum = crc;
+    }
+    if (!destination.closeNow()) {
+      error = lastError();
+      return false;
+    }
+    return true;
+#elif defined(_WIN32)
+    if (options_.use_kernel_copy && !options_.verify) {
+      // CopyFileExW copies within the kernel (or on the server, for network shares), and
+      // COPY_FILE_FAIL_IF_EXISTS makes creation fail if anything exists at the destination, even
+      // if it appeared after copyFile() looked.
+      CopyProgressContext context{ &bytes_done_, &is_canceled_, &bytes_copied };
+      if (!CopyFileExW(job.source.c_str(), job.destination.c_str(), &reportCopyProgress, &context,
+        nullptr, COPY_FILE_FAIL_IF_EXISTS)) {
+        error = lastError();
+        return false;
+      }
+      return true;
+    }
+
+    const FileHandle source(CreateFileW(job.source.c_str(), GENERIC_READ, FILE_SHARE_READ,
+      nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+    if (!source.isValid()) {
+      error = lastError();
+      return false;
+    }
+    // CREATE_NEW makes creation fail if anything exists at the destination, even if it appeared
+    // after copyFile() looked.
+    FileHandle destination(CreateFileW(job.destination.c_str(), GENERIC_WRITE, 0, nullptr,
+      CREATE_NEW, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+    if (!destination.isValid()) {
+      error = lastError();
+      return false;
+    }
+
+    // ReadFile() and WriteFile() take 32-bit sizes.
+    const DWORD request_size = static_cast<DWORD>(std::min(chunk_size, MAX_REQUEST_SIZE));
+    if (buffer.size() < request_size) {
+      buffer.resize(request_size);
+    }
+    while (true) {
+      if (is_canceled_) {
+        error = std::make_error_code(std::errc::operation_canceled);
+        return false;
+      }
+      DWORD count = 0;
+      if (!ReadFile(source.get(), buffer.data(), request_size, &count, nullptr)) {
+        error = lastError();
+        return false;
+      }
+      if (count == 0) {
+        break;
+      }
+      // Hash the chunk while it's written out.
+      std::future<std::uint32_t> hash;
+      if (options_.verify) {
+        hash = updateCrc32Async(crc, buffer.data(), count);
+      }
+      for (DWORD written = 0; written < count;) {
+        DWORD result = 0;
+        if (!WriteFile(destination.get(), buffer.data() + written, count - written, &result,
+          nullptr)) {
+          error = lastError();
+          return false;
+        }
+        if (result == 0) {
+          error = std::make_error_code(std::errc::io_error);
+          return false;
+        }
+        written += result;
+      }
+      if (hash.valid()) {
+        crc = hash.get();
+      }
+      bytes_copied += count;
+      bytes_done_ += count;
+    }
+
+    if (options_.verify) {
+      // Flush the copy to the device, so that reading it back (which bypasses the cache) checks
+      // what was stored.
+      if (!FlushFileBuffers(destination.get())) {
+        error = lastError();
+        return false;
+      }
+      checksum = crc;
+    }
+    if (!destination.closeNow()) {
+      error = lastError();
+      return false;
+    }
+    return true;
+#else
+    // Elsewhere, copy through the C library, whose "x" mode creates the destination exclusively.
+    const std::unique_ptr<std::FILE, decltype(&std::fclose)> source(
+      std::fopen(job.source.c_str(), "rb"), &std::fclose);
+    if (source == nullptr) {
+      error = std::make_error_code(std::errc::io_error);
+      return false;
+    }
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> destination(
+      std::fopen(job.destination.c_str(), "wbx"), &std::fclose);
+    if (destination == nullptr) {
+      std::error_code status_error;
+      error = std::filesystem::exists(job.destination, status_error)
+        ? std::make_error_code(std::errc::file_exists) : std::make_error_code(std::errc::io_error);
+      return false;
+    }
+    if (buffer.size() < chunk_size) {
+      buffer.resize(chunk_size);
+    }
+    while (true) {
+      if (is_canceled_) {
+        error = std::make_error_code(std::errc::operation_canceled);
+        return false;
+      }
+      const std::size_t count = std::fread(buffer.data(), 1, chunk_size, source.get());
+      if (count == 0) {
+        break;
+      }
+      // Hash the chunk while it's written out.
+      std::future<std::uint32_t> hash;
+      if (options_.verify) {
+        hash = updateCrc32Async(crc, buffer.data(), count);
+      }
+      if (std::fwrite(buffer.data(), 1, count, destination.get()) != count) {
+        error = std::make_error_code(std::errc::io_error);
+        return false;
+      }
+      if (hash.valid()) {
+        crc = hash.get();
+      }
+      bytes_copied += count;
+      bytes_done_ += count;
+    }
+    // Closing reports errors from buffered writes that haven't been made yet.
+    if (std::ferror(source.get()) || std::fclose(destination.release()) != 0) {
+      error = std::make_error_code(std::errc::io_error);
+      return false;
+    }
+    if (options_.verify) {
+      checksum = crc;
+    }
+    return true;
+#endif
+  }
+
+  std::optional<std::uint32_t> CopyEngine::checksumFile(const path_t& path,
+    std::vector<char>& buffer, std::uintmax_t& bytes_read, std::error_code& error) {
+#ifdef _WIN32
+    // Read around the file system cache so that the checksum reflects what's stored on the
+    // device. Unbuffered reads need memory and sizes aligned to the volume's sectors, which whole
+    // multiples of UNBUFFERED_ALIGNMENT satisfy.
+    const std::size_t requested_size = std::clamp(options_.chunk_size, static_cast<std::size_t>(1),
+      MAX_REQUEST_SIZE);
+    const std::size_t chunk_size = (requested_size + UNBUFFERED_ALIGNMENT - 1)
+      / UNBUFFERED_ALIGNMENT * UNBUFFERED_ALIGNMENT;
+    if (buffer.size() < 2 * chunk_size + UNBUFFERED_ALIGNMENT) {
+      buffer.resize(2 * chunk_size + UNBUFFERED_ALIGNMENT);
+    }
+    const std::size_t misalignment =
+      reinterpret_cast<std::uintptr_t>(buffer.data()) % UNBUFFERED_ALIGNMENT;
+    char* const chunks = buffer.data()
+      + (misalignment == 0 ? 0 : UNBUFFERED_ALIGNMENT - misalignment);
+    const FileHandle file(CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+      OPEN_EXISTING, FILE_FLAG_NO_BUFFERING | FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+    if (!file.isValid()) {
+      error = lastError();
+      return {};
+    }
+    const auto read_chunk = [&](char* const chunk) -> std::optional<std::size_t> {
+      DWORD count = 0;
+      if (!ReadFile(file.get(), chunk, static_cast<DWORD>(chunk_size), &count, nullptr)) {
+        error = lastError();
+        return {};
+      }
+      return count;
+      };
+#else
+    const std::size_t chunk_size = std::max(options_.chunk_size, static_cast<std::size_t>(1));
+    if (buffer.size() < 2 * chunk_size) {
+      buffer.resize(2 * chunk_size);
+    }
+    char* const chunks = buffer.data();
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+      error = std::make_error_code(std::errc::io_error);
+      return {};
+    }
+    const auto read_chunk = [&](char* const chunk) -> std::optional<std::size_t> {
+      file.read(chunk, static_cast<std::streamsize>(chunk_size));
+      if (file.bad()) {
+        error = std::make_error_code(std::errc::io_error);
+        return {};
+      }
+      return static_cast<std::size_t>(file.gcount());
+      };
+#endif
+
+    // Chunks alternate between two halves of the buffer, so that one half can be read into while
+    // the other is hashed.
+    std::uint32_t crc = 0;
+    std::future<std::uint32_t> hash;
+    for (std::size_t half = 0; ; half ^= 1) {
+      if (is_canceled_) {
+        error = std::make_error_code(std::errc::operation_canceled);
+        return {};
+      }
+      char* const chunk = chunks + half * chunk_size;
+      const auto count = read_chunk(chunk);
+      if (hash.valid()) {
+        crc = hash.get();
+      }
+      if (!count.has_value()) {
+        return {};
+      }
+      if (*count == 0) {
+        break;
+      }
+      hash = updateCrc32Async(crc, chunk, *count);
+      bytes_read += *count;
+      bytes_done_ += *count;
+    }
+    return crc;
+  }
+}  // namespace ragtag
@@ -0,0 +1,285 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#ifndef INCLUDE_COPY_ENGINE_H
+#define INCLUDE_COPY_ENGINE_H
+
+#include "tag_map.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace ragtag {
+  //! A file to be copied and the path at which to create the copy.
+  struct CopyJob {
+    //! The file to copy.
+    path_t source{};
+    //! The path of the copy, including its file name.
+    path_t destination{};
+  };
+
+  //! What became of a single file handed to a CopyEngine.
+  enum class CopyOutcome {
+    COPIED,      //!< The file was copied in full.
+    SKIPPED,     //!< An identical copy (same size and last-write time) already existed.
+    CONFLICTED,  //!< A different file already existed at the destination and was left alone.
+    FAILED,      //!< The file couldn't be read or the copy couldn't be written.
+    MISMATCHED,  //!< The copy read back differently from the source and was deleted.
+    CANCELED     //!< Copying was canceled before the file was finished.
+  };
+
+  //! How a CopyEngine reproduces a file at its destination.
+  //! 
+  //! Links take next to no time or space, but each has its catch. Reflinks need both files on one
+  //! volume whose file system supports cloning (such as Btrfs or XFS on Linux, or ReFS on
+  //! Windows) and hard links a single volume, while symbolic links break if the source is moved
+  //! and may need special privileges on Windows. Changes made through a hard link or symbolic link
+  //! also affect the source.
+  enum class CopyMode {
+    COPY,          //!< Write out the file's contents anew.
+    REFLINK,       //!< Clone the file, sharing its storage until either copy is changed.
+    HARD_LINK,     //!< Give the file another name.
+    SYMBOLIC_LINK  //!< Create a link pointing at the file's absolute path.
+  };
+
+  //! Settings controlling how a CopyEngine goes about its work.
+  struct CopyOptions {
+    //! How files are reproduced. Files for which this mode isn't possible are copied instead.
+    CopyMode mode{ CopyMode::COPY };
+    //! Number of files copied concurrently.
+    int num_threads{ 4 };
+    //! Largest amount of data moved in one step. Progress is reported and cancellation is checked
+    //! between steps.
+    std::size_t chunk_size{ 8 << 20 };
+    //! Whether to let the operating system move data between files directly where it can, rather
+    //! than reading each chunk into memory and writing it back out.
+    bool use_kernel_copy{ true };
+    //! Whether an existing destination with the same size and last-write time as its source counts
+    //! as already copied (SKIPPED) rather than as a conflict. This lets an interrupted export be
+    //! resumed by running it again.
+    bool skip_identical{ true };
+    //! Whether to checksum each source as it's copied, then read the copy back and compare. This
+    //! also checks the contents of destinations that skip_identical would skip, and checksums the
+    //! files behind links. Copies are flushed to the device before being read back, and verified
+    //! files are always copied through a buffer, so verifying is slower than copying alone.
+    bool verify{ false };
+  };
+
+  //! Running totals for a batch of copies.
+  struct CopyProgress {
+    //! Bytes of the sources handled so far. Files that are skipped, conflict, or fail count in full
+    //! once they're finished, so this reaches `bytes_total` when the batch is done.
+    std::uintmax_t bytes_done{ 0 };
+    //! Total size of all sources, counted twice if verifying since each byte is read back. Zero
+    //! until the sources have been measured.
+    std::uintmax_t bytes_total{ 0 };
+    //! Files finished so far, whatever their outcome.
+    int files_done{ 0 };
+    //! Number of files in the batch.
+    int files_total{ 0 };
+  };
+
+  //! What became of a single file, and why.
+  struct CopyResult {
+    //! The copy that was requested.
+    CopyJob job{};
+    //! What became of it.
+    CopyOutcome outcome{ CopyOutcome::CANCELED };
+    //! Size of the source in bytes, if it could be measured.
+    std::uintmax_t bytes{ 0 };
+    //! The error that caused a FAILED outcome, if any.
+    std::error_code error{};
+    //! How the file was reproduced, if it was.
+    CopyMode mode{ CopyMode::COPY };
+    //! Why the requested mode couldn't be used, if the file was copied instead.
+    std::error_code fallback_reason{};
+    //! CRC-32 of the source's contents, if verifying and the source could be read in full.
+    std::optional<std::uint32_t> checksum{};
+    //! CRC-32 of the destination's contents as read back, if verifying and it could be read.
+    std::optional<std::uint32_t> destination_checksum{};
+  };
+
+  //! Outcome of a batch of copies.
+  struct CopyReport {
+    //! One result per job, in the order the jobs were given.
+    std::vector<CopyResult> results{};
+    //! Whether the batch was canceled before every file was handled.
+    bool was_canceled{ false };
+
+    //! Counts the files with a given outcome.
+    //! 
+    //! @param outcome The outcome of interest.
+    //! @returns The number of results with that outcome.
+    int count(CopyOutcome outcome) const;
+  };
+
+  //! Copies a batch of files on a pool of worker threads while the owner tracks progress.
+  //! 
+  //! Copying many large files one at a time leaves the disks idle whenever the single thread is
+  //! busy elsewhere, so the engine keeps several files in flight. On Linux, data is moved with
+  //! copy_file_range() (or sendfile() where that isn't supported), which never brings file contents
+  //! into user space and lets file systems that support it clone data on the server or the device.
+  //! On Windows, CopyFileExW() does the same, offloading copies between network shares to the
+  //! server. Elsewhere, or when the kernel can't copy a file, files are copied through a buffer.
+  //! 
+  //! Files can also be linked rather than copied (see CopyMode). Each file for which linking fails
+  //! is copied instead, and its result records why.
+  //! 
+  //! When verifying (see CopyOptions::verify), each chunk is checksummed on a helper thread while
+  //! the worker goes on writing it or reading the next one, so hashing adds little to the time
+  //! spent on I/O.
+  //! 
+  //! Missing directories among the destinations' parents are created before any file is copied.
+  //! Copies are never written over existing files. A destination is created only if nothing
+  //! exists at its path, and a partial copy is deleted if its file fails or is canceled. Jobs that
+  //! name the same destination as an earlier job in the batch are reported as conflicts without
+  //! touching the disk.
+  //! 
+  //! Progress and cancellation may be used from any thread while a batch runs.
+  class CopyEngine {
+  public:
+    //! Constructor.
+    //! 
+    //! @param options Settings applied to every batch the engine runs.
+    explicit CopyEngine(const CopyOptions& options);
+
+    //! Destructor. Cancels any batch in progress and waits for it to stop.
+    ~CopyEngine();
+
+    CopyEngine(const CopyEngine&) = delete;
+    CopyEngine& operator=(const CopyEngine&) = delete;
+
+    //! Begins copying a batch of files in the background. Has no effect if a batch is already
+    //! running.
+    //! 
+    //! @param jobs The copies to make.
+    void start(std::vector<CopyJob> jobs);
+
+    //! Waits a limited time for the running batch to finish.
+    //! 
+    //! @param timeout The longest time to wait.
+    //! @returns True if no batch is running or unfinished.
+    bool waitFor(std::chrono::milliseconds timeout);
+
+    //! Obtains the running totals of the current or most recent batch.
+    //! 
+    //! @returns The progress so far.
+    CopyProgress getProgress() const;
+
+    //! Asks the running batch to stop as soon as possible. Files in the middle of being copied are
+    //! abandoned and their partial copies deleted.
+    void cancel();
+
+    //! Waits for the current batch to finish and hands over its results.
+    //! 
+    //! @returns The results of the batch. Empty if start() wasn't called since the last report.
+    CopyReport takeReport();
+
+    //! Copies a batch of files, blocking until done.
+    //! 
+    //! @param jobs The copies to make.
+    //! @param options Settings controlling the copies.
+    //! @returns The results of the batch.
+    static CopyReport run(std::vector<CopyJob> jobs, const CopyOptions& options);
+
+    //! Writes the checksums of the verified files in a report to a manifest in Simple File
+    //! Verification (SFV) format, which common tools can check independently of RagTag.
+    //! 
+    //! Only files that were copied, linked, or skipped with a checksum are listed. Each is listed
+    //! by its destination's path relative to the manifest's directory where possible.
+    //! 
+    //! @param report The report of a batch run with CopyOptions::verify set.
+    //! @param manifest Path of the manifest file to write, replacing any file already there.
+    //! @returns True if the manifest was written successfully.
+    static bool writeManifest(const CopyReport& report, const path_t& manifest);
+
+  private:
+    //! Body of the thread coordinating a batch. Measures the sources, then copies them.
+    void runBatch();
+
+    //! Handles a single job on a worker thread.
+    //! 
+    //! @param result Holds the job on entry and receives its outcome.
+    //! @param buffer Scratch space for buffered copies. Grown as needed.
+    void copyFile(CopyResult& result, std::vector<char>& buffer);
+
+    //! Links a file to a new path that must not yet exist.
+    //! 
+    //! @param job The link to make.
+    //! @param mode The kind of link to make. Must not be CopyMode::COPY.
+    //! @param error Receives the reason for any failure: std::errc::file_exists if the destination
+    //!     already exists, or another error if the link isn't possible.
+    //! @returns True if the link was made.
+    static bool linkFile(const CopyJob& job, CopyMode mode, std::error_code& error);
+
+    //! Copies the contents of a file into a new file that must not yet exist.
+    //! 
+    //! @param job The copy to make.
+    //! @param buffer Scratch space for buffered copies. Grown as needed.
+    //! @param bytes_copied Receives the number of bytes written, even if the copy fails.
+    //! @param checksum Receives the CRC-32 of the data copied if verifying. Left alone otherwise.
+    //! @param error Receives the reason for any failure: std::errc::file_exists if the destination
+    //!     already exists, or std::errc::operation_canceled if the batch was canceled.
+    //! @returns True if the copy was made in full.
+    bool copyContents(const CopyJob& job, std::vector<char>& buffer, std::uintmax_t& bytes_copied,
+      std::optional<std::uint32_t>& checksum, std::error_code& error);
+
+    //! Reads a file in full to compute its CRC-32, hashing each chunk while the next is read.
+    //! 
+    //! @param path The file to read.
+    //! @param buffer Scratch space for two chunks. Grown as needed.
+    //! @param bytes_read Receives the number of bytes read, even if reading fails.
+    //! @param error Receives the reason for any failure, or std::errc::operation_canceled if the
+    //!     batch was canceled.
+    //! @returns The checksum, or an empty optional if the file couldn't be read in full.
+    std::optional<std::uint32_t> checksumFile(const path_t& path, std::vector<char>& buffer,
+      std::uintmax_t& bytes_read, std::error_code& error);
+
+    //! Settings applied to every batch.
+    const CopyOptions options_;
+
+    //! Thread coordinating the running batch, if any.
+    std::thread coordinator_{};
+
+    //! Guards `is_running_`.
+    mutable std::mutex mutex_{};
+
+    //! Signaled when a batch finishes.
+    std::condition_variable finished_{};
+
+    //! Whether the coordinator is still at work on a batch.
+    bool is_running_{ false };
+
+    //! Results of the current batch. Each entry is written only by the worker handling its job.
+    CopyReport report_{};
+
+    //! Whether cancellation has been requested.
+    std::atomic<bool> is_canceled_{ false };
+
+    //! Running totals of the current batch. See CopyProgress.
+    std::atomic<std::uintmax_t> bytes_done_{ 0 };
+    std::atomic<std::uintmax_t> bytes_total_{ 0 };
+    std::atomic<int> files_done_{ 0 };
+    std::atomic<int> files_total_{ 0 };
+  };
+}  // namespace ragtag
+
+#endif  // INCLUDE_COPY_ENGINE_H
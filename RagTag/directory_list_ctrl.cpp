@@ -0,0 +1,93 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "directory_list_ctrl.h"
+#include "rag_tag_util.h"
+
+const wxColour DirectoryListCtrl::BACKGROUND_COLOR_FULLY_TAGGED = wxColour(200, 255, 200);
+const wxColour DirectoryListCtrl::BACKGROUND_COLOR_PARTLY_TAGGED = wxColour(255, 255, 200);
+const wxColour DirectoryListCtrl::BACKGROUND_COLOR_FULLY_UNTAGGED = wxColour(255, 255, 255);
+
+DirectoryListCtrl::DirectoryListCtrl(wxWindow* parent, const ragtag::DirectoryModel& model,
+  const ragtag::TagMap& tag_map) : wxListCtrl(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize,
+    wxLC_REPORT | wxLC_SINGLE_SEL | wxLC_VIRTUAL), model_(model), tag_map_(tag_map)
+{
+  AppendColumn("File", wxLIST_FORMAT_LEFT, 250);
+  AppendColumn("Tag Coverage", wxLIST_FORMAT_LEFT, 85);
+  AppendColumn("Rating", wxLIST_FORMAT_LEFT, 80);
+
+  attr_fully_tagged_.SetBackgroundColour(BACKGROUND_COLOR_FULLY_TAGGED);
+  attr_partly_tagged_.SetBackgroundColour(BACKGROUND_COLOR_PARTLY_TAGGED);
+  attr_fully_untagged_.SetBackgroundColour(BACKGROUND_COLOR_FULLY_UNTAGGED);
+}
+
+void DirectoryListCtrl::refreshRows()
+{
+  SetItemCount(model_.numRows());
+  // Without a refresh, old text can linger visually even though we've updated the data the control
+  // displays.
+  Refresh();
+}
+
+wxString DirectoryListCtrl::OnGetItemText(long item, long column) const
+{
+  const auto path = model_.getPathAt(item);
+  if (!path.has_value()) {
+    // Really shouldn't happen.
+    return wxEmptyString;
+  }
+
+  switch (column) {
+  case COLUMN_FILENAME:
+    return path->filename().wstring();
+  case COLUMN_RATING: {
+    const auto rating = tag_map_.getRating(*path);
+    return rating.has_value() ? RagTagUtil::getStarTextForRating(*rating) : wxString(L"--");
+  }
+  case COLUMN_TAG_COVERAGE:
+    switch (tag_map_.getFileTagCoverage(*path)) {
+    case ragtag::TagCoverage::NONE:
+      return L"None";
+    case ragtag::TagCoverage::SOME:
+      return L"Some";
+    case ragtag::TagCoverage::ALL:
+      return L"All";
+    default:
+    case ragtag::TagCoverage::NO_TAGS_DEFINED:
+      return L"--";
+    }
+  default:
+    return wxEmptyString;
+  }
+}
+
+wxItemAttr* DirectoryListCtrl::OnGetItemAttr(long item) const
+{
+  const auto path = model_.getPathAt(item);
+  if (!path.has_value()) {
+    return &attr_fully_untagged_;
+  }
+
+  switch (tag_map_.getFileTagCoverage(*path)) {
+  case ragtag::TagCoverage::SOME:
+    return &attr_partly_tagged_;
+  case ragtag::TagCoverage::ALL:
+    return &attr_fully_tagged_;
+  default:
+  case ragtag::TagCoverage::NONE:
+  case ragtag::TagCoverage::NO_TAGS_DEFINED:
+    return &attr_fully_untagged_;
+  }
+}
@@ -0,0 +1,93 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#ifndef INCLUDE_DIRECTORY_LIST_CTRL_H
+#define INCLUDE_DIRECTORY_LIST_CTRL_H
+
+#include "directory_model.h"
+#include "tag_map.h"
+#include <wx/colour.h>
+#include <wx/listctrl.h>
+#include <wx/string.h>
+#include <wx/window.h>
+
+//! Listing of the files within the active file's directory, shown in the main window.
+//! 
+//! The control runs in virtual mode: rows are the rows of a DirectoryModel, and their text and
+//! colors are computed from the project's TagMap only when drawn. The owner is responsible for
+//! calling refreshRows() after modifying the model or the tag map.
+class DirectoryListCtrl : public wxListCtrl {
+public:
+  //! Columns displayed within the directory viewer.
+  enum DirectoryViewColumn {
+    COLUMN_FILENAME,
+    COLUMN_TAG_COVERAGE,
+    COLUMN_RATING
+  };
+
+  //! Constructor.
+  //! 
+  //! @param parent The parent window.
+  //! @param model The model supplying the rows of the listing. Must outlive the control.
+  //! @param tag_map The tag map supplying ratings and tag coverage. Must outlive the control.
+  DirectoryListCtrl(wxWindow* parent, const ragtag::DirectoryModel& model,
+    const ragtag::TagMap& tag_map);
+
+  //! Synchronizes the row count with the model and redraws the visible rows.
+  void refreshRows();
+
+protected:
+  //! Produces the text of a cell on demand.
+  //! 
+  //! @param item The index of the row.
+  //! @param column The index of the column.
+  //! @returns The text to display within the cell.
+  wxString OnGetItemText(long item, long column) const override;
+
+  //! Produces the display attributes of a row on demand, coloring it by its tag coverage.
+  //! 
+  //! @param item The index of the row.
+  //! @returns Pointer to the attributes of the row.
+  wxItemAttr* OnGetItemAttr(long item) const override;
+
+private:
+  //! Color used for the background of list items for files that have been fully tagged.
+  static const wxColour BACKGROUND_COLOR_FULLY_TAGGED;
+
+  //! Color used for the background of list items for files that have been partly tagged (files that
+  //! have some tag coverage).
+  static const wxColour BACKGROUND_COLOR_PARTLY_TAGGED;
+
+  //! Color used for the background of list items for files that are untagged (files that have no
+  //! tag coverage).
+  static const wxColour BACKGROUND_COLOR_FULLY_UNTAGGED;
+
+  //! The model supplying the rows of the listing.
+  const ragtag::DirectoryModel& model_;
+
+  //! The tag map supplying ratings and tag coverage.
+  const ragtag::TagMap& tag_map_;
+
+  // Implementation note: OnGetItemAttr() is const but must hand out non-const pointers, so the
+  // attributes it chooses between are mutable.
+  //! Attributes of rows representing files that have all tags committed.
+  mutable wxItemAttr attr_fully_tagged_{};
+  //! Attributes of rows representing files that have some but not all tags committed.
+  mutable wxItemAttr attr_partly_tagged_{};
+  //! Attributes of rows representing files that have no tags committed.
+  mutable wxItemAttr attr_fully_untagged_{};
+};
+
+#endif  // INCLUDE_DIRECTORY_LIST_CTRL_H
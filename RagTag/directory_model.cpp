@@ -0,0 +1,58 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "directory_model.h"
+#include <algorithm>
+
+namespace ragtag {
+  void DirectoryModel::setListing(const path_t& directory,
+    DirectorySnapshotCache::snapshot_t snapshot) {
+    directory_ = directory;
+    files_ = snapshot != nullptr ? std::move(snapshot)
+      : std::make_shared<const std::vector<path_t>>();
+  }
+
+  void DirectoryModel::clear() {
+    directory_.reset();
+    files_ = std::make_shared<const std::vector<path_t>>();
+  }
+
+  std::optional<path_t> DirectoryModel::getDirectory() const {
+    return directory_;
+  }
+
+  long DirectoryModel::numRows() const {
+    return static_cast<long>(files_->size());
+  }
+
+  std::optional<path_t> DirectoryModel::getPathAt(const long index) const {
+    if (index < 0 || index >= numRows()) {
+      return {};
+    }
+    return (*files_)[index];
+  }
+
+  std::optional<long> DirectoryModel::findIndex(const path_t& path) const {
+    const auto it = std::lower_bound(files_->begin(), files_->end(), path);
+    if (it == files_->end() || *it != path) {
+      return {};
+    }
+    return static_cast<long>(it - files_->begin());
+  }
+
+  const DirectorySnapshotCache::snapshot_t& DirectoryModel::getSnapshot() const {
+    return files_;
+  }
+}  // namespace ragtag
@@ -0,0 +1,80 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#ifndef INCLUDE_DIRECTORY_MODEL_H
+#define INCLUDE_DIRECTORY_MODEL_H
+
+#include "directory_snapshot_cache.h"
+#include "tag_map.h"
+#include <optional>
+#include <vector>
+
+namespace ragtag {
+  //! Listing of the regular files within a single directory, kept independent of any user
+  //! interface.
+  //! 
+  //! Files are held in sorted order, and each file's row is its index within that order. Rows are
+  //! stable for as long as the listing is not replaced, so a list control in virtual mode can refer
+  //! to files by row without holding pointers into storage that might be reallocated.
+  class DirectoryModel {
+  public:
+    //! Replaces the listing with a snapshot of a directory's files.
+    //! 
+    //! The snapshot is shared rather than copied, so replacing the listing is O(1).
+    //! 
+    //! @param directory The directory the files belong to.
+    //! @param snapshot Sorted paths to the files to list. Null is treated as an empty listing.
+    void setListing(const path_t& directory, DirectorySnapshotCache::snapshot_t snapshot);
+
+    //! Empties the listing and disassociates it from any directory.
+    void clear();
+
+    //! Retrieves the directory whose files are listed.
+    //! 
+    //! @returns The listed directory or an empty optional if no directory is listed.
+    std::optional<path_t> getDirectory() const;
+
+    //! Obtains the count of rows.
+    //! 
+    //! @returns The number of files in the listing.
+    long numRows() const;
+
+    //! Retrieves the path of the file in a given row.
+    //! 
+    //! @param index The index of the row.
+    //! @returns The path of the file or an empty optional if the index is out of range.
+    std::optional<path_t> getPathAt(long index) const;
+
+    //! Finds the row of a given file in O(log n) time.
+    //! 
+    //! @param path The path of the file to find.
+    //! @returns The index of the file's row or an empty optional if the file isn't listed.
+    std::optional<long> findIndex(const path_t& path) const;
+
+    //! Retrieves the snapshot backing the listing.
+    //! 
+    //! @returns The sorted paths of all listed files. Never null.
+    const DirectorySnapshotCache::snapshot_t& getSnapshot() const;
+
+  private:
+    //! The listed directory, if any.
+    std::optional<path_t> directory_{};
+
+    //! Paths to all listed files, sorted. Never null.
+    DirectorySnapshotCache::snapshot_t files_{ std::make_shared<const std::vector<path_t>>() };
+  };
+}  // namespace ragtag
+
+#endif  // INCLUDE_DIRECTORY_MODEL_H
@@ -0,0 +1,109 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "directory_snapshot_cache.h"
+#include <algorithm>
+#include <iostream>
+#include <system_error>
+
+namespace ragtag {
+  DirectorySnapshotCache::DirectorySnapshotCache(std::unique_ptr<DirectoryWatcher> watcher)
+    : watcher_(std::move(watcher)) {}
+
+  std::optional<DirectorySnapshotCache::snapshot_t> DirectorySnapshotCache::getSnapshot(
+    const path_t& directory) {
+    if (directory_.has_value() && *directory_ == directory && snapshot_ != nullptr) {
+      if (!is_watched_) {
+        // Without a watcher, the snapshot is only as current as the last rescan. That's the best
+        // we can do without enumerating again.
+        return snapshot_;
+      }
+
+      const auto changes = watcher_->pollChanges();
+      if (changes.has_value()) {
+        applyChanges(*changes);
+        return snapshot_;
+      }
+      // The watcher lost track. Fall through to rescan.
+    }
+
+    // Watch before scanning so that changes made during the scan are reported afterward rather
+    // than lost. (Reporting a change the scan already saw is harmless.)
+    is_watched_ = watcher_ != nullptr && watcher_->watch(directory);
+    directory_ = directory;
+
+    auto files = scan(directory);
+    if (!files.has_value()) {
+      snapshot_.reset();
+      return {};
+    }
+
+    snapshot_ = std::make_shared<const std::vector<path_t>>(std::move(*files));
+    return snapshot_;
+  }
+
+  void DirectorySnapshotCache::invalidate() {
+    snapshot_.reset();
+  }
+
+  std::optional<std::vector<path_t>> DirectorySnapshotCache::scan(const path_t& directory) {
+    std::vector<path_t> files;
+    std::error_code error;
+    // Note: directory_iterator documentation explains that the end iterator is equal to the
+    // default-constructed iterator.
+    for (std::filesystem::directory_iterator dir_it(directory, error);
+      !error && dir_it != std::filesystem::directory_iterator(); dir_it.increment(error)) {
+      // Skip things like symlinks and such.
+      std::error_code type_error;
+      if (dir_it->is_regular_file(type_error)) {
+        files.push_back(dir_it->path());
+      }
+    }
+
+    if (error) {
+      std::wcerr << L"Couldn't list directory '" << directory.wstring() << L"'.\n";
+      return {};
+    }
+
+    std::sort(files.begin(), files.end());
+    return files;
+  }
+
+  void DirectorySnapshotCache::applyChanges(
+    const std::vector<DirectoryWatcher::Change>& changes) {
+    if (changes.empty()) {
+      return;
+    }
+
+    auto files = std::make_shared<std::vector<path_t>>(*snapshot_);
+    for (const auto& change : changes) {
+      const auto it = std::lower_bound(files->begin(), files->end(), change.path);
+      const bool is_present = it != files->end() && *it == change.path;
+      if (change.type == DirectoryWatcher::ChangeType::ADDED) {
+        // A change reported for an entry is no guarantee the entry is still there (or that it's a
+        // regular file), so ask the filesystem.
+        std::error_code error;
+        if (!is_present && std::filesystem::is_regular_file(change.path, error)) {
+          files->insert(it, change.path);
+        }
+      }
+      else if (is_present) {
+        files->erase(it);
+      }
+    }
+
+    snapshot_ = std::move(files);
+  }
+}  // namespace ragtag
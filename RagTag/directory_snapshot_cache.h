@@ -0,0 +1,84 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#ifndef INCLUDE_DIRECTORY_SNAPSHOT_CACHE_H
+#define INCLUDE_DIRECTORY_SNAPSHOT_CACHE_H
+
+#include "directory_watcher.h"
+#include "tag_map.h"
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace ragtag {
+  //! Cache of the regular files within one directory, kept current by a DirectoryWatcher.
+  //! 
+  //! Enumerating a directory can be slow (notably on network shares), so the cache enumerates a
+  //! directory only when it is first requested, when the watcher can't account for changes, or when
+  //! explicitly invalidated. Otherwise, it applies the changes the watcher reports to its existing
+  //! snapshot.
+  //! 
+  //! Snapshots are immutable once handed out. When the directory changes, a new snapshot replaces
+  //! the old one, so holders of the old snapshot can tell it's outdated by comparing pointers.
+  class DirectorySnapshotCache {
+  public:
+    //! Sorted paths of the regular files within a directory.
+    typedef std::shared_ptr<const std::vector<path_t>> snapshot_t;
+
+    //! Constructor.
+    //! 
+    //! @param watcher The watcher used to keep snapshots current. If null, the cache never applies
+    //!     changes on its own and only rescans when invalidated or given a different directory.
+    explicit DirectorySnapshotCache(
+      std::unique_ptr<DirectoryWatcher> watcher = DirectoryWatcher::create());
+
+    //! Obtains an up-to-date snapshot of the regular files within a directory.
+    //! 
+    //! @param directory The directory of interest.
+    //! @returns The sorted paths of the directory's regular files, or an empty optional if the
+    //!     directory can't be read.
+    std::optional<snapshot_t> getSnapshot(const path_t& directory);
+
+    //! Forces the next call to getSnapshot() to enumerate the directory anew.
+    void invalidate();
+
+    //! Lists the regular files within a directory without consulting any cache.
+    //! 
+    //! @param directory The directory to list.
+    //! @returns The sorted paths of the directory's regular files, or an empty optional if the
+    //!     directory can't be read.
+    static std::optional<std::vector<path_t>> scan(const path_t& directory);
+
+  private:
+    //! Produces a new snapshot reflecting changes made to the directory.
+    //! 
+    //! @param changes Changes reported by the watcher, in the order they occurred.
+    void applyChanges(const std::vector<DirectoryWatcher::Change>& changes);
+
+    //! Watcher keeping the snapshot current. May be null.
+    std::unique_ptr<DirectoryWatcher> watcher_;
+
+    //! The directory the snapshot describes, if any.
+    std::optional<path_t> directory_{};
+
+    //! The latest snapshot of `directory_`.
+    snapshot_t snapshot_{};
+
+    //! Whether `directory_` is being watched successfully.
+    bool is_watched_{ false };
+  };
+}  // namespace ragtag
+
+#endif  // INCLUDE_DIRECTORY_SNAPSHOT_CACHE_H
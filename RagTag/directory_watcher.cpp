@@ -0,0 +1,319 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "directory_watcher.h"
+#include <iostream>
+#include <system_error>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <sys/inotify.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace ragtag {
+  std::unique_ptr<DirectoryWatcher> DirectoryWatcher::create() {
+#ifdef __linux__
+    auto inotify_watcher = std::make_unique<InotifyDirectoryWatcher>();
+    if (inotify_watcher->isValid()) {
+      return inotify_watcher;
+    }
+    std::wcerr << L"inotify is unavailable; falling back to polling for directory changes.\n";
+#elif defined(_WIN32)
+    auto windows_watcher = std::make_unique<ReadDirectoryChangesWatcher>();
+    if (windows_watcher->isValid()) {
+      return windows_watcher;
+    }
+    std::wcerr << L"ReadDirectoryChangesW is unavailable; falling back to polling for directory "
+      L"changes.\n";
+#endif
+    return std::make_unique<PollingDirectoryWatcher>();
+  }
+
+  bool PollingDirectoryWatcher::watch(const path_t& directory) {
+    std::error_code error;
+    const auto last_write_time = std::filesystem::last_write_time(directory, error);
+    if (error) {
+      unwatch();
+      return false;
+    }
+
+    directory_ = directory;
+    last_write_time_ = last_write_time;
+    return true;
+  }
+
+  void PollingDirectoryWatcher::unwatch() {
+    directory_.reset();
+  }
+
+  std::optional<std::vector<DirectoryWatcher::Change>> PollingDirectoryWatcher::pollChanges() {
+    if (!directory_.has_value()) {
+      return {};
+    }
+
+    std::error_code error;
+    const auto last_write_time = std::filesystem::last_write_time(*directory_, error);
+    if (error) {
+      // The directory is gone or unreadable. Let the owner find out which by rescanning.
+      return {};
+    }
+    if (last_write_time != last_write_time_) {
+      last_write_time_ = last_write_time;
+      return {};
+    }
+
+    return std::vector<Change>();
+  }
+
+#ifdef __linux__
+  InotifyDirectoryWatcher::InotifyDirectoryWatcher() {
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  }
+
+  InotifyDirectoryWatcher::~InotifyDirectoryWatcher() {
+    if (inotify_fd_ != -1) {
+      close(inotify_fd_);
+    }
+  }
+
+  bool InotifyDirectoryWatcher::watch(const path_t& directory) {
+    unwatch();
+    if (!isValid()) {
+      return false;
+    }
+
+    watch_descriptor_ = inotify_add_watch(inotify_fd_, directory.c_str(), IN_CREATE | IN_DELETE
+      | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+    if (watch_descriptor_ == -1) {
+      std::wcerr << L"Couldn't watch directory '" << directory.wstring() << L"': "
+        << std::strerror(errno) << L"\n";
+      return false;
+    }
+
+    directory_ = directory;
+    return true;
+  }
+
+  void InotifyDirectoryWatcher::unwatch() {
+    if (watch_descriptor_ != -1) {
+      inotify_rm_watch(inotify_fd_, watch_descriptor_);
+      watch_descriptor_ = -1;
+    }
+    directory_.reset();
+    // Events queued for the old watch are meaningless for whatever we watch next.
+    drainEvents();
+  }
+
+  std::optional<std::vector<DirectoryWatcher::Change>> InotifyDirectoryWatcher::pollChanges() {
+    if (watch_descriptor_ == -1) {
+      return {};
+    }
+
+    std::vector<Change> changes;
+    alignas(inotify_event) char buffer[16 * 1024];
+    while (true) {
+      const ssize_t length = read(inotify_fd_, buffer, sizeof(buffer));
+      if (length <= 0) {
+        // EAGAIN: the queue is empty.
+        break;
+      }
+
+      for (ssize_t offset = 0; offset < length;) {
+        const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+        offset += sizeof(inotify_event) + event->len;
+
+        if (event->mask & IN_Q_OVERFLOW) {
+          // Events were dropped, so the changes we'd report would be incomplete.
+          drainEvents();
+          return {};
+        }
+        if (event->wd != watch_descriptor_) {
+          // Left over from a directory we used to watch.
+          continue;
+        }
+        if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+          // The directory itself went away; there's nothing left to track changes against.
+          watch_descriptor_ = -1;
+          directory_.reset();
+          return {};
+        }
+        if (event->len == 0 || (event->mask & IN_ISDIR)) {
+          continue;
+        }
+
+        const path_t path = *directory_ / event->name;
+        if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+          changes.push_back({ ChangeType::ADDED, path });
+        }
+        else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+          changes.push_back({ ChangeType::REMOVED, path });
+        }
+      }
+    }
+
+    return changes;
+  }
+
+  bool InotifyDirectoryWatcher::isValid() const {
+    return inotify_fd_ != -1;
+  }
+
+  void InotifyDirectoryWatcher::drainEvents() {
+    if (!isValid()) {
+      return;
+    }
+
+    alignas(inotify_event) char buffer[16 * 1024];
+    while (read(inotify_fd_, buffer, sizeof(buffer)) > 0) {}
+  }
+#endif  // __linux__
+
+#ifdef _WIN32
+  struct ReadDirectoryChangesWatcher::PendingRead {
+    //! Handle of the watched directory, or INVALID_HANDLE_VALUE if no directory is watched.
+    HANDLE directory{ INVALID_HANDLE_VALUE };
+
+    //! Tracks the read in progress. Its event is signaled when the read completes.
+    OVERLAPPED overlapped{};
+
+    //! Receives FILE_NOTIFY_INFORMATION records, which must be DWORD-aligned. Reads of network
+    //! shares fail outright if asked for more than 64 KiB.
+    std::vector<DWORD> buffer = std::vector<DWORD>(64 * 1024 / sizeof(DWORD));
+  };
+
+  ReadDirectoryChangesWatcher::ReadDirectoryChangesWatcher()
+    : pending_read_(std::make_unique<PendingRead>()) {
+    // Manual reset, as GetOverlappedResult() expects of an overlapped operation's event.
+    pending_read_->overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+  }
+
+  ReadDirectoryChangesWatcher::~ReadDirectoryChangesWatcher() {
+    unwatch();
+    if (isValid()) {
+      CloseHandle(pending_read_->overlapped.hEvent);
+    }
+  }
+
+  bool ReadDirectoryChangesWatcher::watch(const path_t& directory) {
+    unwatch();
+    if (!isValid()) {
+      return false;
+    }
+
+    // Share everything so that watching never gets in the way of changing the directory.
+    pending_read_->directory = CreateFileW(directory.c_str(), FILE_LIST_DIRECTORY,
+      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+      FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (pending_read_->directory == INVALID_HANDLE_VALUE) {
+      std::wcerr << L"Couldn't watch directory '" << directory.wstring() << L"': error "
+        << GetLastError() << L"\n";
+      return false;
+    }
+
+    directory_ = directory;
+    if (!beginRead()) {
+      unwatch();
+      return false;
+    }
+    return true;
+  }
+
+  void ReadDirectoryChangesWatcher::unwatch() {
+    if (pending_read_->directory == INVALID_HANDLE_VALUE) {
+      return;
+    }
+
+    // The read still owns the buffer until it finishes, so wait for the cancellation to land.
+    DWORD length = 0;
+    if (CancelIoEx(pending_read_->directory, &pending_read_->overlapped)) {
+      GetOverlappedResult(pending_read_->directory, &pending_read_->overlapped, &length, TRUE);
+    }
+    CloseHandle(pending_read_->directory);
+    pending_read_->directory = INVALID_HANDLE_VALUE;
+    directory_.reset();
+  }
+
+  std::optional<std::vector<DirectoryWatcher::Change>> ReadDirectoryChangesWatcher::pollChanges() {
+    if (pending_read_->directory == INVALID_HANDLE_VALUE) {
+      return {};
+    }
+
+    std::vector<Change> changes;
+    while (true) {
+      DWORD length = 0;
+      if (!GetOverlappedResult(pending_read_->directory, &pending_read_->overlapped, &length,
+        FALSE)) {
+        if (GetLastError() == ERROR_IO_INCOMPLETE) {
+          // Nothing more has happened yet.
+          break;
+        }
+        // The directory itself went away; there's nothing left to track changes against.
+        unwatch();
+        return {};
+      }
+      if (length == 0) {
+        // Changes overflowed the buffer and were dropped, so the ones we'd report would be
+        // incomplete.
+        if (!beginRead()) {
+          unwatch();
+        }
+        return {};
+      }
+
+      const auto* const records = reinterpret_cast<const char*>(pending_read_->buffer.data());
+      for (DWORD offset = 0; ;) {
+        const auto* record = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(records + offset);
+        const path_t path = *directory_ / std::wstring_view(record->FileName,
+          record->FileNameLength / sizeof(WCHAR));
+        if (record->Action == FILE_ACTION_ADDED
+          || record->Action == FILE_ACTION_RENAMED_NEW_NAME) {
+          changes.push_back({ ChangeType::ADDED, path });
+        }
+        else if (record->Action == FILE_ACTION_REMOVED
+          || record->Action == FILE_ACTION_RENAMED_OLD_NAME) {
+          changes.push_back({ ChangeType::REMOVED, path });
+        }
+        if (record->NextEntryOffset == 0) {
+          break;
+        }
+        offset += record->NextEntryOffset;
+      }
+
+      if (!beginRead()) {
+        unwatch();
+        return {};
+      }
+    }
+
+    return changes;
+  }
+
+  bool ReadDirectoryChangesWatcher::isValid() const {
+    return pending_read_->overlapped.hEvent != nullptr;
+  }
+
+  bool ReadDirectoryChangesWatcher::beginRead() {
+    // Only names of files (not subdirectories) are of interest, matching the inotify watcher.
+    return ReadDirectoryChangesW(pending_read_->directory, pending_read_->buffer.data(),
+      static_cast<DWORD>(pending_read_->buffer.size() * sizeof(DWORD)), FALSE,
+      FILE_NOTIFY_CHANGE_FILE_NAME, nullptr, &pending_read_->overlapped, nullptr);
+  }
+#endif  // _WIN32
+}  // namespace ragtag
@@ -0,0 +1,176 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#ifndef INCLUDE_DIRECTORY_WATCHER_H
+#define INCLUDE_DIRECTORY_WATCHER_H
+
+#include "tag_map.h"
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace ragtag {
+  //! Interface for observing changes to the entries of a single directory.
+  //! 
+  //! Watchers are polled rather than delivering callbacks, so they never call into their owner from
+  //! another thread. A watcher that can't account for every change since the last poll (because
+  //! its backend overflowed or it can only tell that *something* changed) asks its owner to rescan
+  //! instead of reporting changes.
+  class DirectoryWatcher {
+  public:
+    //! Kind of change observed within the watched directory.
+    enum class ChangeType {
+      ADDED,   //!< An entry was created in or moved into the directory.
+      REMOVED  //!< An entry was deleted from or moved out of the directory.
+    };
+
+    //! A single change observed within the watched directory.
+    struct Change {
+      //! Kind of change.
+      ChangeType type{ ChangeType::ADDED };
+      //! Full path of the entry that changed.
+      path_t path{};
+    };
+
+    //! Creates the most capable watcher available on this platform.
+    //! 
+    //! @returns A new watcher. Never null.
+    static std::unique_ptr<DirectoryWatcher> create();
+
+    //! Destructor.
+    virtual ~DirectoryWatcher() = default;
+
+    //! Begins watching a directory, ceasing to watch any directory watched previously.
+    //! 
+    //! Changes that happened before this call are not reported, so callers should call this before
+    //! reading the directory's contents rather than after.
+    //! 
+    //! @param directory The directory to watch.
+    //! @returns True if the directory is being watched.
+    virtual bool watch(const path_t& directory) = 0;
+
+    //! Stops watching the current directory, if any.
+    virtual void unwatch() = 0;
+
+    //! Collects the changes observed since the last poll (or since watch() was called).
+    //! 
+    //! @returns The changes in the order they were observed, or an empty optional if the watcher
+    //!     cannot describe them and the directory must be rescanned.
+    virtual std::optional<std::vector<Change>> pollChanges() = 0;
+  };
+
+  //! Watcher that detects changes by checking the directory's last-write time.
+  //! 
+  //! This works anywhere the filesystem updates a directory's timestamp when entries are added,
+  //! removed, or renamed, which includes NTFS and common network shares. It never reports
+  //! individual changes; any change calls for a rescan.
+  class PollingDirectoryWatcher : public DirectoryWatcher {
+  public:
+    bool watch(const path_t& directory) override;
+    void unwatch() override;
+    std::optional<std::vector<Change>> pollChanges() override;
+
+  private:
+    //! The watched directory, if any.
+    std::optional<path_t> directory_{};
+
+    //! Last-write time of the directory as of the last poll.
+    std::filesystem::file_time_type last_write_time_{};
+  };
+
+#ifdef __linux__
+  //! Watcher backed by Linux's inotify API, reporting individual changes as they occur.
+  class InotifyDirectoryWatcher : public DirectoryWatcher {
+  public:
+    //! Constructor.
+    InotifyDirectoryWatcher();
+
+    //! Destructor. Releases the inotify instance.
+    ~InotifyDirectoryWatcher() override;
+
+    InotifyDirectoryWatcher(const InotifyDirectoryWatcher&) = delete;
+    InotifyDirectoryWatcher& operator=(const InotifyDirectoryWatcher&) = delete;
+
+    bool watch(const path_t& directory) override;
+    void unwatch() override;
+    std::optional<std::vector<Change>> pollChanges() override;
+
+    //! Checks whether the inotify instance was created successfully.
+    //! 
+    //! @returns True if the watcher is usable.
+    bool isValid() const;
+
+  private:
+    //! Discards all events queued on the inotify instance.
+    void drainEvents();
+
+    //! File descriptor of the inotify instance, or -1 if it couldn't be created.
+    int inotify_fd_{ -1 };
+
+    //! Descriptor of the watch on the current directory, or -1 if no directory is watched.
+    int watch_descriptor_{ -1 };
+
+    //! The watched directory, if any.
+    std::optional<path_t> directory_{};
+  };
+#endif  // __linux__
+
+#ifdef _WIN32
+  //! Watcher backed by Windows's ReadDirectoryChangesW API, reporting individual changes as they
+  //! occur.
+  //! 
+  //! A read of the directory's changes is always kept pending in the background, and polling
+  //! collects whatever it has gathered without waiting.
+  class ReadDirectoryChangesWatcher : public DirectoryWatcher {
+  public:
+    //! Constructor.
+    ReadDirectoryChangesWatcher();
+
+    //! Destructor. Cancels any pending read and releases the directory.
+    ~ReadDirectoryChangesWatcher() override;
+
+    ReadDirectoryChangesWatcher(const ReadDirectoryChangesWatcher&) = delete;
+    ReadDirectoryChangesWatcher& operator=(const ReadDirectoryChangesWatcher&) = delete;
+
+    bool watch(const path_t& directory) override;
+    void unwatch() override;
+    std::optional<std::vector<Change>> pollChanges() override;
+
+    //! Checks whether the event signaling completed reads was created successfully.
+    //! 
+    //! @returns True if the watcher is usable.
+    bool isValid() const;
+
+  private:
+    //! State of the read kept pending on the watched directory. (Defined alongside the
+    //! implementation so that this header needn't include Windows headers.)
+    struct PendingRead;
+
+    //! Begins reading the next batch of changes in the background.
+    //! 
+    //! @returns True if the read was started.
+    bool beginRead();
+
+    //! Read kept pending on the watched directory, along with the buffer it fills.
+    std::unique_ptr<PendingRead> pending_read_;
+
+    //! The watched directory, if any.
+    std::optional<path_t> directory_{};
+  };
+#endif  // _WIN32
+}  // namespace ragtag
+
+#endif  // INCLUDE_DIRECTORY_WATCHER_H
@@ -0,0 +1,100 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "ellipsization_cache.h"
+#include <algorithm>
+
+namespace ragtag {
+  const std::wstring EllipsizationCache::ELLIPSIS = L"...";
+  const size_t EllipsizationCache::DEFAULT_CAPACITY = 4096;
+
+  EllipsizationCache::EllipsizationCache(measure_t measure, const size_t capacity)
+    : measure_(std::move(measure)), capacity_(std::max<size_t>(capacity, 1)) {}
+
+  const std::wstring& EllipsizationCache::ellipsizeStart(const std::wstring& text,
+    const int max_width) {
+    Key key{ .text = text, .max_width = max_width };
+    const auto it = results_.find(key);
+    if (it != results_.end()) {
+      return it->second;
+    }
+
+    // Forgetting everything at once is crude, but results mostly go stale together anyway (when a
+    // column is resized, every result at the old width becomes useless).
+    if (results_.size() >= capacity_) {
+      results_.clear();
+    }
+    if (full_widths_.size() >= capacity_) {
+      full_widths_.clear();
+    }
+
+    std::wstring result = fit(text, max_width);
+    return results_.emplace(std::move(key), std::move(result)).first->second;
+  }
+
+  void EllipsizationCache::clear() {
+    results_.clear();
+    full_widths_.clear();
+  }
+
+  size_t EllipsizationCache::size() const {
+    return results_.size();
+  }
+
+  size_t EllipsizationCache::KeyHash::operator()(const Key& key) const noexcept {
+    const size_t text_hash = std::hash<std::wstring>{}(key.text);
+    return text_hash ^ (std::hash<int>{}(key.max_width) + 0x9e3779b9 + (text_hash << 6)
+      + (text_hash >> 2));
+  }
+
+  std::wstring EllipsizationCache::fit(const std::wstring& text, const int max_width) {
+    if (text.empty() || measureFullText(text) <= max_width) {
+      return text;
+    }
+
+    // Find the longest suffix that fits after the ellipsis. Longer suffixes are never narrower, so
+    // the lengths that fit form a prefix of [0, text.size()).
+    size_t fitting = 0;
+    size_t low = 1;
+    size_t high = text.size() - 1;
+    while (low <= high) {
+      const size_t length = low + (high - low) / 2;
+      if (measure_(ELLIPSIS + text.substr(text.size() - length)) <= max_width) {
+        fitting = length;
+        low = length + 1;
+      }
+      else {
+        high = length - 1;
+      }
+    }
+
+    size_t begin = text.size() - fitting;
+    // Don't begin with the second half of a UTF-16 surrogate pair.
+    if (begin < text.size() && text[begin] >= 0xDC00 && text[begin] <= 0xDFFF) {
+      ++begin;
+    }
+    return ELLIPSIS + text.substr(begin);
+  }
+
+  int EllipsizationCache::measureFullText(const std::wstring& text) {
+    const auto it = full_widths_.find(text);
+    if (it != full_widths_.end()) {
+      return it->second;
+    }
+    const int width = measure_(text);
+    full_widths_.emplace(text, width);
+    return width;
+  }
+}  // namespace ragtag
@@ -0,0 +1,117 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#ifndef INCLUDE_ELLIPSIZATION_CACHE_H
+#define INCLUDE_ELLIPSIZATION_CACHE_H
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+namespace ragtag {
+  //! Shortens text to fit a pixel width by replacing its beginning with an ellipsis, remembering
+  //! results so that redrawing the same text at the same width costs a single lookup.
+  //! 
+  //! Text is measured through a caller-supplied function, which keeps the cache independent of any
+  //! particular graphics toolkit. Fitting a string takes O(log n) measurements by binary searching
+  //! for the longest suffix that fits, and the full width of each string is remembered separately
+  //! so that changing the target width doesn't require measuring strings that fit anyway.
+  class EllipsizationCache {
+  public:
+    //! Function measuring the width of text in pixels.
+    typedef std::function<int(const std::wstring&)> measure_t;
+
+    //! Text substituted for the portion of a string that doesn't fit.
+    static const std::wstring ELLIPSIS;
+
+    //! Default number of results the cache remembers before starting over.
+    static const size_t DEFAULT_CAPACITY;
+
+    //! Constructor.
+    //! 
+    //! @param measure Function measuring the width of text in pixels. Widths are assumed to grow
+    //!     (or at least not shrink) as characters are added.
+    //! @param capacity Number of results to remember before forgetting all of them.
+    explicit EllipsizationCache(measure_t measure, size_t capacity = DEFAULT_CAPACITY);
+
+    //! Shortens text to fit within a width, keeping its end intact.
+    //! 
+    //! @param text The text to shorten.
+    //! @param max_width The width in pixels the text must fit within.
+    //! @returns The text itself if it fits; otherwise, the ellipsis followed by the longest
+    //!     suffix of the text that fits alongside it. If not even the ellipsis fits, the ellipsis
+    //!     alone.
+    const std::wstring& ellipsizeStart(const std::wstring& text, int max_width);
+
+    //! Forgets all results, such as after a change of font.
+    void clear();
+
+    //! Obtains the count of remembered results.
+    //! 
+    //! @returns The number of remembered results.
+    size_t size() const;
+
+  private:
+    //! Identifies a result by the text shortened and the width it was shortened to.
+    struct Key {
+      //! The text shortened.
+      std::wstring text{};
+      //! The width the text was shortened to.
+      int max_width{ 0 };
+
+      //! Tests equality of this Key and another.
+      //! 
+      //! @param rhs The Key to compare this one with.
+      //! @returns True if both keys describe the same text and width.
+      bool operator==(const Key& rhs) const noexcept = default;
+    };
+
+    //! Hashes a Key.
+    struct KeyHash {
+      //! Hashes a Key.
+      //! 
+      //! @param key The Key to hash.
+      //! @returns The hash of the key.
+      size_t operator()(const Key& key) const noexcept;
+    };
+
+    //! Computes the shortened form of text without consulting the cache of results.
+    //! 
+    //! @param text The text to shorten.
+    //! @param max_width The width in pixels the text must fit within.
+    //! @returns The shortened text.
+    std::wstring fit(const std::wstring& text, int max_width);
+
+    //! Measures the full width of text, remembering the result.
+    //! 
+    //! @param text The text to measure.
+    //! @returns The width of the text in pixels.
+    int measureFullText(const std::wstring& text);
+
+    //! Function measuring the width of text in pixels.
+    measure_t measure_;
+
+    //! Number of results to remember before forgetting all of them.
+    size_t capacity_;
+
+    //! Remembered results.
+    std::unordered_map<Key, std::wstring, KeyHash> results_{};
+
+    //! Remembered full widths of text, in pixels.
+    std::unordered_map<std::wstring, int> full_widths_{};
+  };
+}  // namespace ragtag
+
+#endif  // INCLUDE_ELLIPSIZATION_CACHE_H
@@ -0,0 +1,216 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "export_namer.h"
+#include <algorithm>
+#include <cstdint>
+#include <cwctype>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace ragtag {
+  std::vector<path_t> ExportNamer::planNames(const std::vector<path_t>& sources,
+    const ExportNaming naming) {
+    if (naming == ExportNaming::MIRRORED_TREE) {
+      std::vector<path_t> names = relativeToCommonAncestor(sources);
+      numberDuplicates(names);
+      return names;
+    }
+
+    std::vector<path_t> names;
+    names.reserve(sources.size());
+    for (const auto& source : sources) {
+      names.push_back(source.filename());
+    }
+    const auto find_clashes = [&names]() {
+      std::unordered_map<path_t::string_type, int> counts;
+      for (const auto& name : names) {
+        ++counts[toKey(name)];
+      }
+      std::vector<size_t> clashing;
+      for (size_t i = 0; i < names.size(); ++i) {
+        if (counts[toKey(names[i])] > 1) {
+          clashing.push_back(i);
+        }
+      }
+      return clashing;
+      };
+
+    // Only files whose names clash to begin with are renamed. A file with a unique name that
+    // happens to match a renamed file keeps its name, and the renamed file gives way.
+    std::vector<bool> is_renamable(names.size(), false);
+    for (const size_t i : find_clashes()) {
+      is_renamable[i] = true;
+    }
+
+    if (naming == ExportNaming::PARENT_PREFIX) {
+      // Climb one directory at a time for the files that still clash, so that prefixes are only as
+      // long as they need to be.
+      std::vector<path_t> remaining_parents;
+      remaining_parents.reserve(sources.size());
+      for (const auto& source : sources) {
+        remaining_parents.push_back(source.lexically_normal().parent_path());
+      }
+      bool did_climb = true;
+      while (did_climb) {
+        did_climb = false;
+        for (const size_t i : find_clashes()) {
+          const path_t& parent = remaining_parents[i];
+          if (!is_renamable[i] || parent.filename().empty()) {
+            continue;  // Nothing left to climb
+          }
+          path_t name = parent.filename();
+          name += "_";
+          name += names[i];
+          names[i] = name;
+          remaining_parents[i] = parent.parent_path();
+          did_climb = true;
+        }
+      }
+    }
+    else if (naming == ExportNaming::PATH_HASH) {
+      static const char HEX_DIGITS[] = "0123456789abcdef";
+      for (const size_t i : find_clashes()) {
+        if (!is_renamable[i]) {
+          continue;
+        }
+        // 64-bit FNV-1a over the normalized path's code units.
+        std::uint64_t hash = 14695981039346656037ull;
+        for (const auto c : toKey(sources[i].lexically_normal())) {
+          const auto unit = static_cast<std::make_unsigned_t<path_t::value_type>>(c);
+          hash = (hash ^ unit) * 1099511628211ull;
+        }
+        std::string suffix = "_";
+        for (int shift = 28; shift >= 0; shift -= 4) {
+          suffix += HEX_DIGITS[(hash >> shift) & 0xf];
+        }
+        path_t name = names[i].stem();
+        name += suffix;
+        name += names[i].extension();
+        names[i] = name;
+      }
+    }
+
+    numberDuplicates(names);
+    return names;
+  }
+
+  int ExportNamer::countNameCollisions(const std::vector<path_t>& sources) {
+    std::unordered_map<path_t::string_type, int> counts;
+    for (const auto& source : sources) {
+      ++counts[toKey(source.filename())];
+    }
+    int num_collisions = 0;
+    for (const auto& [key, count] : counts) {
+      if (count > 1) {
+        num_collisions += count;
+      }
+    }
+    return num_collisions;
+  }
+
+  path_t::string_type ExportNamer::toKey(const path_t& name) {
+    path_t::string_type key = name.native();
+#ifdef _WIN32
+    // Windows file systems ignore case by default.
+    std::transform(key.begin(), key.end(), key.begin(), [](const wchar_t c) {
+      return static_cast<wchar_t>(std::towlower(c));
+      });
+#endif
+    return key;
+  }
+
+  std::vector<path_t> ExportNamer::relativeToCommonAncestor(const std::vector<path_t>& sources) {
+    if (sources.empty()) {
+      return {};
+    }
+
+    std::vector<std::vector<path_t>> components;
+    components.reserve(sources.size());
+    for (const auto& source : sources) {
+      const path_t normalized = source.lexically_normal();
+      components.emplace_back(normalized.begin(), normalized.end());
+    }
+
+    // Only directories can be shared, so each file's last component is excluded.
+    size_t num_common = components[0].empty() ? 0 : components[0].size() - 1;
+    for (const auto& path_components : components) {
+      num_common = std::min(num_common, path_components.empty() ? 0 : path_components.size() - 1);
+      for (size_t i = 0; i < num_common; ++i) {
+        if (toKey(path_components[i]) != toKey(components[0][i])) {
+          num_common = i;
+          break;
+        }
+      }
+    }
+
+    std::vector<path_t> relative_paths;
+    relative_paths.reserve(sources.size());
+    for (size_t i = 0; i < sources.size(); ++i) {
+      const path_t normalized = sources[i].lexically_normal();
+      const size_t num_root_components = (normalized.has_root_name() ? 1 : 0)
+        + (normalized.has_root_directory() ? 1 : 0);
+      path_t relative;
+      for (size_t j = num_common; j < components[i].size(); ++j) {
+        if (j >= num_root_components) {
+          relative /= components[i][j];
+        }
+        else if (normalized.has_root_name() && j == 0) {
+          // Different drives share no ancestor, so each drive becomes a directory of its own.
+          std::wstring drive = components[i][j].wstring();
+          drive.erase(std::remove_if(drive.begin(), drive.end(), [](const wchar_t c) {
+            return c == L':' || c == L'\\' || c == L'/';
+            }), drive.end());
+          if (!drive.empty()) {
+            relative /= path_t(drive);
+          }
+        }
+      }
+      relative_paths.push_back(relative);
+    }
+    return relative_paths;
+  }
+
+  void ExportNamer::numberDuplicates(std::vector<path_t>& names) {
+    // Counters never produce a name that some other file was given to begin with.
+    std::unordered_set<path_t::string_type> original_keys;
+    for (const auto& name : names) {
+      original_keys.insert(toKey(name));
+    }
+
+    std::unordered_set<path_t::string_type> used_keys;
+    std::unordered_map<path_t::string_type, int> next_counters;
+    for (auto& name : names) {
+      const auto key = toKey(name);
+      if (used_keys.insert(key).second) {
+        continue;
+      }
+      int& counter = next_counters.try_emplace(key, 2).first->second;
+      while (true) {
+        path_t candidate = name.stem();
+        candidate += " (" + std::to_string(counter++) + ")";
+        candidate += name.extension();
+        candidate = name.parent_path() / candidate;
+        const auto candidate_key = toKey(candidate);
+        if (original_keys.count(candidate_key) == 0 && used_keys.insert(candidate_key).second) {
+          name = candidate;
+          break;
+        }
+      }
+    }
+  }
+}  // namespace ragtag
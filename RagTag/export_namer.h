@@ -0,0 +1,81 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#ifndef INCLUDE_EXPORT_NAMER_H
+#define INCLUDE_EXPORT_NAMER_H
+
+#include "tag_map.h"
+#include <vector>
+
+namespace ragtag {
+  //! How files gathered from many directories are named within an export.
+  enum class ExportNaming {
+    NUMBERED,       //!< Files sharing a name are told apart by a counter, as in "clip (2).mp4".
+    PARENT_PREFIX,  //!< Files sharing a name are prefixed with their parent directories' names.
+    PATH_HASH,      //!< Files sharing a name are suffixed with a short hash of their source path.
+    MIRRORED_TREE   //!< Files keep their paths relative to the sources' common ancestor.
+  };
+
+  //! Planner of collision-free names for files exported to a single directory.
+  //! 
+  //! Plans are made in memory, in one pass over the sources, without consulting the filesystem.
+  //! Names depend only on the sources and the naming strategy, so exporting the same files again
+  //! yields the same names, and files already exported can be recognized as such. (Names can still
+  //! clash with unrelated files already in the destination; the copy itself must guard against
+  //! that.)
+  class ExportNamer {
+  public:
+    //! Chooses a distinct destination for each of a set of files.
+    //! 
+    //! Under every flattening strategy, a file whose name no other source shares keeps its name.
+    //! Names are compared without regard to case on Windows, where the filesystem would consider
+    //! them the same. Any clash a strategy fails to resolve is settled by numbering.
+    //! 
+    //! @param sources The files to export. Must be distinct.
+    //! @param naming The strategy for telling apart files that share a name.
+    //! @returns A path relative to the export directory for each source, in the same order.
+    static std::vector<path_t> planNames(const std::vector<path_t>& sources,
+      ExportNaming naming);
+
+    //! Counts the files that share their name with another file in a set.
+    //! 
+    //! @param sources The files of interest.
+    //! @returns The number of files whose name isn't unique, or zero if flattening them into one
+    //!     directory needs no disambiguation.
+    static int countNameCollisions(const std::vector<path_t>& sources);
+
+  private:
+    //! Obtains the form of a name used to detect clashes.
+    //! 
+    //! @param name The name or relative path to compare.
+    //! @returns The name as the filesystem would compare it.
+    static path_t::string_type toKey(const path_t& name);
+
+    //! Computes the paths of files relative to their deepest common ancestor directory.
+    //! 
+    //! @param sources The files of interest.
+    //! @returns The relative path of each file. Files on different drives are placed under a
+    //!     directory named after their drive.
+    static std::vector<path_t> relativeToCommonAncestor(const std::vector<path_t>& sources);
+
+    //! Makes a set of names distinct by appending counters to all but the first of each group of
+    //! clashing names.
+    //! 
+    //! @param names The names to settle, modified in place.
+    static void numberDuplicates(std::vector<path_t>& names);
+  };
+}  // namespace ragtag
+
+#endif  // INCLUDE_EXPORT_NAMER_H
@@ -0,0 +1,87 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "file_selection.h"
+#include <algorithm>
+#include <bit>
+
+namespace ragtag {
+  const file_id_t FileSelection::BITS_PER_WORD = 64;
+
+  void FileSelection::reset(const file_id_t id_limit) {
+    id_limit_ = std::max(id_limit, 0);
+    words_.assign((id_limit_ + BITS_PER_WORD - 1) / BITS_PER_WORD, 0);
+    count_ = 0;
+  }
+
+  file_id_t FileSelection::idLimit() const {
+    return id_limit_;
+  }
+
+  bool FileSelection::isSelected(const file_id_t id) const {
+    if (id < 0 || id >= id_limit_) {
+      return false;
+    }
+    return (words_[id / BITS_PER_WORD] >> (id % BITS_PER_WORD)) & 1;
+  }
+
+  bool FileSelection::setSelected(const file_id_t id, const bool selected) {
+    if (id < 0 || id >= id_limit_) {
+      return false;
+    }
+
+    word_t& word = words_[id / BITS_PER_WORD];
+    const word_t mask = word_t{ 1 } << (id % BITS_PER_WORD);
+    if (((word & mask) != 0) == selected) {
+      return false;
+    }
+
+    word ^= mask;
+    count_ += selected ? 1 : -1;
+    return true;
+  }
+
+  void FileSelection::selectAll(const std::vector<file_id_t>& ids) {
+    for (const file_id_t id : ids) {
+      setSelected(id, true);
+    }
+  }
+
+  void FileSelection::clear() {
+    std::fill(words_.begin(), words_.end(), 0);
+    count_ = 0;
+  }
+
+  long FileSelection::count() const {
+    return count_;
+  }
+
+  long FileSelection::countAmong(const std::vector<file_id_t>& ids) const {
+    return static_cast<long>(std::count_if(ids.begin(), ids.end(),
+      [this](const file_id_t id) { return isSelected(id); }));
+  }
+
+  std::vector<file_id_t> FileSelection::getSelectedIds() const {
+    std::vector<file_id_t> returning;
+    returning.reserve(count_);
+    for (size_t i = 0; i < words_.size(); ++i) {
+      // Peel off the lowest set bit until none remain, skipping runs of unselected files at once.
+      for (word_t word = words_[i]; word != 0; word &= word - 1) {
+        returning.push_back(static_cast<file_id_t>(i) * BITS_PER_WORD + std::countr_zero(word));
+      }
+    }
+    return returning;
+  }
+}  // namespace ragtag
@@ -0,0 +1,98 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#ifndef INCLUDE_FILE_SELECTION_H
+#define INCLUDE_FILE_SELECTION_H
+
+#include "tag_map.h"
+#include <cstdint>
+#include <vector>
+
+namespace ragtag {
+  //! Set of selected files of a TagMap, stored as a bitmap over file IDs.
+  //! 
+  //! File IDs are dense, so one bit per ID makes membership tests and updates O(1), and clearing,
+  //! counting, and enumerating the selection cost one pass over a compact array of words. Because
+  //! file IDs are stable, a selection outlives any reordering or filtering of the files displayed.
+  class FileSelection {
+  public:
+    //! Clears the selection and sizes it for a tag map.
+    //! 
+    //! @param id_limit One greater than the highest file ID that may be selected (see
+    //!     TagMap::fileIdLimit()).
+    void reset(file_id_t id_limit);
+
+    //! Obtains the limit passed to the last call to reset().
+    //! 
+    //! @returns One greater than the highest file ID that may be selected.
+    file_id_t idLimit() const;
+
+    //! Tests whether a file is selected.
+    //! 
+    //! @param id The ID of the file.
+    //! @returns True if the file is selected. IDs out of range are never selected.
+    bool isSelected(file_id_t id) const;
+
+    //! Selects or deselects a file.
+    //! 
+    //! @param id The ID of the file. IDs out of range are ignored.
+    //! @param selected True to select the file; false to deselect it.
+    //! @returns True if the file's selection state changed.
+    bool setSelected(file_id_t id, bool selected);
+
+    //! Selects every file in a list.
+    //! 
+    //! @param ids The IDs of the files to select. IDs out of range are ignored.
+    void selectAll(const std::vector<file_id_t>& ids);
+
+    //! Deselects every file.
+    void clear();
+
+    //! Obtains the count of selected files.
+    //! 
+    //! @returns The number of selected files.
+    long count() const;
+
+    //! Counts the selected files within a list.
+    //! 
+    //! @param ids The IDs of the files to consider.
+    //! @returns The number of entries of `ids` that are selected.
+    long countAmong(const std::vector<file_id_t>& ids) const;
+
+    //! Retrieves the IDs of all selected files.
+    //! 
+    //! @returns The IDs of all selected files in ascending order.
+    std::vector<file_id_t> getSelectedIds() const;
+
+  private:
+    //! Type of one block of the bitmap.
+    typedef std::uint64_t word_t;
+
+    //! Number of file IDs covered by one word of the bitmap.
+    static const file_id_t BITS_PER_WORD;
+
+    //! The bitmap. Bit `id % BITS_PER_WORD` of word `id / BITS_PER_WORD` is set if file `id` is
+    //! selected.
+    std::vector<word_t> words_{};
+
+    //! One greater than the highest file ID that may be selected.
+    file_id_t id_limit_{ 0 };
+
+    //! Count of bits set within `words_`.
+    long count_{ 0 };
+  };
+}  // namespace ragtag
+
+#endif  // INCLUDE_FILE_SELECTION_H
@@ -0,0 +1,210 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "file_status_cache.h"
+#include <algorithm>
+#include <atomic>
+#include <cwctype>
+#include <set>
+#include <system_error>
+#include <thread>
+
+namespace ragtag {
+  const std::chrono::milliseconds FileStatusCache::DEFAULT_TIME_TO_LIVE{ 10000 };
+  const int FileStatusCache::MAX_LISTING_THREADS = 8;
+
+  FileStatusCache::FileStatusCache(const std::chrono::milliseconds time_to_live)
+    : time_to_live_(time_to_live) {}
+
+  void FileStatusCache::prefetch(const std::vector<path_t>& paths) {
+    const auto now = std::chrono::steady_clock::now();
+    std::vector<path_t> directories;
+    std::vector<std::optional<std::filesystem::file_time_type>> previous_write_times;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      std::set<path_t> directory_set;
+      for (const auto& path : paths) {
+        const path_t directory = path.parent_path();
+        if (!directory.empty() && !isFresh(directory, now)) {
+          directory_set.insert(directory);
+        }
+      }
+      directories.assign(directory_set.begin(), directory_set.end());
+      for (const auto& directory : directories) {
+        previous_write_times.push_back(getListedWriteTime(directory));
+      }
+    }
+    if (directories.empty()) {
+      return;
+    }
+
+    // Listing is dominated by waiting on the filesystem, so it pays to keep several requests in
+    // flight even on machines with few cores.
+    std::vector<std::optional<Listing>> results(directories.size());
+    std::atomic<size_t> next_index{ 0 };
+    const auto work = [&]() {
+      for (size_t i = next_index++; i < directories.size(); i = next_index++) {
+        results[i] = refreshListing(directories[i], previous_write_times[i]);
+      }
+      };
+    const size_t num_threads = std::min(directories.size(),
+      static_cast<size_t>(MAX_LISTING_THREADS));
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    for (size_t i = 1; i < num_threads; ++i) {
+      threads.emplace_back(work);
+    }
+    work();  // This thread does its share too.
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < directories.size(); ++i) {
+      storeListing(directories[i], std::move(results[i]), now);
+    }
+  }
+
+  bool FileStatusCache::isPresent(const path_t& path) {
+    const path_t directory = path.parent_path();
+    const path_t name = path.filename();
+    std::optional<bool> is_present;
+    if (!directory.empty() && !name.empty()) {
+      const auto now = std::chrono::steady_clock::now();
+      std::optional<std::filesystem::file_time_type> previous_write_time;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (isFresh(directory, now)) {
+          is_present = lookUp(listings_.at(directory), name);
+        }
+        else {
+          previous_write_time = getListedWriteTime(directory);
+        }
+      }
+
+      if (!is_present.has_value()) {
+        auto refreshed = refreshListing(directory, previous_write_time);
+        std::lock_guard<std::mutex> lock(mutex_);
+        storeListing(directory, std::move(refreshed), now);
+        const auto listing_it = listings_.find(directory);
+        if (listing_it != listings_.end()) {
+          is_present = lookUp(listing_it->second, name);
+        }
+      }
+    }
+
+    if (!is_present.has_value()) {
+      // No listing can answer, so ask about the file directly.
+      std::error_code error;
+      return std::filesystem::exists(path, error);
+    }
+    return *is_present;
+  }
+
+  void FileStatusCache::invalidate() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    listings_.clear();
+  }
+
+  bool FileStatusCache::isFresh(const path_t& directory,
+    const std::chrono::steady_clock::time_point now) const {
+    const auto listing_it = listings_.find(directory);
+    return listing_it != listings_.end() && now - listing_it->second.verified_at < time_to_live_;
+  }
+
+  std::optional<std::filesystem::file_time_type> FileStatusCache::getListedWriteTime(
+    const path_t& directory) const {
+    const auto listing_it = listings_.find(directory);
+    if (listing_it == listings_.end() || !listing_it->second.is_listed) {
+      return {};
+    }
+    return listing_it->second.last_write_time;
+  }
+
+  void FileStatusCache::storeListing(const path_t& directory, std::optional<Listing> listing,
+    const std::chrono::steady_clock::time_point now) {
+    if (listing.has_value()) {
+      listings_.insert_or_assign(directory, std::move(*listing));
+      return;
+    }
+
+    // The existing listing is still current. (It may have been discarded by invalidate() in the
+    // meantime, in which case there's nothing to renew.)
+    const auto listing_it = listings_.find(directory);
+    if (listing_it != listings_.end()) {
+      listing_it->second.verified_at = now;
+    }
+  }
+
+  std::optional<bool> FileStatusCache::lookUp(const Listing& listing, const path_t& name) {
+    if (!listing.is_listed) {
+      if (!listing.directory_exists) {
+        return false;
+      }
+      // The directory exists but can't be listed (for lack of permission, say), though the file
+      // itself may still be reachable.
+      return {};
+    }
+    return listing.names.contains(toKey(name));
+  }
+
+  std::optional<FileStatusCache::Listing> FileStatusCache::refreshListing(
+    const path_t& directory,
+    const std::optional<std::filesystem::file_time_type> previous_write_time) {
+    Listing listing;
+    listing.verified_at = std::chrono::steady_clock::now();
+
+    std::error_code error;
+    listing.last_write_time = std::filesystem::last_write_time(directory, error);
+    if (error) {
+      // Most likely the directory doesn't exist. Ask once more to be sure.
+      std::error_code exists_error;
+      listing.directory_exists = std::filesystem::exists(directory, exists_error);
+      return listing;
+    }
+    listing.directory_exists = true;
+
+    if (previous_write_time.has_value() && *previous_write_time == listing.last_write_time) {
+      // Adding, removing, or renaming an entry updates the directory's last-write time, so the
+      // previous listing is still accurate.
+      return {};
+    }
+
+    // Note: directory_iterator documentation explains that the end iterator is equal to the
+    // default-constructed iterator.
+    for (std::filesystem::directory_iterator dir_it(directory, error);
+      !error && dir_it != std::filesystem::directory_iterator(); dir_it.increment(error)) {
+      listing.names.insert(toKey(dir_it->path().filename()));
+    }
+    if (error) {
+      listing.names.clear();
+      return listing;
+    }
+
+    listing.is_listed = true;
+    return listing;
+  }
+
+  path_t::string_type FileStatusCache::toKey(const path_t& name) {
+    path_t::string_type key = name.native();
+#ifdef _WIN32
+    // Windows file systems ignore case by default, as does std::filesystem::exists() there.
+    std::transform(key.begin(), key.end(), key.begin(), [](const wchar_t c) {
+      return static_cast<wchar_t>(std::towlower(c));
+      });
+#endif
+    return key;
+  }
+}  // namespace ragtag
@@ -0,0 +1,148 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#ifndef INCLUDE_FILE_STATUS_CACHE_H
+#define INCLUDE_FILE_STATUS_CACHE_H
+
+#include "tag_map.h"
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+
+namespace ragtag {
+  //! Cache answering whether files are present on disk without querying each file individually.
+  //! 
+  //! Presence is resolved by listing each file's parent directory once and looking the file up in
+  //! that listing, which turns one filesystem round trip per file into one per directory. This
+  //! matters most for network shares, where each round trip is slow. prefetch() lists many
+  //! directories in parallel.
+  //! 
+  //! A listing is trusted for a fixed time to live. After that, it's kept if the directory's
+  //! last-write time hasn't changed and relisted otherwise. Call invalidate() after modifying files
+  //! so that the changes are seen immediately.
+  //! 
+  //! The cache may be used from several threads at once. Directories are listed without holding
+  //! the cache's lock, so a slow listing on one thread doesn't hold up queries answered from memory
+  //! on another.
+  class FileStatusCache {
+  public:
+    //! Time for which a listing is trusted before its directory is checked for changes.
+    static const std::chrono::milliseconds DEFAULT_TIME_TO_LIVE;
+
+    //! Maximum number of directories listed concurrently by prefetch().
+    static const int MAX_LISTING_THREADS;
+
+    //! Constructor.
+    //! 
+    //! @param time_to_live Time for which a listing is trusted before its directory is checked for
+    //!     changes. Zero checks the directory on every query.
+    explicit FileStatusCache(std::chrono::milliseconds time_to_live = DEFAULT_TIME_TO_LIVE);
+
+    //! Brings the listings of the parent directories of many files up to date at once.
+    //! 
+    //! Each distinct directory is listed at most once, and directories are listed in parallel.
+    //! Subsequent calls to isPresent() for these files are answered from memory.
+    //! 
+    //! @param paths The files whose presence will be queried.
+    void prefetch(const std::vector<path_t>& paths);
+
+    //! Determines whether a file is present on disk.
+    //! 
+    //! @param path The file of interest.
+    //! @returns True if the file exists.
+    bool isPresent(const path_t& path);
+
+    //! Discards all listings so that the next query of any file goes to disk.
+    void invalidate();
+
+  private:
+    //! Snapshot of the names of the entries within one directory.
+    struct Listing {
+      //! Whether the directory could be listed. If false and the directory exists, presence is
+      //! determined by querying files individually.
+      bool is_listed{ false };
+      //! Whether the directory exists.
+      bool directory_exists{ false };
+      //! Last-write time of the directory when it was listed.
+      std::filesystem::file_time_type last_write_time{};
+      //! When the listing was made or last confirmed to be current.
+      std::chrono::steady_clock::time_point verified_at{};
+      //! Keys (see toKey()) of the names of all entries within the directory.
+      std::unordered_set<path_t::string_type> names{};
+    };
+
+    //! Checks whether a directory's listing can be used without going to disk. Requires `mutex_`.
+    //! 
+    //! @param directory The directory of interest.
+    //! @param now The current time.
+    //! @returns True if a listing exists and its time to live hasn't elapsed.
+    bool isFresh(const path_t& directory, std::chrono::steady_clock::time_point now) const;
+
+    //! Obtains the last-write time recorded by a directory's listing. Requires `mutex_`.
+    //! 
+    //! @param directory The directory of interest.
+    //! @returns The last-write time of the directory when it was listed, or an empty optional if
+    //!     there is no complete listing of the directory.
+    std::optional<std::filesystem::file_time_type> getListedWriteTime(
+      const path_t& directory) const;
+
+    //! Records the outcome of refreshListing(). Requires `mutex_`.
+    //! 
+    //! @param directory The directory that was listed.
+    //! @param listing The new listing, or an empty optional to confirm the existing listing.
+    //! @param now The current time.
+    void storeListing(const path_t& directory, std::optional<Listing> listing,
+      std::chrono::steady_clock::time_point now);
+
+    //! Looks a file up within a listing.
+    //! 
+    //! @param listing The listing of the file's directory.
+    //! @param name The file name (without any directory).
+    //! @returns Whether the file is present, or an empty optional if the listing can't tell and the
+    //!     file must be queried directly.
+    static std::optional<bool> lookUp(const Listing& listing, const path_t& name);
+
+    //! Brings a directory's listing up to date, reusing the previous listing if the directory
+    //! hasn't changed since. Doesn't touch the cache, so it can run without `mutex_`.
+    //! 
+    //! @param directory The directory to list.
+    //! @param previous_write_time The last-write time recorded by the previous complete listing of
+    //!     the directory, if any.
+    //! @returns A new listing or an empty optional if the previous listing is still current.
+    static std::optional<Listing> refreshListing(const path_t& directory,
+      std::optional<std::filesystem::file_time_type> previous_write_time);
+
+    //! Produces the key under which a file name is recorded within a listing.
+    //! 
+    //! @param name The file name (without any directory).
+    //! @returns The key, folded to lowercase on platforms whose file systems ignore case.
+    static path_t::string_type toKey(const path_t& name);
+
+    //! Time for which a listing is trusted before its directory is checked for changes.
+    std::chrono::milliseconds time_to_live_;
+
+    //! Guards `listings_`.
+    mutable std::mutex mutex_{};
+
+    //! Listings of all directories queried so far.
+    std::map<path_t, Listing> listings_{};
+  };
+}  // namespace ragtag
+
+#endif  // INCLUDE_FILE_STATUS_CACHE_H
@@ -0,0 +1,148 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "filter_plan.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace ragtag {
+  const int FilterPlan::CANCELLATION_CHECK_INTERVAL = 1024;
+  const size_t FilterPlan::PROGRESS_SLICE_SIZE = 4096;
+  const std::chrono::milliseconds FilterPlan::PROGRESS_INTERVAL{ 100 };
+
+  void FilterPlan::addStage(const std::string& name, const double cost, predicate_t predicate,
+    preparer_t preparer) {
+    // Inserting after stages of equal cost keeps ties in the order they were added.
+    const auto position = std::upper_bound(stages_.begin(), stages_.end(), cost,
+      [](const double c, const Stage& stage) { return c < stage.cost; });
+    stages_.insert(position, Stage{ name, cost, std::move(predicate), std::move(preparer) });
+  }
+
+  int FilterPlan::numStages() const {
+    return static_cast<int>(stages_.size());
+  }
+
+  bool FilterPlan::accepts(const file_id_t id) const {
+    return std::all_of(stages_.begin(), stages_.end(), [id](const Stage& stage) {
+      return std::invoke(stage.predicate, id);
+      });
+  }
+
+  std::vector<file_id_t> FilterPlan::run(std::vector<file_id_t> candidates) {
+    // Without a cancellation function, the run can't be abandoned.
+    return *run(std::move(candidates), {});
+  }
+
+  std::optional<std::vector<file_id_t>> FilterPlan::run(std::vector<file_id_t> candidates,
+    const cancellation_t& is_cancelled) {
+    stage_stats_.clear();
+    if (!runStages(candidates, is_cancelled)) {
+      return {};
+    }
+    return candidates;
+  }
+
+  std::optional<std::vector<file_id_t>> FilterPlan::runProgressively(
+    const std::vector<file_id_t>& candidates, const cancellation_t& is_cancelled,
+    const progress_t& on_progress, const size_t first_report_size) {
+    stage_stats_.clear();
+    std::vector<file_id_t> matches;
+    size_t num_reported = 0;
+    auto last_report_time = std::chrono::steady_clock::now();
+    std::vector<file_id_t> slice;
+    for (size_t begin = 0; begin < candidates.size(); begin += PROGRESS_SLICE_SIZE) {
+      const size_t end = std::min(begin + PROGRESS_SLICE_SIZE, candidates.size());
+      slice.assign(candidates.begin() + begin, candidates.begin() + end);
+      if (!runStages(slice, is_cancelled)) {
+        return {};
+      }
+      matches.insert(matches.end(), slice.begin(), slice.end());
+
+      // Don't bother reporting when the run is about to finish anyway.
+      if (!on_progress || end == candidates.size() || matches.size() == num_reported) {
+        continue;
+      }
+      const auto now = std::chrono::steady_clock::now();
+      const bool is_first_report = num_reported == 0;
+      if ((is_first_report && matches.size() >= first_report_size)
+        || now - last_report_time >= PROGRESS_INTERVAL) {
+        on_progress(matches);
+        num_reported = matches.size();
+        last_report_time = now;
+      }
+    }
+
+    if (stage_stats_.empty()) {
+      // There were no candidates, so no slice recorded the stages.
+      runStages(slice, {});
+    }
+    return matches;
+  }
+
+  const std::vector<FilterPlan::StageStats>& FilterPlan::getStageStats() const {
+    return stage_stats_;
+  }
+
+  std::string FilterPlan::describeStageStats() const {
+    std::ostringstream description;
+    description << std::fixed << std::setprecision(1);
+    for (const auto& stats : stage_stats_) {
+      const double percent_passed = stats.num_evaluated == 0 ? 100.0
+        : 100.0 * stats.num_passed / stats.num_evaluated;
+      const double milliseconds = std::chrono::duration<double, std::milli>(stats.elapsed).count();
+      description << stats.name << ": " << stats.num_passed << "/" << stats.num_evaluated << " ("
+        << percent_passed << "%) in " << milliseconds << " ms\n";
+    }
+    return description.str();
+  }
+
+  bool FilterPlan::runStages(std::vector<file_id_t>& candidates,
+    const cancellation_t& is_cancelled) {
+    for (size_t stage_index = 0; stage_index < stages_.size(); ++stage_index) {
+      if (is_cancelled && is_cancelled()) {
+        return false;
+      }
+
+      const Stage& stage = stages_[stage_index];  // Alias for convenience
+      if (stage_stats_.size() <= stage_index) {
+        stage_stats_.push_back(StageStats{ .name = stage.name });
+      }
+      StageStats& stats = stage_stats_[stage_index];  // Alias for convenience
+      stats.num_evaluated += static_cast<int>(candidates.size());
+
+      const auto start = std::chrono::steady_clock::now();
+      if (stage.preparer) {
+        stage.preparer(candidates);
+      }
+      // Compact survivors toward the front in place, as std::remove_if would, but pause
+      // periodically to check whether to keep going.
+      size_t num_kept = 0;
+      for (size_t i = 0; i < candidates.size(); ++i) {
+        if (is_cancelled && i % CANCELLATION_CHECK_INTERVAL == 0 && i > 0 && is_cancelled()) {
+          return false;
+        }
+        if (stage.predicate(candidates[i])) {
+          candidates[num_kept++] = candidates[i];
+        }
+      }
+      candidates.resize(num_kept);
+      stats.elapsed += std::chrono::steady_clock::now() - start;
+
+      stats.num_passed += static_cast<int>(candidates.size());
+    }
+    return true;
+  }
+}  // namespace ragtag
@@ -0,0 +1,177 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#ifndef INCLUDE_FILTER_PLAN_H
+#define INCLUDE_FILTER_PLAN_H
+
+#include "tag_map.h"
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace ragtag {
+  //! Sequence of filter stages that narrows a list of files, cheapest stage first.
+  //! 
+  //! A plan is built once from the state of the filter controls and then run over the candidate
+  //! files. Each stage is run over the survivors of the previous stages, so placing expensive
+  //! stages (such as checking whether files exist on disk) last means they only see files that
+  //! every cheaper stage has already accepted.
+  //! 
+  //! Stages run one at a time over all survivors rather than file by file, which lets each stage
+  //! prepare for the survivors in bulk and lets the plan report how long each stage took and how
+  //! many files it let through.
+  class FilterPlan {
+  public:
+    //! Function deciding whether the file with a given ID passes a stage.
+    typedef std::function<bool(file_id_t)> predicate_t;
+
+    //! Function invoked with the survivors of the preceding stages just before a stage runs, for
+    //! example to fetch information about them in bulk.
+    typedef std::function<void(const std::vector<file_id_t>&)> preparer_t;
+
+    //! Function reporting whether a run should be abandoned, for example because its result is no
+    //! longer wanted.
+    typedef std::function<bool()> cancellation_t;
+
+    //! Function receiving every file found to pass all stages so far during a progressive run.
+    typedef std::function<void(const std::vector<file_id_t>&)> progress_t;
+
+    //! Statistics describing one run of a stage.
+    struct StageStats {
+      //! Name of the stage.
+      std::string name{};
+      //! Number of files the stage examined.
+      int num_evaluated{ 0 };
+      //! Number of files that passed the stage.
+      int num_passed{ 0 };
+      //! Time taken by the stage, including preparation.
+      std::chrono::nanoseconds elapsed{ 0 };
+    };
+
+    //! Adds a stage to the plan.
+    //! 
+    //! Stages run in order of increasing cost. Stages of equal cost run in the order they were
+    //! added.
+    //! 
+    //! @param name Name of the stage as reported in its statistics.
+    //! @param cost Relative cost of evaluating the stage for one file.
+    //! @param predicate Function deciding whether a file passes the stage.
+    //! @param preparer Optional function invoked with the survivors before the stage runs.
+    void addStage(const std::string& name, double cost, predicate_t predicate,
+      preparer_t preparer = {});
+
+    //! Obtains the number of stages in the plan.
+    //! 
+    //! @returns The number of stages.
+    int numStages() const;
+
+    //! Checks whether a single file passes every stage.
+    //! 
+    //! Stages are evaluated in order of cost, stopping at the first that rejects the file.
+    //! Preparers aren't invoked and no statistics are recorded, so this suits callers that visit
+    //! files one at a time rather than filtering a list.
+    //! 
+    //! @param id The ID of the file to check.
+    //! @returns True if the file passes every stage.
+    bool accepts(file_id_t id) const;
+
+    //! Runs every stage in order of cost, recording statistics for each.
+    //! 
+    //! @param candidates The IDs of the files to filter.
+    //! @returns The IDs of the files that pass every stage, in their original relative order.
+    std::vector<file_id_t> run(std::vector<file_id_t> candidates);
+
+    //! Runs every stage in order of cost, abandoning the run if asked to.
+    //! 
+    //! Cancellation is checked between stages and periodically within each stage, so a long run
+    //! stops soon after it's no longer wanted.
+    //! 
+    //! @param candidates The IDs of the files to filter.
+    //! @param is_cancelled Function reporting whether to abandon the run. May be empty.
+    //! @returns The IDs of the files that pass every stage, in their original relative order, or an
+    //!     empty optional if the run was abandoned.
+    std::optional<std::vector<file_id_t>> run(std::vector<file_id_t> candidates,
+      const cancellation_t& is_cancelled);
+
+    //! Runs every stage over successive slices of the candidates, reporting matches as they're
+    //! found so that a caller can show them before the whole run completes.
+    //! 
+    //! The first report is made as soon as `first_report_size` files have passed (or sooner, if
+    //! matches are sparse and PROGRESS_INTERVAL passes first), and later reports are made at most
+    //! once per PROGRESS_INTERVAL. Each report carries every match found so far. Matches found
+    //! after the final report are only returned. Statistics are accumulated across all slices.
+    //! 
+    //! @param candidates The IDs of the files to filter.
+    //! @param is_cancelled Function reporting whether to abandon the run. May be empty.
+    //! @param on_progress Function receiving the matches found so far.
+    //! @param first_report_size The number of matches that warrants the first report, such as
+    //!     the number of rows visible at once.
+    //! @returns The IDs of the files that pass every stage, in their original relative order, or an
+    //!     empty optional if the run was abandoned.
+    std::optional<std::vector<file_id_t>> runProgressively(
+      const std::vector<file_id_t>& candidates, const cancellation_t& is_cancelled,
+      const progress_t& on_progress, size_t first_report_size);
+
+    //! Retrieves the statistics of the most recent run.
+    //! 
+    //! @returns Statistics for each stage, in the order the stages ran. Empty if the plan hasn't
+    //!     been run.
+    const std::vector<StageStats>& getStageStats() const;
+
+    //! Summarizes the statistics of the most recent run in human-readable form.
+    //! 
+    //! @returns One line per stage giving its selectivity and time taken.
+    std::string describeStageStats() const;
+
+  private:
+    //! A stage of the plan.
+    struct Stage {
+      //! Name of the stage.
+      std::string name{};
+      //! Relative cost of evaluating the stage for one file.
+      double cost{ 0.0 };
+      //! Function deciding whether a file passes the stage.
+      predicate_t predicate{};
+      //! Optional function invoked with the survivors before the stage runs.
+      preparer_t preparer{};
+    };
+
+    //! Number of files a stage examines between checks for cancellation.
+    static const int CANCELLATION_CHECK_INTERVAL;
+
+    //! Number of candidates run through every stage at a time during a progressive run.
+    static const size_t PROGRESS_SLICE_SIZE;
+
+    //! Minimum time between progress reports after the first.
+    static const std::chrono::milliseconds PROGRESS_INTERVAL;
+
+    //! Runs every stage in order of cost, adding to the statistics already recorded.
+    //! 
+    //! @param candidates The IDs of the files to filter. Narrowed in place to those that pass.
+    //! @param is_cancelled Function reporting whether to abandon the run. May be empty.
+    //! @returns False if the run was abandoned.
+    bool runStages(std::vector<file_id_t>& candidates, const cancellation_t& is_cancelled);
+
+    //! The stages of the plan, sorted by cost.
+    std::vector<Stage> stages_{};
+
+    //! Statistics of the most recent run.
+    std::vector<StageStats> stage_stats_{};
+  };
+}  // namespace ragtag
+
+#endif  // INCLUDE_FILTER_PLAN_H
@@ -0,0 +1,179 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "fuzzy_finder.h"
+#include <algorithm>
+#include <cwctype>
+#include <tuple>
+
+namespace ragtag {
+  const int FuzzyFinder::MATCH_SCORE = 1;
+  const int FuzzyFinder::ADJACENCY_BONUS = 4;
+  const int FuzzyFinder::WORD_START_BONUS = 3;
+  const int FuzzyFinder::BASENAME_BONUS = 2;
+  const size_t FuzzyFinder::BUDGET_CHECK_INTERVAL = 1024;
+
+  namespace {
+    //! Checks whether a character separates words within a path.
+    //! 
+    //! @param c The character.
+    //! @returns True if a character following `c` begins a word.
+    bool isWordSeparator(const wchar_t c) {
+      return c == L'/' || c == L'\\' || c == L'_' || c == L'-' || c == L' ' || c == L'.';
+    }
+  }
+
+  void FuzzyFinder::build(const std::vector<path_t>& paths) {
+    text_.clear();
+    candidates_.clear();
+    candidates_.reserve(paths.size());
+    for (const auto& path : paths) {
+      const std::wstring path_text = path.wstring();
+      Candidate candidate;
+      candidate.begin = static_cast<std::uint32_t>(text_.size());
+      candidate.length = static_cast<std::uint32_t>(path_text.size());
+      const size_t last_separator = path_text.find_last_of(L"/\\");
+      candidate.basename_begin = last_separator == std::wstring::npos ? 0
+        : static_cast<std::uint32_t>(last_separator + 1);
+      for (const wchar_t c : path_text) {
+        const wchar_t folded = foldCase(c);
+        text_.push_back(folded);
+        candidate.char_mask |= maskOf(folded);
+      }
+      candidates_.push_back(candidate);
+    }
+  }
+
+  size_t FuzzyFinder::size() const {
+    return candidates_.size();
+  }
+
+  FuzzyFinder::Result FuzzyFinder::find(const std::wstring& query, const size_t max_results,
+    const std::chrono::steady_clock::duration budget) const {
+    return resume(query, max_results, budget, Result());
+  }
+
+  FuzzyFinder::Result FuzzyFinder::resume(const std::wstring& query, const size_t max_results,
+    const std::chrono::steady_clock::duration budget, const Result& partial) const {
+    const auto deadline = std::chrono::steady_clock::now() + budget;
+    std::wstring folded_query;
+    std::uint64_t query_mask = 0;
+    for (const wchar_t c : query) {
+      folded_query.push_back(foldCase(c));
+      query_mask |= maskOf(folded_query.back());
+    }
+
+    // Matches are ranked by score, then length, then index. Scores are negated so that a plain
+    // less-than ranks every match, and the worst of the best so far sits atop a max-heap.
+    typedef std::tuple<int, std::uint32_t, int> rank_t;
+    std::vector<rank_t> best;
+    Result result;
+    result.next_index = candidates_.size();
+    if (max_results == 0) {
+      return result;
+    }
+    // Matches found earlier are ranked exactly as if they'd been found now.
+    for (const auto& match : partial.matches) {
+      best.emplace_back(-match.score, candidates_[match.index].length, match.index);
+    }
+    std::make_heap(best.begin(), best.end());
+    for (size_t i = partial.next_index; i < candidates_.size(); ++i) {
+      if (i % BUDGET_CHECK_INTERVAL == 0 && i > partial.next_index
+        && std::chrono::steady_clock::now() > deadline) {
+        result.is_complete = false;
+        result.next_index = i;
+        break;
+      }
+      const Candidate& candidate = candidates_[i];  // Alias for convenience
+      if ((candidate.char_mask & query_mask) != query_mask) {
+        continue;
+      }
+      const int candidate_score = folded_query.empty() ? 0 : score(candidate, folded_query);
+      if (candidate_score < 0) {
+        continue;
+      }
+
+      const rank_t rank{ -candidate_score, candidate.length, static_cast<int>(i) };
+      if (best.size() < max_results) {
+        best.push_back(rank);
+        std::push_heap(best.begin(), best.end());
+      }
+      else if (rank < best.front()) {
+        std::pop_heap(best.begin(), best.end());
+        best.back() = rank;
+        std::push_heap(best.begin(), best.end());
+      }
+    }
+
+    std::sort_heap(best.begin(), best.end());
+    result.matches.reserve(best.size());
+    for (const auto& [negated_score, length, index] : best) {
+      result.matches.push_back({ .index = index, .score = -negated_score });
+    }
+    return result;
+  }
+
+  wchar_t FuzzyFinder::foldCase(const wchar_t c) {
+    return static_cast<wchar_t>(std::towlower(c));
+  }
+
+  std::uint64_t FuzzyFinder::maskOf(const wchar_t c) {
+    // Bits 0-25 are letters, bits 26-35 are digits, and bits 36-63 are shared by everything else.
+    if (c >= L'a' && c <= L'z') {
+      return std::uint64_t{ 1 } << (c - L'a');
+    }
+    if (c >= L'0' && c <= L'9') {
+      return std::uint64_t{ 1 } << (26 + (c - L'0'));
+    }
+    return std::uint64_t{ 1 } << (36 + static_cast<std::uint32_t>(c) % 28);
+  }
+
+  int FuzzyFinder::score(const Candidate& candidate, const std::wstring& query) const {
+    const wchar_t* text = text_.data() + candidate.begin;
+    const size_t length = candidate.length;
+    int best_score = -1;
+    for (size_t start = 0; start < length; ++start) {
+      if (text[start] != query[0]) {
+        continue;
+      }
+
+      int attempt_score = 0;
+      size_t previous = 0;
+      size_t position = start;
+      for (size_t q = 0; q < query.size(); ++q, ++position) {
+        while (position < length && text[position] != query[q]) {
+          ++position;
+        }
+        if (position >= length) {
+          // Starting later leaves even less room, so no later start can match either.
+          return best_score;
+        }
+        attempt_score += MATCH_SCORE;
+        if (q > 0 && position == previous + 1) {
+          attempt_score += ADJACENCY_BONUS;
+        }
+        if (position == 0 || isWordSeparator(text[position - 1])) {
+          attempt_score += WORD_START_BONUS;
+        }
+        if (position >= candidate.basename_begin) {
+          attempt_score += BASENAME_BONUS;
+        }
+        previous = position;
+      }
+      best_score = std::max(best_score, attempt_score);
+    }
+    return best_score;
+  }
+}  // namespace ragtag
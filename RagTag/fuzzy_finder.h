@@ -0,0 +1,150 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#ifndef INCLUDE_FUZZY_FINDER_H
+#define INCLUDE_FUZZY_FINDER_H
+
+#include "tag_map.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ragtag {
+  //! Ranked fuzzy matcher of typed queries against a fixed list of paths, as used by a "go to file"
+  //! palette.
+  //! 
+  //! A path matches a query if the query's characters appear within the path in order, ignoring
+  //! case, though not necessarily adjacently. Matches score higher when matched characters are
+  //! adjacent, begin words, or fall within the path's file name.
+  //! 
+  //! The paths are folded to lowercase once, when the finder is built, and stored back to back in
+  //! one buffer alongside a compact record per path. Each record carries a mask of the characters
+  //! the path contains, so most paths that can't match are rejected without reading their text.
+  class FuzzyFinder {
+  public:
+    //! One path matching a query.
+    struct Match {
+      //! Position of the path within the list the finder was built from.
+      int index{ 0 };
+      //! Score of the match. Higher is better.
+      int score{ 0 };
+    };
+
+    //! Outcome of a search.
+    struct Result {
+      //! The best matches found, best first.
+      std::vector<Match> matches{};
+      //! False if the search ran out of time before considering every path.
+      bool is_complete{ true };
+      //! Position of the first path not yet considered, from which resume() carries on.
+      size_t next_index{ 0 };
+    };
+
+    //! Replaces the paths searched.
+    //! 
+    //! @param paths The paths to search.
+    void build(const std::vector<path_t>& paths);
+
+    //! Obtains the number of paths searched.
+    //! 
+    //! @returns The number of paths passed to build().
+    size_t size() const;
+
+    //! Finds the paths best matching a query.
+    //! 
+    //! Ties are broken in favor of shorter paths and then paths earlier in the list. An empty query
+    //! matches every path.
+    //! 
+    //! @param query The typed query.
+    //! @param max_results The greatest number of matches to return.
+    //! @param budget Time after which to stop considering further paths and return the best
+    //!     matches found so far.
+    //! @returns The best matches, best first.
+    Result find(const std::wstring& query, size_t max_results,
+      std::chrono::steady_clock::duration budget) const;
+
+    //! Carries on a search that ran out of time, considering the paths it didn't reach.
+    //! 
+    //! Resuming until the result is complete finds the same matches as a single search with an
+    //! unlimited budget.
+    //! 
+    //! @param query The typed query, as passed to find().
+    //! @param max_results The greatest number of matches to return, as passed to find().
+    //! @param budget Time after which to stop considering further paths and return the best
+    //!     matches found so far.
+    //! @param partial The result of the search so far.
+    //! @returns The best matches among those of `partial` and the paths considered now, best first.
+    Result resume(const std::wstring& query, size_t max_results,
+      std::chrono::steady_clock::duration budget, const Result& partial) const;
+
+  private:
+    //! Location and summary of one path within `text_`.
+    struct Candidate {
+      //! Offset of the path's first character within `text_`.
+      std::uint32_t begin{ 0 };
+      //! Number of characters in the path.
+      std::uint32_t length{ 0 };
+      //! Offset of the path's file name from the path's first character.
+      std::uint32_t basename_begin{ 0 };
+      //! Characters present in the path, as produced by maskOf().
+      std::uint64_t char_mask{ 0 };
+    };
+
+    //! Converts a character to the case used for comparisons.
+    //! 
+    //! @param c The character to convert.
+    //! @returns The character in lowercase.
+    static wchar_t foldCase(wchar_t c);
+
+    //! Determines the bit representing a character within a character mask.
+    //! 
+    //! Letters and digits have bits of their own, and other characters share the remaining bits.
+    //! 
+    //! @param c The character, already folded to lowercase.
+    //! @returns A mask with a single bit set.
+    static std::uint64_t maskOf(wchar_t c);
+
+    //! Scores a path against a query.
+    //! 
+    //! Each occurrence of the query's first character is tried as the start of a match, with the
+    //! remaining characters matched as early as possible after it, and the best-scoring attempt
+    //! wins.
+    //! 
+    //! @param candidate The path.
+    //! @param query The query, already folded to lowercase. Must not be empty.
+    //! @returns The score of the best match, or a negative number if the path doesn't match.
+    int score(const Candidate& candidate, const std::wstring& query) const;
+
+    //! Score awarded for each matched character.
+    static const int MATCH_SCORE;
+    //! Extra score for a matched character immediately following the previous matched character.
+    static const int ADJACENCY_BONUS;
+    //! Extra score for a matched character beginning a word.
+    static const int WORD_START_BONUS;
+    //! Extra score for a matched character within the path's file name.
+    static const int BASENAME_BONUS;
+    //! Number of paths considered between checks of the time budget.
+    static const size_t BUDGET_CHECK_INTERVAL;
+
+    //! Lowercase text of every path, back to back.
+    std::wstring text_{};
+
+    //! Record of every path, in the order they were given.
+    std::vector<Candidate> candidates_{};
+  };
+}  // namespace ragtag
+
+#endif  // INCLUDE_FUZZY_FINDER_H
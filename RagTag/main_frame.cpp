@@ -15,6 +15,7 @@
 
 #include "about_dialog.h"
 #include "main_frame.h"
+#include "quick_open_dialog.h"
 #include "rag_tag_util.h"
 #include "tag_entry_dialog.h"
 #include <chrono>
@@ -23,9 +24,6 @@
 #include <wx/statusbr.h>
 #include <wx/stdpaths.h>
 
-const wxColour MainFrame::BACKGROUND_COLOR_FULLY_TAGGED = wxColour(200, 255, 200);
-const wxColour MainFrame::BACKGROUND_COLOR_PARTLY_TAGGED = wxColour(255, 255, 200);
-const wxColour MainFrame::BACKGROUND_COLOR_FULLY_UNTAGGED = wxColour(255, 255, 255);
 const double MainFrame::LEFT_PANE_STARTING_PROPORTION = 0.5;
 const double MainFrame::LEFT_PANE_MINIMUM_PROPORTION = 0.4;
 const double MainFrame::LEFT_PANE_GRAVITY = 0.75;
@@ -48,6 +46,7 @@ MainFrame::MainFrame() : wxFrame(nullptr, wxID_ANY, wxEmptyString, wxDefaultPosi
 
   m_project_ = new wxMenu;
   m_project_->Append(ID_LOAD_FILE, "&Load File...\tCtrl-O");
+  m_project_->Append(ID_GO_TO_FILE, "&Go to File...\tCtrl-Shift-P");
   m_project_->AppendSeparator();
   m_project_->Append(ID_NEXT_FILE, "Next File in Directory\tCtrl-.");
   m_project_->Enable(ID_NEXT_FILE, false);
@@ -58,6 +57,8 @@ MainFrame::MainFrame() : wxFrame(nullptr, wxID_ANY, wxEmptyString, wxDefaultPosi
   m_project_->Append(ID_PREVIOUS_UNTAGGED_FILE,
     L"Previous Untagged File in Directory\tCtrl-Shift-,");
   m_project_->Enable(ID_PREVIOUS_UNTAGGED_FILE, false);
+  m_project_->Append(ID_NEXT_UNTAGGED_PROJECT_FILE, L"Next Untagged File in Project");
+  m_project_->Append(ID_PREVIOUS_UNTAGGED_PROJECT_FILE, L"Previous Untagged File in Project");
 
   m_media_ = new wxMenu;
   m_media_->Append(ID_PLAY_PAUSE_MEDIA, "&Play/Pause Media\tCtrl-P");
@@ -198,17 +199,14 @@ MainFrame::MainFrame() : wxFrame(nullptr, wxID_ANY, wxEmptyString, wxDefaultPosi
   sz_current_directory_line->Add(st_current_directory_, 1, wxALL, 5);
   sz_directory->Add(p_current_directory_line, 0, wxEXPAND | wxALL, 0);
 
-  lc_files_in_directory_ = new wxListCtrl(sz_directory->GetStaticBox(), wxID_ANY, wxDefaultPosition,
-    wxDefaultSize, wxLC_REPORT | wxLC_SINGLE_SEL);
+  lc_files_in_directory_ = new DirectoryListCtrl(sz_directory->GetStaticBox(), directory_model_,
+    tag_map_);
   // Workaround to wxWidgets issue 25238 that causes list control to flicker when placed within
   // a static box sizer. (See https://github.com/wxWidgets/wxWidgets/issues/25238. Thank you, GitHub
   // user PBfordev.)
   //
   // TODO: Remove this line if/when issue 25238 is fixed.
   lc_files_in_directory_->MSWDisableComposited();
-  lc_files_in_directory_->InsertColumn(COLUMN_FILENAME, "File", wxLIST_FORMAT_LEFT, 250);
-  lc_files_in_directory_->InsertColumn(COLUMN_RATING, "Rating", wxLIST_FORMAT_LEFT, 80);
-  lc_files_in_directory_->InsertColumn(COLUMN_TAG_COVERAGE, "Tag Coverage", wxLIST_FORMAT_LEFT, 85);
   lc_files_in_directory_->Bind(wxEVT_LIST_ITEM_FOCUSED, &MainFrame::OnFocusFile, this);
   refreshDirectoryView();
   sz_directory->Add(lc_files_in_directory_, 1, wxEXPAND | wxALL, 5);
@@ -316,6 +314,7 @@ MainFrame::MainFrame() : wxFrame(nullptr, wxID_ANY, wxEmptyString, wxDefaultPosi
   Bind(wxEVT_MENU, &MainFrame::OnSaveProjectAs, this, ID_SAVE_PROJECT_AS);
   Bind(wxEVT_MENU, &MainFrame::OnShowSummary, this, ID_SHOW_SUMMARY);
   Bind(wxEVT_MENU, &MainFrame::OnLoadFile, this, ID_LOAD_FILE);
+  Bind(wxEVT_MENU, &MainFrame::OnGoToFile, this, ID_GO_TO_FILE);
   Bind(wxEVT_MENU, &MainFrame::OnFocusDirectoryView, this, ID_FOCUS_DIRECTORY_VIEW);
   Bind(wxEVT_MENU, &MainFrame::OnEnterCommandMode, this, ID_ENTER_COMMAND_MODE);
   Bind(wxEVT_MENU, &MainFrame::OnFocusTags, this, ID_FOCUS_TAGS);
@@ -324,6 +323,9 @@ MainFrame::MainFrame() : wxFrame(nullptr, wxID_ANY, wxEmptyString, wxDefaultPosi
   Bind(wxEVT_MENU, &MainFrame::OnPreviousFile, this, ID_PREVIOUS_FILE);
   Bind(wxEVT_MENU, &MainFrame::OnNextUntaggedFile, this, ID_NEXT_UNTAGGED_FILE);
   Bind(wxEVT_MENU, &MainFrame::OnPreviousUntaggedFile, this, ID_PREVIOUS_UNTAGGED_FILE);
+  Bind(wxEVT_MENU, &MainFrame::OnNextUntaggedProjectFile, this, ID_NEXT_UNTAGGED_PROJECT_FILE);
+  Bind(wxEVT_MENU, &MainFrame::OnPreviousUntaggedProjectFile, this,
+    ID_PREVIOUS_UNTAGGED_PROJECT_FILE);
   Bind(wxEVT_MENU, &MainFrame::OnStopMedia, this, ID_STOP_MEDIA);
   Bind(wxEVT_MENU, &MainFrame::OnPlayPauseMedia, this, ID_PLAY_PAUSE_MEDIA);
   Bind(wxEVT_MENU, &MainFrame::OnToggleAutoplayBox, this, ID_TOGGLE_AUTOPLAY);
@@ -417,122 +419,59 @@ void MainFrame::refreshTagToggles() {
 
 void MainFrame::refreshDirectoryView()
 {
+  // Set the file view modification flag so that we don't attempt to load files as changing the
+  // item count might automatically change the focused item in the list.
+  file_view_modification_in_progress_ = true;
   lc_files_in_directory_->Freeze();
 
-  if (!active_file_.has_value()) {
-    lc_files_in_directory_->DeleteAllItems();
-    file_paths_.clear();
-    st_current_directory_->SetLabelText("(None)");
-    lc_files_in_directory_->Thaw();
-    return;
+  // Deselect and de-focus the previously highlighted item, since its index may refer to a different
+  // file (or to no file at all) once the listing is replaced. This also fixes a bug that suppressed
+  // list item selection events when clicking the last item in a list after loading a file from a
+  // directory with fewer files than the prior directory had.
+  const long previous_selection = lc_files_in_directory_->GetFirstSelected();
+  if (previous_selection != -1) {
+    lc_files_in_directory_->SetItemState(previous_selection, 0,
+      wxLIST_STATE_SELECTED | wxLIST_STATE_FOCUSED);
+  }
+  const long previous_focus = lc_files_in_directory_->GetFocusedItem();
+  if (previous_focus != -1) {
+    lc_files_in_directory_->SetItemState(previous_focus, 0, wxLIST_STATE_FOCUSED);
   }
 
-  file_paths_.clear();
-  file_paths_.reserve(10000);  // Reserve enough room for large directories.
-
-  // Cache tag list since we'll be referring to it within the loop.
-  const auto all_tags = tag_map_.getAllTags();
-
-  // Cache quantity of entries presently in the list control so that we know how many entries to
-  // remove in the case we don't need as many to display this directory.
-  const int num_list_view_entries_original = lc_files_in_directory_->GetItemCount();
-
-  const ragtag::path_t parent_directory = active_file_->parent_path();
-  st_current_directory_->SetLabelText(parent_directory.wstring());
-
-  int i = 0;
-  // Note: directory_iterator documentation explains that the end iterator is equal to the
-  // default-constructed iterator.
-  for (auto file_it = std::filesystem::directory_iterator(parent_directory);
-    file_it != std::filesystem::directory_iterator(); file_it++) {
-    // Skip things like symlinks and such.
-    if (!file_it->is_regular_file()) {
-      continue;
-    }
-
-    if (i >= lc_files_in_directory_->GetItemCount()) {
-      // We're expanding beyond the current capacity and need to insert a new item.
-      lc_files_in_directory_->InsertItem(i, file_it->path().filename().wstring());
-    }
-    else {
-      // We're within the list's capacity and can simply edit existing data.
-      lc_files_in_directory_->SetItem(i, 0, file_it->path().filename().wstring());
-    }
-    
-    file_paths_.push_back(file_it->path());
-    // Set the "user data" for the list control entry to a pointer directed at the full path.
-    // Yes, this is ugly and I wish there were a better way.
-    lc_files_in_directory_->SetItemPtrData(i, reinterpret_cast<wxUIntPtr>(&file_paths_[i]));
-
-    // Handle file rating...
-    const auto rating_ret = tag_map_.getRating(file_it->path());
-    if (rating_ret.has_value()) {
-      lc_files_in_directory_->SetItem(i, COLUMN_RATING,
-        RagTagUtil::getStarTextForRating(*rating_ret));
-    }
-    else {
-      lc_files_in_directory_->SetItem(i, COLUMN_RATING, L"--");
-    }
-    
-    const ragtag::TagCoverage tag_coverage = tag_map_.getFileTagCoverage(file_it->path());
-    switch (tag_coverage) {
-    case ragtag::TagCoverage::NONE:
-      lc_files_in_directory_->SetItem(i, COLUMN_TAG_COVERAGE, L"None");
-      lc_files_in_directory_->SetItemBackgroundColour(i, BACKGROUND_COLOR_FULLY_UNTAGGED);
-      break;
-    case ragtag::TagCoverage::SOME:
-      lc_files_in_directory_->SetItem(i, COLUMN_TAG_COVERAGE, L"Some");
-      lc_files_in_directory_->SetItemBackgroundColour(i, BACKGROUND_COLOR_PARTLY_TAGGED);
-      break;
-    case ragtag::TagCoverage::ALL:
-      lc_files_in_directory_->SetItem(i, COLUMN_TAG_COVERAGE, L"All");
-      lc_files_in_directory_->SetItemBackgroundColour(i, BACKGROUND_COLOR_FULLY_TAGGED);
-      break;
-    default:
-    case ragtag::TagCoverage::NO_TAGS_DEFINED:
-      lc_files_in_directory_->SetItem(i, COLUMN_TAG_COVERAGE, L"--");
-      lc_files_in_directory_->SetItemBackgroundColour(i, BACKGROUND_COLOR_FULLY_UNTAGGED);
-      break;
-    }
-
-    ++i;
+  if (active_file_.has_value()) {
+    const ragtag::path_t parent_directory = active_file_->parent_path();
+    st_current_directory_->SetLabelText(parent_directory.wstring());
+    // The cache only enumerates the directory if its watcher can't account for changes since the
+    // last refresh. An unreadable directory is presented as empty.
+    const auto snapshot = directory_cache_.getSnapshot(parent_directory);
+    directory_model_.setListing(parent_directory, snapshot.has_value() ? *snapshot : nullptr);
+  }
+  else {
+    st_current_directory_->SetLabelText("(None)");
+    directory_model_.clear();
   }
 
-  // Remove any excess list control entries that were needed to display prior directories but not
-  // this one.
-  //
-  // Set the file view modification flag so that we don't attempt to load files as the DeleteItem()
-  // function might automatically change the selected item in the list.
-  file_view_modification_in_progress_ = true;
-  for (int j = i; j < num_list_view_entries_original; ++j) {
-    // Yes, wxWidgets uses int type for GetItemCount() but long type for indices.
-    const long index_to_delete = lc_files_in_directory_->GetItemCount() - 1;
-    // This deselects and de-focuses the item before deletion. This fixes a bug that suppressed list
-    // item selection events when clicking the last item in a list after loading a file from a
-    // directory with fewer files than the prior directory had.
-    lc_files_in_directory_->SetItemState(index_to_delete, 0,
-      wxLIST_STATE_SELECTED | wxLIST_STATE_FOCUSED);
-    lc_files_in_directory_->DeleteItem(index_to_delete);
+  // The list control is virtual, so this is all it takes to present the new listing. Cells are
+  // computed as they're drawn.
+  lc_files_in_directory_->refreshRows();
+
+  // The active file is the one whose tags are edited between refreshes, so it's the only one the
+  // navigation index needs to re-evaluate. (If the listing itself changed, the index will notice
+  // and rebuild the next time it's consulted.)
+  if (active_file_.has_value()) {
+    navigation_index_.updateFile(*active_file_, tag_map_);
   }
 
-  // Handle highlighting: Only the active file should be highlighted; all others should be
-  // unhighlighted.
-  auto active_file_index = getPathListCtrlIndex(*active_file_);
-  for (long i = 0; i < lc_files_in_directory_->GetItemCount(); ++i) {
-    if (active_file_index.has_value() && i == *active_file_index) {
-      lc_files_in_directory_->SetItemState(i, wxLIST_STATE_SELECTED | wxLIST_STATE_FOCUSED,
-        wxLIST_STATE_SELECTED | wxLIST_STATE_FOCUSED);
-    }
-    else {
-      lc_files_in_directory_->SetItemState(i, 0, wxLIST_STATE_SELECTED | wxLIST_STATE_FOCUSED);
+  // Handle highlighting: Only the active file should be highlighted.
+  if (active_file_.has_value()) {
+    const auto active_file_index = getPathListCtrlIndex(*active_file_);
+    if (active_file_index.has_value()) {
+      lc_files_in_directory_->SetItemState(*active_file_index,
+        wxLIST_STATE_SELECTED | wxLIST_STATE_FOCUSED, wxLIST_STATE_SELECTED | wxLIST_STATE_FOCUSED);
     }
   }
 
-  // Without a refresh, old text can linger visually even though we've updated the data the control
-  // displays.
-  lc_files_in_directory_->Refresh();
   lc_files_in_directory_->Thaw();
-
   file_view_modification_in_progress_ = false;
 }
 
@@ -787,6 +726,8 @@ void MainFrame::markClean()
 
 void MainFrame::newProject() {
   tag_map_ = ragtag::TagMap();
+  navigation_index_.invalidate();
+  quick_open_key_.reset();
   project_path_.reset();
   markDirty();
 }
@@ -937,6 +878,8 @@ bool MainFrame::openProject(const ragtag::path_t& path)
 
   // Opened successfully!
   tag_map_ = *tag_map_pending;
+  navigation_index_.invalidate();
+  quick_open_key_.reset();
   project_path_ = path;
   resetActiveFile();
   markClean();
@@ -1017,8 +960,7 @@ bool MainFrame::loadNextFile()
     return false;
   }
 
-  const auto next_file = qualifiedFileNavigator(
-    *active_file_, [](const ragtag::path_t&) {return true; }, true);
+  const auto next_file = findNeighboringFile(*active_file_, false, true);
   if (!next_file.has_value()) {
     SetStatusText("Couldn't find next file.");
     return false;
@@ -1035,8 +977,7 @@ bool MainFrame::loadPreviousFile()
     return false;
   }
 
-  const auto previous_file = qualifiedFileNavigator(
-    *active_file_, [](const ragtag::path_t&) {return true; }, false);
+  const auto previous_file = findNeighboringFile(*active_file_, false, false);
   if (!previous_file.has_value()) {
     SetStatusText("Couldn't find previous file.");
     return false;
@@ -1053,11 +994,7 @@ bool MainFrame::loadNextUntaggedFile()
     return false;
   }
 
-  const auto next_untagged_file = qualifiedFileNavigator(*active_file_,
-    [this](const ragtag::path_t& path) {
-      const auto tag_coverage = tag_map_.getFileTagCoverage(path);
-      return tag_coverage != ragtag::TagCoverage::ALL;
-    }, true);
+  const auto next_untagged_file = findNeighboringFile(*active_file_, true, true);
   if (!next_untagged_file.has_value()) {
     SetStatusText("Couldn't find next untagged file.");
     return false;
@@ -1074,11 +1011,7 @@ bool MainFrame::loadPreviousUntaggedFile()
     return false;
   }
 
-  const auto previous_untagged = qualifiedFileNavigator(*active_file_,
-    [this](const ragtag::path_t& path) {
-      const auto tag_coverage = tag_map_.getFileTagCoverage(path);
-      return tag_coverage != ragtag::TagCoverage::ALL;
-    }, false);
+  const auto previous_untagged = findNeighboringFile(*active_file_, true, false);
   if (!previous_untagged.has_value()) {
     SetStatusText("Couldn't find previous untagged file.");
     return false;
@@ -1087,6 +1020,34 @@ bool MainFrame::loadPreviousUntaggedFile()
   return loadFileAndSetAsActive(*previous_untagged);
 }
 
+bool MainFrame::loadNextUntaggedProjectFile()
+{
+  // With no active file, the empty reference isn't part of the project, so the search starts
+  // from the lowest file ID.
+  const auto next_untagged_file = findUntaggedProjectFile(active_file_.value_or(ragtag::path_t{}),
+    true);
+  if (!next_untagged_file.has_value()) {
+    SetStatusText("Couldn't find next untagged file in project.");
+    return false;
+  }
+
+  return loadFileAndSetAsActive(*next_untagged_file);
+}
+
+bool MainFrame::loadPreviousUntaggedProjectFile()
+{
+  // With no active file, the empty reference isn't part of the project, so the search starts
+  // from the highest file ID.
+  const auto previous_untagged = findUntaggedProjectFile(active_file_.value_or(ragtag::path_t{}),
+    false);
+  if (!previous_untagged.has_value()) {
+    SetStatusText("Couldn't find previous untagged file in project.");
+    return false;
+  }
+
+  return loadFileAndSetAsActive(*previous_untagged);
+}
+
 void MainFrame::enterCommandMode()
 {
   SetFocus();
@@ -1102,68 +1063,49 @@ void MainFrame::exitCommandMode()
   refreshStatusBar();
 }
 
-std::optional<ragtag::path_t> MainFrame::qualifiedFileNavigator(
-  const ragtag::path_t& reference, const MainFrame::file_qualifier_t& qualifier, bool find_next)
+std::optional<ragtag::path_t> MainFrame::findNeighboringFile(const ragtag::path_t& reference,
+  bool untagged_only, bool find_next)
 {
   if (!reference.has_parent_path()) {
     return {};
   }
 
-  auto isQualified = [&qualifier](const ragtag::path_t& file_it) {
-    return std::filesystem::is_regular_file(file_it) && qualifier(file_it);
-    };
-
-  // Strategy is to construct a vector of paths to regular, qualified files within this directory,
-  // find the entry that matches our reference file, then return the neighboring entry.
-  //
-  // This approach is a little cheesy, but IMO it's easier to follow than maintaining multiple
-  // directory iterators that all need to be conditioned to seek only qualified files.
-  std::vector<ragtag::path_t> qualified_or_self;
-  for (std::filesystem::directory_iterator dir_it(reference.parent_path());
-    dir_it != std::filesystem::directory_iterator(); ++dir_it) {
-    // If it's qualified, add it to our vector. Also include our reference file regardless of its
-    // qualifications such that we can obtain a reference index afterward.
-    if (isQualified(dir_it->path()) || dir_it->path() == reference) {
-      qualified_or_self.push_back(dir_it->path());
-    }
-  }
-
-  if (qualified_or_self.empty()) {
-    // Somehow, we have no files. (We didn't even encounter our reference file.)
+  const auto snapshot = directory_cache_.getSnapshot(reference.parent_path());
+  if (!snapshot.has_value()) {
     return {};
   }
 
-  if (qualified_or_self.size() == 1) {
-    // We only have our reference file, meaning no other files in the directory are qualified.
-    return isQualified(reference) ? reference : std::optional<ragtag::path_t>();
+  if (!navigation_index_.isCurrent(*snapshot)) {
+    navigation_index_.rebuild(*snapshot, tag_map_);
   }
+  return navigation_index_.findNeighbor(reference, untagged_only, find_next);
+}
 
-  for (int i = 0; i < qualified_or_self.size(); ++i) {
-    if (qualified_or_self[i] == reference) {
-      const size_t seek_index = find_next ? (i + 1) % qualified_or_self.size()
-        : (i + qualified_or_self.size() - 1) % qualified_or_self.size();
-      return qualified_or_self[seek_index];
+std::optional<ragtag::path_t> MainFrame::findUntaggedProjectFile(const ragtag::path_t& reference,
+  bool find_next) const
+{
+  // Each step is a bit scan from the candidate's file ID. Missing files are skipped, but we give up
+  // after visiting every queued file once so that a project full of missing files can't loop
+  // forever.
+  ragtag::path_t candidate = reference;
+  for (int i = 0; i < tag_map_.numUntaggedFiles(); ++i) {
+    const auto found = tag_map_.findUntaggedFile(candidate, find_next);
+    if (!found.has_value() || *found == reference) {
+      return {};
     }
+    std::error_code error_code;
+    if (std::filesystem::exists(*found, error_code)) {
+      return found;
+    }
+    candidate = *found;
   }
-
-  // We didn't encounter our reference file. This shouldn't happen, since we added our reference
-  // file to the `qualified_or_self` vector earlier.
-  //
-  // TODO: Report error.
   return {};
 }
 
 std::optional<long> MainFrame::getPathListCtrlIndex(const ragtag::path_t& path) const
 {
-  for (long i = 0; i < lc_files_in_directory_->GetItemCount(); ++i) {
-    // User data is a pointer to the path corresponding to the list control entry.
-    const wxUIntPtr user_data = lc_files_in_directory_->GetItemData(i);
-    if (path == *reinterpret_cast<ragtag::path_t*>(user_data)) {
-      return i;
-    }
-  }
-
-  return {};
+  // Rows of the list control are rows of the directory model.
+  return directory_model_.findIndex(path);
 }
 
 void MainFrame::OnNewProject(wxCommandEvent& event) {
@@ -1248,6 +1190,27 @@ void MainFrame::OnLoadFile(wxCommandEvent& event)
   loadFileAndSetAsActive(*path_pending);
 }
 
+void MainFrame::OnGoToFile(wxCommandEvent& event)
+{
+  // Folding half a million paths takes a moment, so the finder is only rebuilt once files have
+  // come or gone.
+  const std::pair<ragtag::file_id_t, int> key{ tag_map_.fileIdLimit(), tag_map_.numFiles() };
+  if (quick_open_key_ != key) {
+    quick_open_paths_ = tag_map_.getAllFiles();
+    quick_open_finder_.build(quick_open_paths_);
+    quick_open_key_ = key;
+  }
+
+  QuickOpenDialog dialog(this, quick_open_finder_, quick_open_paths_);
+  const auto path_pending = dialog.promptQuickOpen();
+  if (!path_pending.has_value()) {
+    // User canceled dialog.
+    return;
+  }
+
+  loadFileAndSetAsActive(*path_pending);
+}
+
 void MainFrame::OnNextFile(wxCommandEvent& event)
 {
   // TODO: Returns a bool we can use; however, function itself already modifies status bar.
@@ -1272,6 +1235,18 @@ void MainFrame::OnPreviousUntaggedFile(wxCommandEvent& event)
   loadPreviousUntaggedFile();
 }
 
+void MainFrame::OnNextUntaggedProjectFile(wxCommandEvent& event)
+{
+  // TODO: Returns a bool we can use; however, function itself already modifies status bar.
+  loadNextUntaggedProjectFile();
+}
+
+void MainFrame::OnPreviousUntaggedProjectFile(wxCommandEvent& event)
+{
+  // TODO: Returns a bool we can use; however, function itself already modifies status bar.
+  loadPreviousUntaggedProjectFile();
+}
+
 void MainFrame::OnPlayPauseMedia(wxCommandEvent& event)
 {
   const wxMediaState media_state = mc_media_display_->GetState();
@@ -1351,6 +1326,9 @@ void MainFrame::OnDefineNewTag(wxCommandEvent& event) {
     }
   }
 
+  // A new tag leaves every file that doesn't commit it only partly tagged.
+  navigation_index_.invalidate();
+
   // Looks like everything was successful. Refresh the panel to show our new tag.
   markDirty();
   refreshTagToggles();
@@ -1417,6 +1395,8 @@ void MainFrame::OnShowSummary(wxCommandEvent& event)
 
 void MainFrame::OnRefreshDirectoryView(wxCommandEvent& event)
 {
+  // The user has asked for the directory's true contents, so don't rely on the watcher.
+  directory_cache_.invalidate();
   refreshDirectoryView();
 }
 
@@ -1474,6 +1454,7 @@ void MainFrame::OnClickTagToggleButton(TagToggleEvent& event) {
       }
     }
 
+    navigation_index_.invalidate();
     SetStatusText(L"Modified tag '" + old_tag + L"'/'" + new_tag + L"'.");
     break;
   }
@@ -1483,6 +1464,8 @@ void MainFrame::OnClickTagToggleButton(TagToggleEvent& event) {
       markDirty();
 
       if (tag_map_.deleteTag(event.getTag())) {
+        // Deleting a tag can complete the coverage of any file.
+        navigation_index_.invalidate();
         SetStatusText(L"Deleted tag '" + event.getTag() + L"'.");
       }
       else {
@@ -1569,12 +1552,8 @@ void MainFrame::OnFocusFile(wxListEvent& event)
   }
 
   // Load and display the file.
-  // 
-  // Gross, but the best I could come up with given wxListCtrl's limitations.
-  // Goal is to reinterpret the user data as a pointer leading to the path name that was set for
-  // this item in refreshDirectoryView().
-  const wxUIntPtr user_data = lc_files_in_directory_->GetItemData(event.GetIndex());
-  if (!loadFileAndSetAsActive(*reinterpret_cast<ragtag::path_t*>(user_data))) {
+  const auto path = directory_model_.getPathAt(event.GetIndex());
+  if (!path.has_value() || !loadFileAndSetAsActive(*path)) {
     // TODO: Log error.
   }
 }
@@ -1679,6 +1658,9 @@ void MainFrame::OnSummaryFrameAction(SummaryFrameEvent& event)
       }
     }
 
+    // Files removed from the project lose their tags.
+    navigation_index_.invalidate();
+
     // Note that some of these already get invoked in the case that we resetActiveFile(). We can
     // optimize these redundant calls out later if we really want to.
     refreshRatingButtons();
@@ -1713,6 +1695,10 @@ void MainFrame::OnSummaryFrameAction(SummaryFrameEvent& event)
       }
     }
 
+    // Files removed from the project lose their tags.
+    navigation_index_.invalidate();
+    f_summary_->invalidateFileStatuses();
+
     // Note that some of these already get invoked in the case that we resetActiveFile(). We can
     // optimize these redundant calls out later if we really want to.
     refreshRatingButtons();
@@ -1743,12 +1729,12 @@ void MainFrame::OnKeyDown(wxKeyEvent& event)
     if (active_file_.has_value() && promptConfirmFileDeletion(*active_file_)) {
       ragtag::path_t path_cache = *active_file_;  // Copy for use in error dialog.
       // Cache next file name so that we can switch to it if deletion is successful.
-      const auto next_file = qualifiedFileNavigator(
-        *active_file_, [](const ragtag::path_t&) {return true; }, true);
+      const auto next_file = findNeighboringFile(*active_file_, false, true);
       if (!RagTagUtil::deleteFile(path_cache)) {
         // TODO: Report error.
         SetStatusText(L"Could not delete file '" + path_cache.wstring() + L"'.");
       }
+      f_summary_->invalidateFileStatuses();
 
       // Remove the file from our project also.
       const bool did_remove_file_from_tag_map = tag_map_.removeFile(path_cache);
@@ -1779,6 +1765,13 @@ void MainFrame::OnKeyDown(wxKeyEvent& event)
     else if (modifiers == wxMOD_SHIFT) {
       loadPreviousUntaggedFile();
     }
+    else if (modifiers == wxMOD_CONTROL) {
+      // Ctrl walks the project-wide queue, crossing into other directories as needed.
+      loadNextUntaggedProjectFile();
+    }
+    else if (modifiers == (wxMOD_CONTROL | wxMOD_SHIFT)) {
+      loadPreviousUntaggedProjectFile();
+    }
   }
   else if (command_mode_active_ && (key_code == WXK_DOWN || key_code == WXK_RIGHT)) {
     if (modifiers == wxMOD_NONE) {
@@ -16,11 +16,18 @@
 #ifndef INCLUDE_MAIN_FRAME_H
 #define INCLUDE_MAIN_FRAME_H
 
+#include "directory_list_ctrl.h"
+#include "directory_model.h"
+#include "directory_snapshot_cache.h"
+#include "fuzzy_finder.h"
+#include "navigation_index.h"
 #include "summary_frame.h"
 #include "tag_map.h"
 #include "tag_toggle_panel.h"
 #include <filesystem>
 #include <optional>
+#include <utility>
+#include <vector>
 #include <wx/checkbox.h>
 #include <wx/colour.h>
 #include <wx/event.h>
@@ -43,9 +50,6 @@ public:
   MainFrame();
 
 private:
-  //! Type of function that enforces criteria for including a file path within grouping contexts.
-  typedef std::function<bool(const ragtag::path_t&)> file_qualifier_t;
-
   //! Enumeration of IDs used to differentiate various in-window controls for the purposes of
   //! assigning functions to them.
   // Implementation note: IDs of 0 and 1 are not allowed per wxWidgets documentation:
@@ -57,6 +61,7 @@ private:
     ID_SAVE_PROJECT,
     ID_SAVE_PROJECT_AS,
     ID_LOAD_FILE,
+    ID_GO_TO_FILE,
     ID_ENTER_COMMAND_MODE,
     ID_FOCUS_DIRECTORY_VIEW,
     ID_FOCUS_TAGS,
@@ -65,6 +70,8 @@ private:
     ID_PREVIOUS_FILE,
     ID_NEXT_UNTAGGED_FILE,
     ID_PREVIOUS_UNTAGGED_FILE,
+    ID_NEXT_UNTAGGED_PROJECT_FILE,
+    ID_PREVIOUS_UNTAGGED_PROJECT_FILE,
     ID_SHOW_SUMMARY,
     ID_CLEAR_TAGS_FROM_FILE,
     ID_SET_TAGS_TO_DEFAULTS,
@@ -88,24 +95,6 @@ private:
     CANCEL,
   };
 
-  //! Columns displayed within the directory viewer.
-  enum DirectoryViewColumn {
-    COLUMN_FILENAME,
-    COLUMN_TAG_COVERAGE,
-    COLUMN_RATING
-  };
-
-  //! Color used for the background of list items for files that have been fully tagged.
-  static const wxColour BACKGROUND_COLOR_FULLY_TAGGED;
-
-  //! Color used for the background of list items for files that have been partly tagged (files that
-  //! have some tag coverage).
-  static const wxColour BACKGROUND_COLOR_PARTLY_TAGGED;
-
-  //! Color used for the background of list items for files that are untagged (files that have no
-  //! tag coverage).
-  static const wxColour BACKGROUND_COLOR_FULLY_UNTAGGED;
-
   //! Starting position for the vertical divider as a proportion of the window width.
   static const double LEFT_PANE_STARTING_PROPORTION;
 
@@ -356,23 +345,58 @@ private:
   //! and set as the active file.
   bool loadPreviousUntaggedFile();
 
+  //! Attempts to load the nearest untagged file following the currently loaded file anywhere in
+  //! the project, then display it and set it as the new active file.
+  //! 
+  //! Unlike loadNextUntaggedFile(), this crosses directories, visiting project files in file ID
+  //! order: files present when the project was loaded come in path order, and files added since
+  //! come last. Files that no longer exist on disk are skipped. If there is no active file (or it
+  //! isn't part of the project), the first untagged file in the project is loaded.
+  //! 
+  //! @returns True if the next untagged project file can be determined and that file is
+  //! successfully loaded and set as the active file.
+  bool loadNextUntaggedProjectFile();
+
+  //! Attempts to load the nearest untagged file preceding the currently loaded file anywhere in
+  //! the project, then display it and set it as the new active file.
+  //! 
+  //! Unlike loadPreviousUntaggedFile(), this crosses directories, visiting project files in file
+  //! ID order: files present when the project was loaded come in path order, and files added since
+  //! come last. Files that no longer exist on disk are skipped. If there is no active file (or it
+  //! isn't part of the project), the last untagged file in the project is loaded.
+  //! 
+  //! @returns True if the previous untagged project file can be determined and that file is
+  //! successfully loaded and set as the active file.
+  bool loadPreviousUntaggedProjectFile();
+
   //! Enters Command Mode, enabling keyboard shortcuts without modifiers.
   void enterCommandMode();
 
   //! Leaves Command Mode, disabling keyboard shortcuts without modifiers.
   void exitCommandMode();
 
-  //! Identifies the nearest file in the directory that meets specified criteria.
+  //! Identifies the nearest file in the directory, or the nearest untagged file, in O(log n) time.
   //! 
-  //! Ordering is based on default directory iterator ordering.
+  //! Ordering matches the directory view. The directory's contents are read from the directory
+  //! snapshot cache, and the navigation index is rebuilt only if the snapshot has changed or the
+  //! index has been invalidated.
   //! 
   //! @param reference The file to look forward or backward from.
-  //! @param qualifier The criteria to match.
+  //! @param untagged_only True to consider only files whose tag coverage is incomplete.
   //! @param find_next If true, look forward; if false, look backward.
   //! @returns A path to a file satisfying the criteria or an empty optional if no such file can be
   //! found.
-  static std::optional<ragtag::path_t> qualifiedFileNavigator(
-    const ragtag::path_t& reference, const file_qualifier_t& qualifier, bool find_next);
+  std::optional<ragtag::path_t> findNeighboringFile(const ragtag::path_t& reference,
+    bool untagged_only, bool find_next);
+
+  //! Identifies the nearest untagged file in the project that still exists on disk.
+  //! 
+  //! @param reference The file to look forward or backward from.
+  //! @param find_next If true, look forward; if false, look backward.
+  //! @returns A path to an untagged project file other than the reference file, or an empty
+  //! optional if no such file exists.
+  std::optional<ragtag::path_t> findUntaggedProjectFile(const ragtag::path_t& reference,
+    bool find_next) const;
 
   //! Retrieves the index of the item representing a path within the directory view list control.
   //! 
@@ -435,6 +459,14 @@ private:
   //! @param event The wxCommandEvent of type wxEVT_MENU describing the user's action.
   void OnLoadFile(wxCommandEvent& event);
 
+  //! Invoked when Go to File is selected from the menu or activated using its accelerator.
+  //! 
+  //! Presents a palette in which the user types part of the path of any project file and chooses
+  //! from the best fuzzy matches. The chosen file is then loaded as the active file.
+  //! 
+  //! @param event The wxCommandEvent of type wxEVT_MENU describing the user's action.
+  void OnGoToFile(wxCommandEvent& event);
+
   //! Invoked when Next File is selected from the menu or activated using its accelerator.
   //! 
   //! Proceeds to the file following the current one within the current directory. This file is then
@@ -475,6 +507,22 @@ private:
   //! @param event The wxCommandEvent of type wxEVT_MENU describing the user's action.
   void OnPreviousUntaggedFile(wxCommandEvent& event);
 
+  //! Invoked when Next Untagged File in Project is selected from the menu.
+  //! 
+  //! Proceeds to the next file in the project, in any directory, that is not fully tagged. (See
+  //! loadNextUntaggedProjectFile().)
+  //! 
+  //! @param event The wxCommandEvent of type wxEVT_MENU describing the user's action.
+  void OnNextUntaggedProjectFile(wxCommandEvent& event);
+
+  //! Invoked when Previous Untagged File in Project is selected from the menu.
+  //! 
+  //! Navigates to the nearest preceding file in the project, in any directory, that is not fully
+  //! tagged. (See loadPreviousUntaggedProjectFile().)
+  //! 
+  //! @param event The wxCommandEvent of type wxEVT_MENU describing the user's action.
+  void OnPreviousUntaggedProjectFile(wxCommandEvent& event);
+
   //! Invoked when Play/Pause Media is selected from the menu, activated using its accelerator, or
   //! activated using the Play/Pause button.
   //! 
@@ -558,9 +606,9 @@ private:
   //! Invoked when Refresh Directory View is selected from the menu or activated using its
   //! accelerator.
   //! 
-  //! Traverses the active directory and updates the directory view with any changes that have been
-  //! made. (Perhaps the user added files to the directory and would like to see them reflected in
-  //! the app's file listing.)
+  //! Traverses the active directory anew and updates the directory view with any changes that have
+  //! been made. (Perhaps the directory is on a share whose changes can't be watched, and the user
+  //! added files to it that they would like to see reflected in the app's file listing.)
   //! 
   //! @param event The wxCommandEvent of type wxEVT_MENU describing the user's action.
   void OnRefreshDirectoryView(wxCommandEvent& event);
@@ -694,9 +742,9 @@ private:
   //! Processes keyboard input independent from menu accelerators.
   //! 
   //! When entered in Command Mode, such keystrokes can be used to assign a rating, adjust tags, or
-  //! navigate files within the directory. Regardless of the state of Command Mode, files can be
-  //! deleted (with Delete, pending a prompt) and the main window can be closed (with Ctrl+W,
-  //! pending final prompts to save the project if appropriate).
+  //! navigate files within the directory or across the project. Regardless of the state of Command
+  //! Mode, files can be deleted (with Delete, pending a prompt) and the main window can be closed
+  //! (with Ctrl+W, pending final prompts to save the project if appropriate).
   //! 
   //! A full description of this function is best left to a user manual.
   //! 
@@ -744,7 +792,7 @@ private:
   //! Text displaying the directory of the active file.
   wxStaticText* st_current_directory_{ nullptr };
   //! List control displaying the files in the directory of the active file.
-  wxListCtrl* lc_files_in_directory_{ nullptr };
+  DirectoryListCtrl* lc_files_in_directory_{ nullptr };
   //! Button that refreshes the control displaying the files in the directory of the active file.
   wxButton* b_refresh_file_view_{ nullptr };
   //! Button to change the active file to the previous untagged file within the directory.
@@ -755,11 +803,19 @@ private:
   SummaryFrame* f_summary_{ nullptr };
 
   // ADDITIONAL DATA MEMBERS =======================================================================
-  //! Array of full paths to files presented by lc_files_in_directory_.
-  // Implementation note: Maintaining a parallel array like this isn't ideal, but it's perhaps the
-  // least bad way of caching data that items in the list control can refer to by generic pointer as
-  // required by the wxListCtrl interface.
-  std::vector<ragtag::path_t> file_paths_{};
+  //! Listing of the files presented by lc_files_in_directory_.
+  ragtag::DirectoryModel directory_model_{};
+  //! Cached listings of the active file's directory, kept current by a filesystem watcher.
+  ragtag::DirectorySnapshotCache directory_cache_{};
+  //! Index of the untagged files within the active file's directory, used for navigation.
+  ragtag::NavigationIndex navigation_index_{};
+  //! Paths of all project files as of the last time the Go to File palette was opened.
+  std::vector<ragtag::path_t> quick_open_paths_{};
+  //! Finder over `quick_open_paths_`, kept between uses of the Go to File palette.
+  ragtag::FuzzyFinder quick_open_finder_{};
+  //! File ID limit and file count of the tag map when `quick_open_finder_` was built, or an empty
+  //! optional if it must be rebuilt. Adding or removing a file changes one or the other.
+  std::optional<std::pair<ragtag::file_id_t, int>> quick_open_key_{};
   //! The tag map defining the active project.
   ragtag::TagMap tag_map_{};
   //! The file path of the current project.
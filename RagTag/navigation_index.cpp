@@ -0,0 +1,105 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "navigation_index.h"
+#include <algorithm>
+
+namespace ragtag {
+  void NavigationIndex::rebuild(DirectorySnapshotCache::snapshot_t snapshot,
+    const TagMap& tag_map) {
+    files_ = snapshot != nullptr ? std::move(snapshot)
+      : std::make_shared<const std::vector<path_t>>();
+    untagged_.clear();
+    for (long i = 0; i < static_cast<long>(files_->size()); ++i) {
+      if (isUntagged((*files_)[i], tag_map)) {
+        // Positions arrive in increasing order, so hinting at the end makes each insertion O(1).
+        untagged_.insert(untagged_.end(), i);
+      }
+    }
+    is_stale_ = false;
+  }
+
+  void NavigationIndex::updateFile(const path_t& path, const TagMap& tag_map) {
+    if (is_stale_) {
+      return;
+    }
+
+    const auto it = std::lower_bound(files_->begin(), files_->end(), path);
+    if (it == files_->end() || *it != path) {
+      return;
+    }
+
+    const long position = static_cast<long>(it - files_->begin());
+    if (isUntagged(path, tag_map)) {
+      untagged_.insert(position);
+    }
+    else {
+      untagged_.erase(position);
+    }
+  }
+
+  void NavigationIndex::invalidate() {
+    is_stale_ = true;
+  }
+
+  bool NavigationIndex::isCurrent(const DirectorySnapshotCache::snapshot_t& snapshot) const {
+    return !is_stale_ && files_ == snapshot;
+  }
+
+  std::optional<path_t> NavigationIndex::findNeighbor(const path_t& reference,
+    const bool untagged_only, const bool find_next) const {
+    const auto& files = *files_;  // Alias for convenience
+    const auto it = std::lower_bound(files.begin(), files.end(), reference);
+    const long position = static_cast<long>(it - files.begin());
+    const bool is_reference_listed = it != files.end() && *it == reference;
+
+    if (!untagged_only) {
+      const long num_files = static_cast<long>(files.size());
+      if (num_files == 0) {
+        return {};
+      }
+      if (find_next) {
+        // An unlisted reference sits just before the file at its insertion point.
+        return files[(is_reference_listed ? position + 1 : position) % num_files];
+      }
+      return files[(position + num_files - 1) % num_files];
+    }
+
+    if (untagged_.empty()) {
+      return {};
+    }
+    if (find_next) {
+      auto next_it = is_reference_listed ? untagged_.upper_bound(position)
+        : untagged_.lower_bound(position);
+      if (next_it == untagged_.end()) {
+        next_it = untagged_.begin();
+      }
+      return files[*next_it];
+    }
+    auto previous_it = untagged_.lower_bound(position);
+    if (previous_it == untagged_.begin()) {
+      previous_it = untagged_.end();
+    }
+    return files[*std::prev(previous_it)];
+  }
+
+  long NavigationIndex::numUntagged() const {
+    return static_cast<long>(untagged_.size());
+  }
+
+  bool NavigationIndex::isUntagged(const path_t& path, const TagMap& tag_map) {
+    return tag_map.getFileTagCoverage(path) != TagCoverage::ALL;
+  }
+}  // namespace ragtag
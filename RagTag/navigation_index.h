@@ -0,0 +1,100 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#ifndef INCLUDE_NAVIGATION_INDEX_H
+#define INCLUDE_NAVIGATION_INDEX_H
+
+#include "directory_snapshot_cache.h"
+#include "tag_map.h"
+#include <optional>
+#include <set>
+
+namespace ragtag {
+  //! Index answering "next file" and "next untagged file" queries within a directory snapshot in
+  //! O(log n) time.
+  //! 
+  //! The index pairs the snapshot's sorted array of files with an ordered set of the positions of
+  //! untagged files (those whose tag coverage is anything other than TagCoverage::ALL). Positions
+  //! are found by binary search, and neighbors by walking one step through either structure, with
+  //! wrap-around at the ends.
+  //! 
+  //! The set must be kept in step with the TagMap it was built from: call updateFile() after
+  //! changing the tags of a single file, and invalidate() after changes that could affect many files
+  //! (such as defining or deleting a tag, or loading a different project).
+  class NavigationIndex {
+  public:
+    //! Rebuilds the index from scratch in O(n log n) time.
+    //! 
+    //! @param snapshot The sorted files of the directory to index. Null is treated as an empty
+    //!     directory.
+    //! @param tag_map The tag map determining which files are untagged.
+    void rebuild(DirectorySnapshotCache::snapshot_t snapshot, const TagMap& tag_map);
+
+    //! Re-evaluates whether a single file is untagged in O(log n) time.
+    //! 
+    //! Has no effect if the file isn't part of the indexed snapshot or if the index is stale.
+    //! 
+    //! @param path The file whose tags have changed.
+    //! @param tag_map The tag map determining whether the file is untagged.
+    void updateFile(const path_t& path, const TagMap& tag_map);
+
+    //! Marks the index as stale so that it will be rebuilt before being trusted again.
+    void invalidate();
+
+    //! Checks whether the index is up to date with a given snapshot.
+    //! 
+    //! @param snapshot The current snapshot of the directory.
+    //! @returns True if the index was built from this snapshot and hasn't been invalidated since.
+    bool isCurrent(const DirectorySnapshotCache::snapshot_t& snapshot) const;
+
+    //! Finds the nearest file forward or backward from a reference file, wrapping around the ends
+    //! of the directory.
+    //! 
+    //! The reference file needn't be part of the snapshot (it might have been deleted, say); in that
+    //! case, the search begins from the position the reference file would occupy.
+    //! 
+    //! @param reference The file to look forward or backward from.
+    //! @param untagged_only True to consider only untagged files; false to consider all files.
+    //! @param find_next If true, look forward; if false, look backward.
+    //! @returns The neighboring file, the reference file itself if it's the only file that
+    //!     qualifies, or an empty optional if no file qualifies.
+    std::optional<path_t> findNeighbor(const path_t& reference, bool untagged_only,
+      bool find_next) const;
+
+    //! Obtains the count of untagged files in the indexed snapshot.
+    //! 
+    //! @returns The number of untagged files.
+    long numUntagged() const;
+
+  private:
+    //! Determines whether a file counts as untagged for the purposes of navigation.
+    //! 
+    //! @param path The file to check.
+    //! @param tag_map The tag map describing the file.
+    //! @returns True if the file's tag coverage is anything other than TagCoverage::ALL.
+    static bool isUntagged(const path_t& path, const TagMap& tag_map);
+
+    //! The indexed files, sorted. Never null.
+    DirectorySnapshotCache::snapshot_t files_{ std::make_shared<const std::vector<path_t>>() };
+
+    //! Positions within `files_` of all untagged files.
+    std::set<long> untagged_{};
+
+    //! Whether the index must be rebuilt before use.
+    bool is_stale_{ true };
+  };
+}  // namespace ragtag
+
+#endif  // INCLUDE_NAVIGATION_INDEX_H
@@ -0,0 +1,123 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "path_trigram_index.h"
+#include <algorithm>
+#include <cwctype>
+#include <iterator>
+
+namespace ragtag {
+  const size_t PathTrigramIndex::GRAM_LENGTH = 3;
+
+  void PathTrigramIndex::add(const int id, const std::wstring& text) {
+    for (const gram_t gram : gramsOf(text)) {
+      auto& ids = postings_[gram];  // Alias for convenience
+      // IDs usually arrive in increasing order, in which case appending keeps the list sorted.
+      if (ids.empty() || ids.back() < id) {
+        ids.push_back(id);
+      }
+      else {
+        const auto it = std::lower_bound(ids.begin(), ids.end(), id);
+        if (it == ids.end() || *it != id) {
+          ids.insert(it, id);
+        }
+      }
+    }
+  }
+
+  void PathTrigramIndex::remove(const int id, const std::wstring& text) {
+    for (const gram_t gram : gramsOf(text)) {
+      const auto postings_it = postings_.find(gram);
+      if (postings_it == postings_.end()) {
+        continue;
+      }
+      auto& ids = postings_it->second;  // Alias for convenience
+      const auto it = std::lower_bound(ids.begin(), ids.end(), id);
+      if (it != ids.end() && *it == id) {
+        ids.erase(it);
+      }
+      if (ids.empty()) {
+        postings_.erase(postings_it);
+      }
+    }
+  }
+
+  void PathTrigramIndex::clear() {
+    postings_.clear();
+  }
+
+  std::optional<std::vector<int>> PathTrigramIndex::findCandidates(
+    const std::wstring& needle) const {
+    const auto grams = gramsOf(needle);
+    if (grams.empty()) {
+      return {};
+    }
+
+    std::vector<const std::vector<int>*> lists;
+    lists.reserve(grams.size());
+    for (const gram_t gram : grams) {
+      const auto postings_it = postings_.find(gram);
+      if (postings_it == postings_.end()) {
+        // No string contains this trigram, so no string can contain the needle.
+        return std::vector<int>{};
+      }
+      lists.push_back(&postings_it->second);
+    }
+
+    // Starting from the shortest list keeps every intermediate result as small as possible.
+    std::sort(lists.begin(), lists.end(),
+      [](const std::vector<int>* lhs, const std::vector<int>* rhs) {
+        return lhs->size() < rhs->size();
+      });
+    std::vector<int> candidates = *lists.front();
+    std::vector<int> intersection;
+    for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+      intersection.clear();
+      std::set_intersection(candidates.begin(), candidates.end(), lists[i]->begin(),
+        lists[i]->end(), std::back_inserter(intersection));
+      candidates.swap(intersection);
+    }
+    return candidates;
+  }
+
+  std::wstring PathTrigramIndex::foldCase(const std::wstring& text) {
+    std::wstring folded(text.size(), L'\0');
+    std::transform(text.begin(), text.end(), folded.begin(),
+      [](const wchar_t c) { return static_cast<wchar_t>(std::towlower(c)); });
+    return folded;
+  }
+
+  std::vector<PathTrigramIndex::gram_t> PathTrigramIndex::gramsOf(const std::wstring& text) {
+    // 21 bits hold any Unicode code point, and three of them fit in one 64-bit gram.
+    static const gram_t CHAR_MASK = (gram_t{ 1 } << 21) - 1;
+
+    std::vector<gram_t> grams;
+    if (text.size() < GRAM_LENGTH) {
+      return grams;
+    }
+    const std::wstring folded = foldCase(text);
+    grams.reserve(folded.size() - GRAM_LENGTH + 1);
+    for (size_t i = 0; i + GRAM_LENGTH <= folded.size(); ++i) {
+      gram_t gram = 0;
+      for (size_t j = 0; j < GRAM_LENGTH; ++j) {
+        gram = (gram << 21) | (static_cast<gram_t>(folded[i + j]) & CHAR_MASK);
+      }
+      grams.push_back(gram);
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+  }
+}  // namespace ragtag
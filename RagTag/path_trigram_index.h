@@ -0,0 +1,86 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#ifndef INCLUDE_PATH_TRIGRAM_INDEX_H
+#define INCLUDE_PATH_TRIGRAM_INDEX_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ragtag {
+  //! Index of the three-character sequences (trigrams) within a collection of strings, used to
+  //! narrow case-insensitive substring searches to the strings that could possibly match.
+  //! 
+  //! Every substring of three or more characters contains all of its own trigrams, so only strings
+  //! containing every trigram of a query can contain the query. Each trigram maps to a sorted list
+  //! of the IDs of the strings containing it, and a query intersects the lists of its trigrams,
+  //! shortest first. The result is a superset of the matches that callers confirm by comparing
+  //! text, which is typically a small fraction of the collection.
+  //! 
+  //! Strings are identified by nonnegative integer IDs chosen by the caller. The index is cheapest
+  //! to maintain when IDs are added in increasing order.
+  class PathTrigramIndex {
+  public:
+    //! Adds a string to the index.
+    //! 
+    //! @param id The ID of the string. Must not already be in the index.
+    //! @param text The string.
+    void add(int id, const std::wstring& text);
+
+    //! Removes a string from the index.
+    //! 
+    //! @param id The ID of the string.
+    //! @param text The string, exactly as it was added.
+    void remove(int id, const std::wstring& text);
+
+    //! Removes every string from the index.
+    void clear();
+
+    //! Finds the strings that might contain a substring, ignoring case.
+    //! 
+    //! @param needle The substring to search for.
+    //! @returns The IDs of all strings containing every trigram of the substring in ascending
+    //!     order, or an empty optional if the substring is too short to have trigrams, in which
+    //!     case every string is a candidate.
+    std::optional<std::vector<int>> findCandidates(const std::wstring& needle) const;
+
+    //! Converts a string to the case used for comparisons.
+    //! 
+    //! @param text The string to convert.
+    //! @returns The string in lowercase.
+    static std::wstring foldCase(const std::wstring& text);
+
+    //! Number of characters in each indexed sequence.
+    static const size_t GRAM_LENGTH;
+
+  private:
+    //! Type identifying one trigram, packing its three characters together.
+    typedef std::uint64_t gram_t;
+
+    //! Lists the distinct trigrams of a string, ignoring case.
+    //! 
+    //! @param text The string.
+    //! @returns The trigrams of the string in ascending order, with no repeats.
+    static std::vector<gram_t> gramsOf(const std::wstring& text);
+
+    //! IDs of the strings containing each trigram, in ascending order.
+    std::unordered_map<gram_t, std::vector<int>> postings_{};
+  };
+}  // namespace ragtag
+
+#endif  // INCLUDE_PATH_TRIGRAM_INDEX_H
@@ -0,0 +1,135 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "quick_open_dialog.h"
+#include <wx/sizer.h>
+#include <wx/wx.h>
+
+const size_t QuickOpenDialog::MAX_RESULTS = 50;
+const std::chrono::milliseconds QuickOpenDialog::QUERY_BUDGET{ 16 };
+
+QuickOpenDialog::QuickOpenDialog(wxWindow* parent, const ragtag::FuzzyFinder& finder,
+  const std::vector<ragtag::path_t>& paths) : wxDialog(parent, wxID_ANY, "Go to File",
+    wxDefaultPosition, wxSize(720, 420), wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER | wxWANTS_CHARS),
+  finder_(finder), paths_(paths) {
+  wxBoxSizer* sz_rows = new wxBoxSizer(wxVERTICAL);
+  tc_query_ = new wxTextCtrl(this, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize,
+    wxTE_PROCESS_ENTER);
+  tc_query_->SetHint("Type part of a file's path...");
+  tc_query_->Bind(wxEVT_TEXT, &QuickOpenDialog::OnQueryChanged, this);
+  tc_query_->Bind(wxEVT_TEXT_ENTER, &QuickOpenDialog::OnChoose, this);
+  sz_rows->Add(tc_query_, 0, wxEXPAND | wxALL, 5);
+  lb_results_ = new wxListBox(this, wxID_ANY);
+  lb_results_->Bind(wxEVT_LISTBOX_DCLICK, &QuickOpenDialog::OnChoose, this);
+  sz_rows->Add(lb_results_, 1, wxEXPAND | wxALL, 5);
+  SetSizer(sz_rows);
+
+  Bind(wxEVT_CHAR_HOOK, &QuickOpenDialog::OnKeyDown, this);
+  updateResults();
+}
+
+std::optional<ragtag::path_t> QuickOpenDialog::promptQuickOpen() {
+  chosen_path_.reset();
+  tc_query_->SetFocus();
+  ShowModal();
+  return chosen_path_;
+}
+
+void QuickOpenDialog::updateResults() {
+  const int search = ++search_;
+  query_ = tc_query_->GetValue().ToStdWstring();
+  result_ = finder_.find(query_, MAX_RESULTS, QUERY_BUDGET);
+  // A new query starts over, so a highlight from the previous one means nothing.
+  result_indices_.clear();
+  showResults();
+  if (!result_.is_complete) {
+    CallAfter([this, search]() { resumeResults(search); });
+  }
+}
+
+void QuickOpenDialog::resumeResults(const int search) {
+  if (search != search_ || result_.is_complete) {
+    return;
+  }
+
+  // Each slice runs between events, so keystrokes are handled while the search carries on.
+  result_ = finder_.resume(query_, MAX_RESULTS, QUERY_BUDGET, result_);
+  showResults();
+  if (!result_.is_complete) {
+    CallAfter([this, search]() { resumeResults(search); });
+  }
+}
+
+void QuickOpenDialog::showResults() {
+  const int selection = lb_results_->GetSelection();
+  const std::optional<int> selected_index = selection == wxNOT_FOUND
+    || selection >= static_cast<int>(result_indices_.size()) ? std::optional<int>()
+    : result_indices_[selection];
+
+  result_indices_.clear();
+  wxArrayString items;
+  int new_selection = 0;
+  for (const auto& match : result_.matches) {
+    if (selected_index == match.index) {
+      new_selection = static_cast<int>(result_indices_.size());
+    }
+    result_indices_.push_back(match.index);
+    items.Add(paths_[match.index].wstring());
+  }
+
+  lb_results_->Freeze();
+  lb_results_->Set(items);
+  if (!items.IsEmpty()) {
+    lb_results_->SetSelection(new_selection);
+  }
+  lb_results_->Thaw();
+  SetTitle(result_.is_complete ? "Go to File" : "Go to File (searching...)");
+}
+
+void QuickOpenDialog::chooseSelection() {
+  const int selection = lb_results_->GetSelection();
+  if (selection == wxNOT_FOUND || selection >= static_cast<int>(result_indices_.size())) {
+    return;
+  }
+  chosen_path_ = paths_[result_indices_[selection]];
+  EndModal(wxID_OK);
+}
+
+void QuickOpenDialog::OnQueryChanged(wxCommandEvent& event) {
+  updateResults();
+}
+
+void QuickOpenDialog::OnChoose(wxCommandEvent& event) {
+  chooseSelection();
+}
+
+void QuickOpenDialog::OnKeyDown(wxKeyEvent& event) {
+  const int num_results = static_cast<int>(lb_results_->GetCount());
+  if (event.GetKeyCode() == WXK_ESCAPE
+    || event.GetUnicodeKey() == 'W' && event.GetModifiers() == wxMOD_CONTROL) {
+    chosen_path_.reset();
+    EndModal(wxID_CANCEL);
+  }
+  else if ((event.GetKeyCode() == WXK_DOWN || event.GetKeyCode() == WXK_UP) && num_results > 0) {
+    // Keep focus in the query box while moving the highlight so the user can keep typing.
+    const int step = event.GetKeyCode() == WXK_DOWN ? 1 : -1;
+    const int selection = lb_results_->GetSelection();
+    lb_results_->SetSelection(selection == wxNOT_FOUND ? 0
+      : (selection + step + num_results) % num_results);
+  }
+  else {
+    event.Skip();
+  }
+}
@@ -0,0 +1,119 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#ifndef INCLUDE_QUICK_OPEN_DIALOG_H
+#define INCLUDE_QUICK_OPEN_DIALOG_H
+
+#include "fuzzy_finder.h"
+#include "tag_map.h"
+#include <chrono>
+#include <optional>
+#include <string>
+#include <vector>
+#include <wx/dialog.h>
+#include <wx/event.h>
+#include <wx/listbox.h>
+#include <wx/textctrl.h>
+
+//! User interface dialog allowing the user to jump to any project file by typing part of its path.
+class QuickOpenDialog : public wxDialog {
+public:
+  //! Constructor.
+  //! 
+  //! @param parent The parent window.
+  //! @param finder Finder built from `paths`. Must outlive the dialog.
+  //! @param paths The paths the user may choose from. Must outlive the dialog.
+  QuickOpenDialog(wxWindow* parent, const ragtag::FuzzyFinder& finder,
+    const std::vector<ragtag::path_t>& paths);
+
+  //! Displays the QuickOpenDialog and gathers the user's choice.
+  //! 
+  //! @returns The path the user chose, or an empty optional if the user exits the dialog without
+  //!     choosing one.
+  std::optional<ragtag::path_t> promptQuickOpen();
+
+private:
+  //! Greatest number of matches listed at once.
+  static const size_t MAX_RESULTS;
+
+  //! Time allotted to each slice of matching a query, so that typing stays responsive on large
+  //! projects.
+  static const std::chrono::milliseconds QUERY_BUDGET;
+
+  //! Begins matching the current query, listing the best paths found within the budget.
+  //! 
+  //! If the budget runs out, the rest of the paths are matched in further slices between events
+  //! (see resumeResults()) until the search is complete.
+  void updateResults();
+
+  //! Matches another slice of the paths against the query, merging the matches into the list.
+  //! 
+  //! @param search The search being resumed. Searches superseded by a newer query are dropped.
+  void resumeResults(int search);
+
+  //! Lists the matches of `result_`, keeping the highlighted path highlighted if it's still listed.
+  void showResults();
+
+  //! Chooses the highlighted path, if any, and closes the dialog.
+  void chooseSelection();
+
+  //! Event handler for when the query text changes.
+  //! 
+  //! @param event Information about the event that triggered this function.
+  void OnQueryChanged(wxCommandEvent& event);
+
+  //! Event handler for when the user presses Enter in the query box or double-clicks a result.
+  //! 
+  //! @param event Information about the event that triggered this function.
+  void OnChoose(wxCommandEvent& event);
+
+  //! Event handler for key presses.
+  //! 
+  //! Moves the highlight through the results upon the up and down arrow keys, and exits the
+  //! dialog upon Ctrl+W or Esc.
+  //! 
+  //! @param event Information about the event that triggered this function, including keyboard
+  //!     state.
+  void OnKeyDown(wxKeyEvent& event);
+
+  //! Finder matching queries against `paths_`.
+  const ragtag::FuzzyFinder& finder_;
+
+  //! The paths the user may choose from.
+  const std::vector<ragtag::path_t>& paths_;
+
+  //! Query being matched.
+  std::wstring query_{};
+
+  //! Matches of `query_` found so far.
+  ragtag::FuzzyFinder::Result result_{};
+
+  //! Number of searches begun, identifying the current one.
+  int search_{ 0 };
+
+  //! Positions within `paths_` of the listed results, in the order listed.
+  std::vector<int> result_indices_{};
+
+  //! The path the user chose, if any.
+  std::optional<ragtag::path_t> chosen_path_{};
+
+  //! Text control in which the user types the query.
+  wxTextCtrl* tc_query_{ nullptr };
+
+  //! List of the paths best matching the query.
+  wxListBox* lb_results_{ nullptr };
+};
+
+#endif  // INCLUDE_QUICK_OPEN_DIALOG_H
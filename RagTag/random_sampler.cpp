@@ -0,0 +1,37 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "random_sampler.h"
+#include <algorithm>
+#include <random>
+#include <set>
+
+namespace ragtag {
+  std::vector<int> RandomSampler::sampleIndices(const int population, const int count,
+    const std::uint64_t seed) {
+    const int num_chosen = std::clamp(count, 0, std::max(population, 0));
+    std::mt19937_64 engine(seed);
+    std::set<int> chosen;
+    // Each step chooses uniformly among the positions below `last`, falling back on `last` itself
+    // if the choice was already made. This keeps every subset equally likely.
+    for (int last = population - num_chosen; last < population; ++last) {
+      const int candidate = std::uniform_int_distribution<int>(0, last)(engine);
+      if (!chosen.insert(candidate).second) {
+        chosen.insert(last);
+      }
+    }
+    return std::vector<int>(chosen.begin(), chosen.end());
+  }
+}  // namespace ragtag
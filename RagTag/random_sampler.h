@@ -0,0 +1,41 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#ifndef INCLUDE_RANDOM_SAMPLER_H
+#define INCLUDE_RANDOM_SAMPLER_H
+
+#include <cstdint>
+#include <vector>
+
+namespace ragtag {
+  //! Chooser of uniformly random samples from a numbered population.
+  class RandomSampler {
+  public:
+    //! Chooses distinct positions uniformly at random.
+    //! 
+    //! Uses Floyd's algorithm, which draws one random number per chosen position no matter how
+    //! large the population is, so the cost is O(k log k) for k positions.
+    //! 
+    //! @param population The number of positions to choose from, numbered from zero.
+    //! @param count The number of positions to choose. If the population is smaller, every
+    //!     position is chosen.
+    //! @param seed Seed for the random number generator. The same seed, population, and count
+    //!     choose the same positions every time on a given platform.
+    //! @returns The chosen positions in ascending order.
+    static std::vector<int> sampleIndices(int population, int count, std::uint64_t seed);
+  };
+}  // namespace ragtag
+
+#endif  // INCLUDE_RANDOM_SAMPLER_H
@@ -0,0 +1,74 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "rating_histogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ragtag {
+  const int RatingHistogram::BINS_PER_STAR = 2;
+
+  RatingHistogram::RatingHistogram(const int max_stars)
+    : prefix_sums_(std::max(max_stars, 0) * BINS_PER_STAR + 2, 0) {}
+
+  void RatingHistogram::add(const std::optional<rating_t> rating) {
+    if (!rating.has_value()) {
+      ++num_unrated_;
+      return;
+    }
+    for (size_t i = binOf(*rating) + 1; i < prefix_sums_.size(); ++i) {
+      ++prefix_sums_[i];
+    }
+  }
+
+  void RatingHistogram::remove(const std::optional<rating_t> rating) {
+    if (!rating.has_value()) {
+      --num_unrated_;
+      return;
+    }
+    for (size_t i = binOf(*rating) + 1; i < prefix_sums_.size(); ++i) {
+      --prefix_sums_[i];
+    }
+  }
+
+  void RatingHistogram::clear() {
+    std::fill(prefix_sums_.begin(), prefix_sums_.end(), 0);
+    num_unrated_ = 0;
+  }
+
+  int RatingHistogram::countRated(const rating_t min_rating, const rating_t max_rating) const {
+    const int num_bins = static_cast<int>(prefix_sums_.size()) - 1;
+    const int first_bin = std::max(static_cast<int>(std::ceil(min_rating * BINS_PER_STAR)), 0);
+    const int last_bin = std::min(static_cast<int>(std::floor(max_rating * BINS_PER_STAR)),
+      num_bins - 1);
+    if (first_bin > last_bin) {
+      return 0;
+    }
+    return prefix_sums_[last_bin + 1] - prefix_sums_[first_bin];
+  }
+
+  int RatingHistogram::numRated() const {
+    return prefix_sums_.back();
+  }
+
+  int RatingHistogram::numUnrated() const {
+    return num_unrated_;
+  }
+
+  int RatingHistogram::binOf(const rating_t rating) const {
+    const int num_bins = static_cast<int>(prefix_sums_.size()) - 1;
+    return std::clamp(static_cast<int>(std::floor(rating * BINS_PER_STAR)), 0, num_bins - 1);
+  }
+}  // namespace ragtag
@@ -0,0 +1,87 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#ifndef INCLUDE_RATING_HISTOGRAM_H
+#define INCLUDE_RATING_HISTOGRAM_H
+
+#include "tag_map.h"
+#include <optional>
+#include <vector>
+
+namespace ragtag {
+  //! Tally of files by rating in half-star steps, answering "how many files are rated between x
+  //! and y?" in constant time.
+  //! 
+  //! The histogram is kept as running prefix sums over its bins, so adding or removing a file
+  //! touches a handful of bins and counting a range of ratings is a single subtraction. Ratings are
+  //! assumed to be multiples of half a star; other ratings are counted in the bin below them.
+  class RatingHistogram {
+  public:
+    //! Number of bins spanning one star of rating.
+    static const int BINS_PER_STAR;
+
+    //! Constructor.
+    //! 
+    //! @param max_stars The highest rating to distinguish. Higher ratings are counted as this one,
+    //!     and negative ratings are counted as zero.
+    explicit RatingHistogram(int max_stars);
+
+    //! Counts a file.
+    //! 
+    //! @param rating The rating of the file, or an empty optional if the file is unrated.
+    void add(std::optional<rating_t> rating);
+
+    //! Stops counting a file previously counted by add().
+    //! 
+    //! @param rating The rating the file was counted with.
+    void remove(std::optional<rating_t> rating);
+
+    //! Stops counting all files.
+    void clear();
+
+    //! Counts the rated files with ratings within a range.
+    //! 
+    //! @param min_rating The lowest rating to count, inclusive.
+    //! @param max_rating The highest rating to count, inclusive.
+    //! @returns The number of files rated from `min_rating` to `max_rating`.
+    int countRated(rating_t min_rating, rating_t max_rating) const;
+
+    //! Obtains the count of rated files.
+    //! 
+    //! @returns The number of rated files counted.
+    int numRated() const;
+
+    //! Obtains the count of unrated files.
+    //! 
+    //! @returns The number of unrated files counted.
+    int numUnrated() const;
+
+  private:
+    //! Determines the bin counting a rating.
+    //! 
+    //! @param rating The rating.
+    //! @returns The index of the bin.
+    int binOf(rating_t rating) const;
+
+    //! Count of rated files within all bins below each index. The last element counts all rated
+    //! files.
+    std::vector<int> prefix_sums_;
+
+    //! Count of unrated files.
+    int num_unrated_{ 0 };
+  };
+}  // namespace ragtag
+
+#endif  // INCLUDE_RATING_HISTOGRAM_H
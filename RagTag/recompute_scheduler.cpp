@@ -0,0 +1,149 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "recompute_scheduler.h"
+#include <iostream>
+
+namespace ragtag {
+  RecomputeScheduler::RecomputeScheduler(const std::chrono::milliseconds delay,
+    notifier_t notifier) : delay_(delay), notifier_(std::move(notifier)),
+    worker_(&RecomputeScheduler::workerLoop, this) {}
+
+  RecomputeScheduler::~RecomputeScheduler() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      is_stopping_ = true;
+      ++generation_;  // Signals any running job to stop.
+    }
+    condition_.notify_all();
+    worker_.join();
+  }
+
+  void RecomputeScheduler::schedule(job_t job) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_job_ = std::move(job);
+      pending_deadline_ = std::chrono::steady_clock::now() + delay_;
+      ++generation_;
+      finished_commit_ = nullptr;
+      published_commits_.clear();
+    }
+    condition_.notify_all();
+  }
+
+  void RecomputeScheduler::cancel() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_job_ = nullptr;
+      ++generation_;
+      finished_commit_ = nullptr;
+      published_commits_.clear();
+    }
+    condition_.notify_all();
+  }
+
+  bool RecomputeScheduler::publish(commit_t commit) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!is_running_ || running_generation_ != generation_) {
+        return false;
+      }
+      published_commits_.push_back(std::move(commit));
+    }
+    notifier_();
+    return true;
+  }
+
+  bool RecomputeScheduler::commitFinished() {
+    std::vector<commit_t> commits;
+    unsigned long generation = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      generation = generation_;
+      // Anything published is current: superseding a job discards what it published.
+      commits.swap(published_commits_);
+      if (finished_commit_ && finished_generation_ == generation_) {
+        commits.push_back(std::move(finished_commit_));
+      }
+      finished_commit_ = nullptr;
+    }
+    // Run outside the lock so that the commit functions may schedule more work. If one does, the
+    // rest are stale.
+    for (const auto& commit : commits) {
+      if (generation_ != generation) {
+        break;
+      }
+      commit();
+    }
+    return !commits.empty();
+  }
+
+  bool RecomputeScheduler::isIdle() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !pending_job_ && !is_running_ && !finished_commit_ && published_commits_.empty();
+  }
+
+  void RecomputeScheduler::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      condition_.wait(lock, [this]() { return is_stopping_ || pending_job_ != nullptr; });
+      if (is_stopping_) {
+        return;
+      }
+
+      // Wait for requests to settle. Each new request pushes the deadline back.
+      while (!is_stopping_ && pending_job_ != nullptr
+        && std::chrono::steady_clock::now() < pending_deadline_) {
+        condition_.wait_until(lock, pending_deadline_);
+      }
+      if (is_stopping_) {
+        return;
+      }
+      if (pending_job_ == nullptr) {
+        // Cancelled while waiting.
+        continue;
+      }
+
+      job_t job = std::move(pending_job_);
+      pending_job_ = nullptr;
+      const unsigned long generation = generation_;
+      running_generation_ = generation;
+      is_running_ = true;
+      lock.unlock();
+
+      const cancellation_t is_cancelled = [this, generation]() {
+        return generation_ != generation;
+        };
+      commit_t commit;
+      try {
+        commit = job(is_cancelled);
+      }
+      catch (...) {
+        // Nothing on the worker thread can handle the exception, so drop the result.
+        std::wcerr << L"Exception thrown by recomputation job.\n";
+      }
+
+      lock.lock();
+      is_running_ = false;
+      if (commit && generation_ == generation) {
+        finished_commit_ = std::move(commit);
+        finished_generation_ = generation;
+        lock.unlock();
+        notifier_();
+        lock.lock();
+      }
+    }
+  }
+}  // namespace ragtag
@@ -0,0 +1,155 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#ifndef INCLUDE_RECOMPUTE_SCHEDULER_H
+#define INCLUDE_RECOMPUTE_SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ragtag {
+  //! Runs a recomputation on a worker thread after a burst of requests has settled, keeping only
+  //! the result of the most recent request.
+  //! 
+  //! Each call to schedule() replaces any job still waiting to run and signals any job already
+  //! running to stop, since its result would be stale. A job starts only once no new job has been
+  //! scheduled for the debounce delay, so a burst of requests (such as a slider being dragged)
+  //! produces a single computation.
+  //! 
+  //! Jobs never touch the owner's state. Instead, a job returns a commit function that applies its
+  //! result, and the owner runs that function on its own thread through commitFinished(). The
+  //! notifier passed to the constructor is invoked on the worker thread whenever a commit function
+  //! is ready, and should do nothing more than arrange for commitFinished() to be called.
+  //! 
+  //! A long job may also hand over partial results through publish() as it goes. These are
+  //! committed in order ahead of the job's final result and are discarded along with it if the job
+  //! is superseded.
+  class RecomputeScheduler {
+  public:
+    //! Function reporting whether a job should stop early because its result is no longer wanted.
+    typedef std::function<bool()> cancellation_t;
+
+    //! Function applying the result of a job. Run on the owner's thread.
+    typedef std::function<void()> commit_t;
+
+    //! Function performing a computation on the worker thread.
+    //! 
+    //! The job should poll the cancellation function and return an empty commit function if
+    //! cancelled.
+    typedef std::function<commit_t(const cancellation_t&)> job_t;
+
+    //! Function invoked on the worker thread when a result is ready to be committed.
+    typedef std::function<void()> notifier_t;
+
+    //! Constructor. Starts the worker thread.
+    //! 
+    //! @param delay Time for which requests must stop arriving before a job starts.
+    //! @param notifier Function invoked on the worker thread when a result is ready to commit.
+    RecomputeScheduler(std::chrono::milliseconds delay, notifier_t notifier);
+
+    //! Destructor. Cancels any pending or running job and waits for the worker thread to finish.
+    ~RecomputeScheduler();
+
+    RecomputeScheduler(const RecomputeScheduler&) = delete;
+    RecomputeScheduler& operator=(const RecomputeScheduler&) = delete;
+
+    //! Schedules a job, superseding any job scheduled earlier.
+    //! 
+    //! @param job The computation to perform.
+    void schedule(job_t job);
+
+    //! Discards any pending job and any result not yet committed, and signals any running job to
+    //! stop.
+    //! 
+    //! Useful when the owner computes a result synchronously, making scheduled work redundant.
+    void cancel();
+
+    //! Hands over a partial result from the running job, to be committed ahead of its final result.
+    //! 
+    //! Must only be called by a job, from the worker thread.
+    //! 
+    //! @param commit Function applying the partial result.
+    //! @returns False if the job has been superseded, in which case the result is discarded.
+    bool publish(commit_t commit);
+
+    //! Applies the partial results and final result of the most recent job, as far as they're
+    //! available and haven't been superseded.
+    //! 
+    //! Must be called from the owner's thread.
+    //! 
+    //! @returns True if a result was applied.
+    bool commitFinished();
+
+    //! Checks whether any job is waiting, running, or awaiting commit.
+    //! 
+    //! @returns True if no work is outstanding.
+    bool isIdle() const;
+
+  private:
+    //! Body of the worker thread.
+    void workerLoop();
+
+    //! Guards all members below except `generation_`, which is also read without the lock.
+    mutable std::mutex mutex_{};
+
+    //! Wakes the worker when a job is scheduled or the scheduler is shutting down.
+    std::condition_variable condition_{};
+
+    //! Time for which requests must stop arriving before a job starts.
+    const std::chrono::milliseconds delay_;
+
+    //! Function invoked on the worker thread when a result is ready to commit.
+    const notifier_t notifier_;
+
+    //! The job waiting to run, if any.
+    job_t pending_job_{};
+
+    //! Time at which the pending job may start unless superseded first.
+    std::chrono::steady_clock::time_point pending_deadline_{};
+
+    //! Count of calls to schedule() and cancel(). A job's result is wanted only if no such call has
+    //! been made since the job was scheduled.
+    std::atomic<unsigned long> generation_{ 0 };
+
+    //! Commit function of the most recently finished job, if not yet committed.
+    commit_t finished_commit_{};
+
+    //! Generation of the job that produced `finished_commit_`.
+    unsigned long finished_generation_{ 0 };
+
+    //! Commit functions of partial results published by the running job, in order, if not yet
+    //! committed.
+    std::vector<commit_t> published_commits_{};
+
+    //! Generation of the running job.
+    unsigned long running_generation_{ 0 };
+
+    //! Whether a job is running on the worker thread.
+    bool is_running_{ false };
+
+    //! Whether the worker thread should exit.
+    bool is_stopping_{ false };
+
+    //! The worker thread. Declared last so that it starts after everything it uses is initialized.
+    std::thread worker_{};
+  };
+}  // namespace ragtag
+
+#endif  // INCLUDE_RECOMPUTE_SCHEDULER_H
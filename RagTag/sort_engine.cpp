@@ -0,0 +1,167 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "sort_engine.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <thread>
+
+namespace ragtag {
+  const size_t SortEngine::PARALLEL_THRESHOLD = 65536;
+  const unsigned SortEngine::MAX_THREADS = 8;
+
+  namespace {
+    //! Splits the range [0, count) into contiguous chunks and processes them concurrently.
+    //! 
+    //! @param count The size of the range.
+    //! @param num_chunks The number of chunks to split the range into.
+    //! @param fn Function processing the chunk [begin, end).
+    void forEachChunk(const size_t count, const size_t num_chunks,
+      const std::function<void(size_t, size_t)>& fn) {
+      std::vector<std::thread> threads;
+      threads.reserve(num_chunks);
+      for (size_t i = 0; i < num_chunks; ++i) {
+        const size_t begin = count * i / num_chunks;
+        const size_t end = count * (i + 1) / num_chunks;
+        threads.emplace_back(fn, begin, end);
+      }
+      for (auto& thread : threads) {
+        thread.join();
+      }
+    }
+  }
+
+  std::vector<file_id_t> SortEngine::sort(const TagMap& tag_map,
+    const std::vector<file_id_t>& file_ids, const std::vector<Criterion>& criteria) {
+    if (criteria.empty() || file_ids.size() < 2) {
+      return file_ids;
+    }
+
+    const size_t num_rows = file_ids.size();
+    const size_t num_keys = criteria.size();
+    const size_t num_chunks = num_rows < PARALLEL_THRESHOLD ? 1
+      : std::clamp<size_t>(std::thread::hardware_concurrency(), 1, MAX_THREADS);
+
+    // Files are stored in path order, so a file's position in that order stands in for its path.
+    std::vector<int> path_ranks;
+    const bool needs_path_ranks = std::any_of(criteria.begin(), criteria.end(),
+      [](const Criterion& criterion) { return criterion.field == Field::PATH; });
+    if (needs_path_ranks) {
+      path_ranks.assign(tag_map.fileIdLimit(), -1);
+      int rank = 0;
+      for (const file_id_t id : tag_map.getAllFileIds()) {
+        path_ranks[id] = rank++;
+      }
+    }
+
+    // Keys are laid out row by row so that one comparison touches one small, contiguous block.
+    // Descending criteria are negated so that every comparison is a plain less-than.
+    std::vector<double> keys(num_rows * num_keys);
+    const auto extract_keys = [&](const size_t begin, const size_t end) {
+      for (size_t row = begin; row < end; ++row) {
+        const file_id_t id = file_ids[row];
+        for (size_t k = 0; k < num_keys; ++k) {
+          const Criterion& criterion = criteria[k];  // Alias for convenience
+          double key = 0.0;
+          switch (criterion.field) {
+          case Field::PATH:
+            key = id >= 0 && id < static_cast<file_id_t>(path_ranks.size()) ? path_ranks[id] : -1;
+            break;
+          case Field::RATING: {
+            const auto rating = tag_map.getRating(id);
+            key = rating.has_value() ? *rating : -std::numeric_limits<double>::infinity();
+            break;
+          }
+          case Field::TAG: {
+            const auto setting = tag_map.getTagSetting(id, criterion.tag);
+            key = !setting.has_value() || *setting == TagSetting::UNCOMMITTED ? 1.0
+              : *setting == TagSetting::YES ? 2.0 : 0.0;
+            break;
+          }
+          }
+          keys[row * num_keys + k] = criterion.ascending ? key : -key;
+        }
+      }
+      };
+
+    // Comparing positions last makes the order total, so an unstable sort gives a stable result
+    // and chunks sorted separately merge into the same order a single sort would produce.
+    const auto less = [&keys, num_keys](const size_t lhs, const size_t rhs) {
+      const double* lhs_keys = &keys[lhs * num_keys];
+      const double* rhs_keys = &keys[rhs * num_keys];
+      for (size_t k = 0; k < num_keys; ++k) {
+        if (lhs_keys[k] != rhs_keys[k]) {
+          return lhs_keys[k] < rhs_keys[k];
+        }
+      }
+      return lhs < rhs;
+      };
+
+    std::vector<size_t> permutation(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+      permutation[i] = i;
+    }
+
+    if (num_chunks == 1) {
+      extract_keys(0, num_rows);
+      std::sort(permutation.begin(), permutation.end(), less);
+    }
+    else {
+      forEachChunk(num_rows, num_chunks, extract_keys);
+      forEachChunk(num_rows, num_chunks, [&](const size_t begin, const size_t end) {
+        std::sort(permutation.begin() + begin, permutation.begin() + end, less);
+        });
+
+      // Merge neighboring sorted runs pairwise until one run remains.
+      std::vector<size_t> run_bounds;
+      for (size_t i = 0; i <= num_chunks; ++i) {
+        run_bounds.push_back(num_rows * i / num_chunks);
+      }
+      while (run_bounds.size() > 2) {
+        const size_t num_merges = (run_bounds.size() - 1) / 2;
+        std::vector<std::thread> threads;
+        threads.reserve(num_merges);
+        for (size_t m = 0; m < num_merges; ++m) {
+          const auto first = permutation.begin() + run_bounds[2 * m];
+          const auto middle = permutation.begin() + run_bounds[2 * m + 1];
+          const auto last = permutation.begin() + run_bounds[2 * m + 2];
+          threads.emplace_back([first, middle, last, &less]() {
+            std::inplace_merge(first, middle, last, less);
+            });
+        }
+        for (auto& thread : threads) {
+          thread.join();
+        }
+
+        std::vector<size_t> merged_bounds;
+        for (size_t i = 0; i < run_bounds.size(); i += 2) {
+          merged_bounds.push_back(run_bounds[i]);
+        }
+        if (merged_bounds.back() != num_rows) {
+          merged_bounds.push_back(num_rows);
+        }
+        run_bounds.swap(merged_bounds);
+      }
+    }
+
+    std::vector<file_id_t> sorted;
+    sorted.reserve(num_rows);
+    for (const size_t row : permutation) {
+      sorted.push_back(file_ids[row]);
+    }
+    return sorted;
+  }
+}  // namespace ragtag
@@ -0,0 +1,75 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#ifndef INCLUDE_SORT_ENGINE_H
+#define INCLUDE_SORT_ENGINE_H
+
+#include "tag_map.h"
+#include <vector>
+
+namespace ragtag {
+  //! Sorts files of a TagMap by one or more of their properties.
+  //! 
+  //! Rather than consulting the TagMap from within comparisons, the engine extracts one compact
+  //! numeric key per file and criterion up front, then sorts an array of row positions by those
+  //! keys. Paths are keyed by their rank within the TagMap, which keeps its files ordered by path,
+  //! so sorting by path never compares path strings. Large inputs are keyed and sorted in parallel.
+  class SortEngine {
+  public:
+    //! Property of a file that can be sorted by.
+    enum class Field {
+      PATH,    //!< Path, sorted lexicographically.
+      RATING,  //!< Rating, with unrated files sorting below rated files.
+      TAG      //!< Setting of a tag, sorting in the order NO, UNCOMMITTED, YES.
+    };
+
+    //! One level of a multi-level sort.
+    struct Criterion {
+      //! Property to sort by.
+      Field field{ Field::PATH };
+      //! Tag whose setting to sort by. Only meaningful if `field` is Field::TAG.
+      tag_t tag{};
+      //! True to sort in ascending order; false to sort in descending order.
+      bool ascending{ true };
+
+      //! Tests equality of this Criterion and another.
+      //! 
+      //! @param rhs The Criterion to compare this one with.
+      //! @returns True if both criteria sort by the same property in the same direction.
+      bool operator==(const Criterion& rhs) const noexcept = default;
+    };
+
+    //! Number of files at which keying and sorting are split across threads.
+    static const size_t PARALLEL_THRESHOLD;
+
+    //! Maximum number of threads used by a parallel sort.
+    static const unsigned MAX_THREADS;
+
+    //! Sorts files by a sequence of criteria.
+    //! 
+    //! Files are ordered by the first criterion, files that tie by the first criterion are ordered
+    //! by the second, and so on. Files that tie by every criterion keep their relative order.
+    //! 
+    //! @param tag_map The tag map describing the files.
+    //! @param file_ids The IDs of the files to sort. IDs not belonging to the tag map sort as
+    //!     though they were unrated and untagged files with the lowest-ranked path.
+    //! @param criteria The criteria to sort by, most significant first.
+    //! @returns The IDs, sorted.
+    static std::vector<file_id_t> sort(const TagMap& tag_map,
+      const std::vector<file_id_t>& file_ids, const std::vector<Criterion>& criteria);
+  };
+}  // namespace ragtag
+
+#endif  // INCLUDE_SORT_ENGINE_H
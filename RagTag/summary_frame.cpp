@@ -15,25 +15,41 @@
 
 #include "rag_tag_util.h"
 #include "summary_frame.h"
+#include "summary_list_ctrl.h"
+#include "zip_exporter.h"
+#include <algorithm>
 #include <filesystem>
 #include <functional>
-#include <wx/dcclient.h>
+#include <limits>
+#include <random>
+#include <wx/choicdlg.h>
 #include <wx/dirdlg.h> 
+#include <wx/filedlg.h>
 #include <wx/msgdlg.h>
+#include <wx/numdlg.h>
 #include <wx/panel.h>
 #include <wx/progdlg.h>
 #include <wx/sizer.h>
 #include <wx/statbox.h>
+#include <wx/textdlg.h>
 
 wxDEFINE_EVENT(SUMMARY_FRAME_EVENT, SummaryFrameEvent);
 
-const int SummaryFrame::PATH_COLUMN_INDEX = 0;
-const int SummaryFrame::RATING_COLUMN_INDEX = 1;
-const int SummaryFrame::FIRST_TAG_COLUMN_INDEX = 2;
-const int SummaryFrame::PATH_EXTENT_MARGIN_PX = 30;
+const std::chrono::milliseconds SummaryFrame::FILE_LIST_REFRESH_DELAY{ 150 };
 
 SummaryFrame::SummaryFrame(wxWindow* parent) : wxFrame(parent, wxID_ANY, "Project Summary",
-  wxDefaultPosition, wxSize(1280, 768))
+  wxDefaultPosition, wxSize(1280, 768)), summary_model_({
+    .tag_yes = RagTagUtil::GLYPH_CHECKED.ToStdWstring(),
+    .tag_no = RagTagUtil::GLYPH_UNCHECKED.ToStdWstring(),
+    .tag_uncommitted = RagTagUtil::GLYPH_UNCOMMITTED.ToStdWstring(),
+    .rating_full_star = RagTagUtil::GLYPH_RATING_FULL_STAR.ToStdWstring(),
+    .rating_half_star = RagTagUtil::GLYPH_RATING_HALF_STAR.ToStdWstring(),
+    .no_rating = L"--",
+    .max_stars = RagTagUtil::MAX_STARS}),
+  file_list_scheduler_(FILE_LIST_REFRESH_DELAY, [this]() {
+    // Called on the worker thread. CallAfter() is safe to use from there.
+    CallAfter(&SummaryFrame::commitFileListRefresh);
+    })
 {
   SetMinSize(wxSize(620, 360));
   wxPanel* p_main = new wxPanel(this, wxID_ANY);
@@ -43,6 +59,18 @@ SummaryFrame::SummaryFrame(wxWindow* parent) : wxFrame(parent, wxID_ANY, "Projec
   wxPanel* p_filters = new wxPanel(p_main, wxID_ANY);
   wxSizer* sz_filters = new wxBoxSizer(wxHORIZONTAL);
   p_filters->SetSizer(sz_filters);
+  wxPanel* p_path_filter = new wxPanel(p_filters, wxID_ANY);
+  wxStaticBoxSizer* sz_path_filter = new wxStaticBoxSizer(wxVERTICAL, p_path_filter,
+    "Path Filter");
+  p_path_filter->SetSizer(sz_path_filter);
+  tc_path_search_ = new wxTextCtrl(sz_path_filter->GetStaticBox(), wxID_ANY, wxEmptyString,
+    wxDefaultPosition, wxSize(180, -1));
+  tc_path_search_->SetHint("Path contains...");
+  tc_path_search_->Bind(wxEVT_TEXT, &SummaryFrame::OnFilterChangeGeneric, this);
+  sz_path_filter->Add(tc_path_search_, 0, wxEXPAND | wxALL, 5);
+  sz_path_filter->AddStretchSpacer(1);  // Empty space at bottom to top-align
+  sz_filters->Add(p_path_filter, 0, wxEXPAND | wxALL, 5);
+
   wxPanel* p_rating_filter = new wxPanel(p_filters, wxID_ANY);
   wxStaticBoxSizer* sz_rating_filter = new wxStaticBoxSizer(wxVERTICAL, p_rating_filter,
     "Rating Filter");
@@ -56,12 +84,16 @@ SummaryFrame::SummaryFrame(wxWindow* parent) : wxFrame(parent, wxID_ANY, "Projec
   sl_min_rating_ = new wxSlider(p_sliders, wxID_ANY, 0, 0, 5,
     wxDefaultPosition, wxDefaultSize, wxSL_HORIZONTAL | wxSL_AUTOTICKS | wxSL_VALUE_LABEL);
   sl_min_rating_->Bind(wxEVT_SLIDER, &SummaryFrame::OnMinSliderMove, this);
+  sl_min_rating_->Bind(wxEVT_SCROLL_THUMBTRACK, &SummaryFrame::OnRatingSliderDrag, this);
+  sl_min_rating_->Bind(wxEVT_SCROLL_THUMBRELEASE, &SummaryFrame::OnRatingSliderRelease, this);
   sz_sliders->Add(sl_min_rating_, 0, wxEXPAND | wxALL, 5);
   wxStaticText* max_rating_label = new wxStaticText(p_sliders, wxID_ANY, "Max:");
   sz_sliders->Add(max_rating_label, 0, wxALIGN_CENTER_VERTICAL | wxEXPAND | wxALL, 5);
   sl_max_rating_ = new wxSlider(p_sliders, wxID_ANY, 5, 0, 5,
     wxDefaultPosition, wxDefaultSize, wxSL_HORIZONTAL | wxSL_AUTOTICKS | wxSL_VALUE_LABEL);
   sl_max_rating_->Bind(wxEVT_SLIDER, &SummaryFrame::OnMaxSliderMove, this);
+  sl_max_rating_->Bind(wxEVT_SCROLL_THUMBTRACK, &SummaryFrame::OnRatingSliderDrag, this);
+  sl_max_rating_->Bind(wxEVT_SCROLL_THUMBRELEASE, &SummaryFrame::OnRatingSliderRelease, this);
   sz_sliders->Add(sl_max_rating_, 0, wxEXPAND | wxALL, 5);
   sz_rating_filter->Add(p_sliders, 0, wxEXPAND | wxALL, 0);
 
@@ -75,6 +107,8 @@ SummaryFrame::SummaryFrame(wxWindow* parent) : wxFrame(parent, wxID_ANY, "Projec
   cb_show_unrated_->SetValue(wxCHK_CHECKED);
   cb_show_unrated_->Bind(wxEVT_CHECKBOX, &SummaryFrame::OnFilterChangeGeneric, this);
   sz_rating_filter->Add(cb_show_unrated_, 0, wxEXPAND | wxALL, 5);
+  st_rating_counts_ = new wxStaticText(sz_rating_filter->GetStaticBox(), wxID_ANY, "");
+  sz_rating_filter->Add(st_rating_counts_, 0, wxEXPAND | wxALL, 5);
   sz_rating_filter->AddStretchSpacer(1);  // Empty space at bottom to top-align
   sz_filters->Add(p_rating_filter, 0, wxEXPAND | wxALL, 5);
 
@@ -104,6 +138,23 @@ SummaryFrame::SummaryFrame(wxWindow* parent) : wxFrame(parent, wxID_ANY, "Projec
   sz_tag_filter->Add(cb_show_uncommitted_, 0, wxEXPAND | wxALL, 5);
   sz_filters->Add(p_tag_filter, 0, wxEXPAND | wxALL, 5);
 
+  wxPanel* p_multi_tag_filter = new wxPanel(p_filters, wxID_ANY);
+  wxStaticBoxSizer* sz_multi_tag_filter = new wxStaticBoxSizer(wxVERTICAL, p_multi_tag_filter,
+    "Multi-Tag Filter");
+  p_multi_tag_filter->SetSizer(sz_multi_tag_filter);
+  wxArrayString match_modes = { "Match all", "Match any" };
+  ch_tag_match_mode_ = new wxChoice(sz_multi_tag_filter->GetStaticBox(), wxID_ANY,
+    wxDefaultPosition, wxDefaultSize, match_modes);
+  ch_tag_match_mode_->SetSelection(TAG_MATCH_ALL);
+  ch_tag_match_mode_->Bind(wxEVT_CHOICE, &SummaryFrame::OnFilterChangeGeneric, this);
+  sz_multi_tag_filter->Add(ch_tag_match_mode_, 0, wxEXPAND | wxALL, 5);
+  sw_tag_constraints_ = new wxScrolledWindow(sz_multi_tag_filter->GetStaticBox(), wxID_ANY,
+    wxDefaultPosition, wxSize(220, 110), wxVSCROLL);
+  sw_tag_constraints_->SetScrollRate(0, 10);
+  sw_tag_constraints_->SetSizer(new wxFlexGridSizer(2));
+  sz_multi_tag_filter->Add(sw_tag_constraints_, 1, wxEXPAND | wxALL, 5);
+  sz_filters->Add(p_multi_tag_filter, 0, wxEXPAND | wxALL, 5);
+
   wxPanel* p_presence_filter = new wxPanel(p_filters, wxID_ANY);
   wxStaticBoxSizer* sz_presence_filter = new wxStaticBoxSizer(wxVERTICAL, p_presence_filter,
     "Presence Filter");
@@ -133,9 +184,7 @@ SummaryFrame::SummaryFrame(wxWindow* parent) : wxFrame(parent, wxID_ANY, "Projec
   sz_filter_info->Add(st_filtered_file_count_, wxEXPAND | wxALIGN_CENTRE_VERTICAL | wxALL , 5);
   sz_main->Add(p_filter_info, 0, wxEXPAND | wxALL, 0);
 
-  lc_summary_ = new wxListCtrl(p_main, wxID_ANY, wxDefaultPosition, wxDefaultSize,
-    wxLC_REPORT | wxLC_SINGLE_SEL);
-  lc_summary_->EnableCheckBoxes();
+  lc_summary_ = new SummaryListCtrl(p_main, summary_model_, file_status_cache_);
   lc_summary_->Bind(wxEVT_LIST_COL_CLICK, &SummaryFrame::OnClickHeading, this);
   lc_summary_->Bind(wxEVT_LIST_ITEM_CHECKED, &SummaryFrame::OnFileChecked, this);
   lc_summary_->Bind(wxEVT_LIST_ITEM_UNCHECKED, &SummaryFrame::OnFileUnchecked, this);
@@ -152,6 +201,10 @@ SummaryFrame::SummaryFrame(wxWindow* parent) : wxFrame(parent, wxID_ANY, "Projec
   wxButton* b_deselect_all_files = new wxButton(p_summary_buttons, wxID_ANY, "Deselect All Files");
   b_deselect_all_files->Bind(wxEVT_BUTTON, &SummaryFrame::OnDeselectAllFiles, this);
   sz_summary_buttons->Add(b_deselect_all_files, 0, wxALL, 5);
+  wxButton* b_select_random_files = new wxButton(p_summary_buttons, wxID_ANY,
+    "Select Random Files...");
+  b_select_random_files->Bind(wxEVT_BUTTON, &SummaryFrame::OnSelectRandomFiles, this);
+  sz_summary_buttons->Add(b_select_random_files, 0, wxALL, 5);
   sz_summary_buttons->AddStretchSpacer(1);  // Stretch spacer at center to separate button groups
   b_delete_files_ = new wxButton(p_summary_buttons, wxID_ANY, "Delete Selected Files");
   b_delete_files_->Bind(wxEVT_BUTTON, &SummaryFrame::OnDeleteFiles, this);
@@ -160,10 +213,28 @@ SummaryFrame::SummaryFrame(wxWindow* parent) : wxFrame(parent, wxID_ANY, "Projec
     "Remove Selected Files from Project");
   b_remove_from_project_->Bind(wxEVT_BUTTON, &SummaryFrame::OnRemoveFromProject, this);
   sz_summary_buttons->Add(b_remove_from_project_, 0, wxALL, 5);
+  wxArrayString copy_modes = { "Copy files", "Reflink files (copy-on-write)", "Hard-link files",
+    "Symbolic-link files" };
+  ch_copy_mode_ = new wxChoice(p_summary_buttons, wxID_ANY, wxDefaultPosition, wxDefaultSize,
+    copy_modes);
+  ch_copy_mode_->SetSelection(COPY_MODE_COPY);
+  ch_copy_mode_->SetToolTip("Links are created in a fraction of the time and space copies take, "
+    "but changes made through a hard link or symbolic link also affect the original file. Files "
+    "that can't be linked are copied instead.");
+  sz_summary_buttons->Add(ch_copy_mode_, 0, wxALIGN_CENTER_VERTICAL | wxALL, 5);
+  cb_verify_copies_ = new wxCheckBox(p_summary_buttons, wxID_ANY, "Verify copies",
+    wxDefaultPosition, wxDefaultSize);
+  cb_verify_copies_->SetToolTip("Reads each copy back and compares it against the original, then "
+    "saves the files' checksums to a manifest (.sfv) in the destination directory. Copying "
+    "takes longer.");
+  sz_summary_buttons->Add(cb_verify_copies_, 0, wxALIGN_CENTER_VERTICAL | wxALL, 5);
   b_copy_selections_ = new wxButton(p_summary_buttons, wxID_ANY,
     "Copy Selected Files to Directory...");
   b_copy_selections_->Bind(wxEVT_BUTTON, &SummaryFrame::OnCopySelections, this);
   sz_summary_buttons->Add(b_copy_selections_, 0, wxALL, 5);
+  b_export_zip_ = new wxButton(p_summary_buttons, wxID_ANY, "Export Selected Files to ZIP...");
+  b_export_zip_->Bind(wxEVT_BUTTON, &SummaryFrame::OnExportSelectionsToZip, this);
+  sz_summary_buttons->Add(b_export_zip_, 0, wxALL, 5);
   sz_main->Add(p_summary_buttons, 0, wxEXPAND | wxALL, 0);
 
   Bind(wxEVT_CLOSE_WINDOW, &SummaryFrame::OnClose, this);
@@ -173,34 +244,25 @@ SummaryFrame::SummaryFrame(wxWindow* parent) : wxFrame(parent, wxID_ANY, "Projec
 }
 
 void SummaryFrame::setTagMap(const ragtag::TagMap& tag_map) {
-  tag_map_ = tag_map;
+  // Carry check marks over by path so that an innocent act like changing one tag on a file doesn't
+  // deselect every single file in the project. (File IDs aren't comparable across tag maps.)
+  const auto previously_checked_paths = summary_model_.getAllCheckedPaths();
+
+  tag_map_ = std::make_shared<const ragtag::TagMap>(tag_map);
+  summary_model_.setTagMap(tag_map_.get());
+  summary_model_.checkPaths(previously_checked_paths);
 }
 
 void SummaryFrame::refreshFileList()
 {
   lc_summary_->Freeze();
 
-  // Cache items that have checkboxes marked so that we can re-check the relevant items after
-  // populating the list. We do this as a convenience for our users so that an innocent act like
-  // changing one tag on a file doesn't deselect every single file in the project.
-  // Note: We do this by path rather than matching text displayed in the control just in case two
-  // different paths evaluate to the same wxString (if that's even possible).
-  std::vector<ragtag::path_t> previously_checked_items;
-  for (int i = 0; i < lc_summary_->GetItemCount(); ++i) {
-    if (lc_summary_->IsItemChecked(i)) {
-      const auto path = getPathForItemIndex(i);
-      if (path.has_value()) {
-        previously_checked_items.push_back(*path);
-      }
-    }
-  }
-
   // Determine whether we need to redraw columns. We do this by seeing whether the tags in the tag
   // map we're tasked with displaying are different from the tags currently displayed in the table.
   // By only re-creating the columns when needed, we preserve any custom width modifications the
   // user has made to them--a nice little quality of life feature.
   bool redraw_columns = false;
-  const auto all_tags = tag_map_.getAllTags();
+  const auto all_tags = tag_map_->getAllTags();
   // +2 accounts for Path and Rating columns.
   if (lc_summary_->GetColumnCount() != all_tags.size() + 2) {
     redraw_columns = true;
@@ -246,56 +308,150 @@ void SummaryFrame::refreshFileList()
     lc_summary_->Thaw();
   }
 
-  lc_summary_->DeleteAllItems();
-  file_paths_ = tag_map_.selectFiles(getOverallRuleFromFilterUi());
-  for (int i = 0; i < file_paths_.size(); ++i) {
-    // Supply empty string, which will be replaced later by populateAndEllipsizePathColumn().
-    lc_summary_->InsertItem(i, wxEmptyString);
-     
-    // Associate user data with the wxListCtrl item by giving it a pointer--in this case, to the
-    // path we've cached within file_paths_. (It's not ideal, but we play along.)
-    lc_summary_->SetItemPtrData(i, reinterpret_cast<wxUIntPtr>(&file_paths_[i]));
-
-    // Show rating...
-    auto rating = tag_map_.getRating(file_paths_[i]);
-    lc_summary_->SetItem(i, 1, rating.has_value() ?
-      RagTagUtil::getStarTextForRating(*rating) : wxString("--"));
-    // Show state of tags...
-    for (int j = 0; j < all_tags.size(); ++j) {  
-      wxString tag_state_glyph = wxEmptyString;
-      auto tag_setting = tag_map_.getTagSetting(file_paths_[i], all_tags[j].first);
-      if (!tag_setting.has_value() || *tag_setting == ragtag::TagSetting::UNCOMMITTED) {
-        tag_state_glyph = RagTagUtil::GLYPH_UNCOMMITTED;
-      }
-      else if (*tag_setting == ragtag::TagSetting::YES) {
-        tag_state_glyph = RagTagUtil::GLYPH_CHECKED;
-      }
-      else if (*tag_setting == ragtag::TagSetting::NO) {
-        tag_state_glyph = RagTagUtil::GLYPH_UNCHECKED;
+  // Anything scheduled earlier would only overwrite what we're about to show.
+  file_list_scheduler_.cancel();
+  const auto rating_histogram = std::make_shared<ragtag::RatingHistogram>(RagTagUtil::MAX_STARS);
+  ragtag::FilterPlan filter_plan = buildFilterPlan(rating_histogram);
+  const auto file_ids = filter_plan.run(tag_map_->getAllFileIds());
+  prefetchFileStatuses(*tag_map_, file_ids);
+  rating_histogram_ = *rating_histogram;
+  showFilteredFiles(file_ids, filter_plan.describeStageStats());
+
+  lc_summary_->Thaw();
+  Refresh();
+}
+
+void SummaryFrame::scheduleFileListRefresh()
+{
+  // The controls are read here, on the UI thread. The worker sees only the resulting plan and a
+  // snapshot of the tag map, which stays alive for as long as the job holds onto it.
+  // The histogram is filled in by the worker as the plan runs and belongs to this job alone.
+  const auto rating_histogram = std::make_shared<ragtag::RatingHistogram>(RagTagUtil::MAX_STARS);
+  const auto filter_plan = std::make_shared<ragtag::FilterPlan>(buildFilterPlan(rating_histogram));
+  const auto tag_map = tag_map_;
+  const size_t screenful = static_cast<size_t>(std::max(lc_summary_->GetCountPerPage(), 1));
+  file_list_scheduler_.schedule([this, filter_plan, rating_histogram, tag_map, screenful](
+    const ragtag::RecomputeScheduler::cancellation_t& is_cancelled) {
+      // List the directories of the listed files as they're found so that drawing the rows
+      // doesn't have to.
+      size_t num_prefetched = 0;
+      const auto prefetch_new_matches = [&](const std::vector<ragtag::file_id_t>& matches) {
+        prefetchFileStatuses(*tag_map,
+          std::vector<ragtag::file_id_t>(matches.begin() + num_prefetched, matches.end()));
+        num_prefetched = matches.size();
+        };
+
+      // Show matches as they're found so that a filter matching a huge number of files doesn't
+      // leave the list empty until the very last one is found.
+      auto file_ids = filter_plan->runProgressively(tag_map->getAllFileIds(), is_cancelled,
+        [&](const std::vector<ragtag::file_id_t>& matches) {
+          prefetch_new_matches(matches);
+          file_list_scheduler_.publish([this, tag_map, matches]() {
+            if (tag_map != tag_map_) {
+              return;
+            }
+            lc_summary_->Freeze();
+            showFilteredFiles(matches, {}, false);
+            lc_summary_->Thaw();
+            });
+        }, screenful);
+      if (!file_ids.has_value()) {
+        return ragtag::RecomputeScheduler::commit_t{};
       }
 
-      // Offset edited column because of Path and Rating columns taking indices 0 and 1.
-      lc_summary_->SetItem(i, j + FIRST_TAG_COLUMN_INDEX, tag_state_glyph, -1);
-    }
+      prefetch_new_matches(*file_ids);
+      return ragtag::RecomputeScheduler::commit_t([this, tag_map, file_ids = std::move(*file_ids),
+        stage_stats = filter_plan->describeStageStats(), rating_histogram]() {
+          if (tag_map != tag_map_) {
+            // The project changed while we were busy, so these IDs no longer mean anything.
+            return;
+          }
+          rating_histogram_ = *rating_histogram;
+          lc_summary_->Freeze();
+          showFilteredFiles(file_ids, stage_stats);
+          lc_summary_->Thaw();
+        });
+    });
+}
 
-    // Check the item if it was previously checked.
-    // This is O(m*n) time, but we're dealing with small lists and very fast vector operations.
-    for (int j = 0; j < previously_checked_items.size(); ++j) {
-      if (file_paths_[i] == previously_checked_items[j]) {
-        lc_summary_->CheckItem(i, true);
-        break;
+void SummaryFrame::commitFileListRefresh()
+{
+  file_list_scheduler_.commitFinished();
+}
+
+void SummaryFrame::showFilteredFiles(const std::vector<ragtag::file_id_t>& file_ids,
+  const std::string& stage_stats, const bool is_complete)
+{
+  summary_model_.setRows(file_ids);
+  lc_summary_->refreshRows();
+
+  st_filtered_file_count_->SetLabel("Current filters: "
+    + std::to_string(summary_model_.numRows()) + "/" + std::to_string(tag_map_->numFiles())
+    + " project files" + (is_complete ? "" : " (filtering...)"));
+  // Hovering over the count shows how each filter contributed, for diagnosing slow refreshes.
+  st_filtered_file_count_->SetToolTip(stage_stats);
+  if (is_complete) {
+    updateTagFacetCounts(file_ids);
+    updateRatingCounts();
+  }
+  updateCopyButtonForSelections();
+}
+
+void SummaryFrame::updateTagFacetCounts(const std::vector<ragtag::file_id_t>& file_ids)
+{
+  // When no file is filtered out, the counts the tag map keeps for the whole project apply as is.
+  std::map<ragtag::tag_t, ragtag::TagSettingCounts> counts;
+  if (static_cast<int>(file_ids.size()) == tag_map_->numFiles()) {
+    for (const auto& tag : tags_) {
+      const auto tag_counts = tag_map_->getTagSettingCounts(tag);
+      if (tag_counts.has_value()) {
+        counts.emplace(tag, *tag_counts);
       }
     }
   }
+  else {
+    counts = tag_map_->countTagSettings(file_ids);
+  }
+  // Relabeling items can disturb the selection on some platforms, so restore it afterward.
+  const int selection_index = dd_tag_selection_->GetSelection();
+  for (int i = 0; i < tags_.size(); ++i) {
+    const auto counts_it = counts.find(tags_[i]);
+    if (counts_it == counts.end()) {
+      continue;
+    }
+    // Offset by 1 to account for "(None)".
+    dd_tag_selection_->SetString(i + 1, wxString(tags_[i]) + " ("
+      + std::to_string(counts_it->second.yes) + " yes, "
+      + std::to_string(counts_it->second.no) + " no, "
+      + std::to_string(counts_it->second.uncommitted) + " uncommitted)");
+  }
+  dd_tag_selection_->SetSelection(selection_index);
+}
 
-  populateAndEllipsizePathColumn();
-
-  st_filtered_file_count_->SetLabel("Current filters: " + std::to_string(file_paths_.size()) + "/" +
-    std::to_string(tag_map_.numFiles()) + " project files");
-  updateCopyButtonForSelections();
+void SummaryFrame::updateRatingCounts()
+{
+  const int num_rated = cb_show_rated_->IsChecked() ? rating_histogram_.countRated(
+    sl_min_rating_->GetValue(), sl_max_rating_->GetValue()) : 0;
+  const int num_unrated = cb_show_unrated_->IsChecked() ? rating_histogram_.numUnrated() : 0;
+  // The histogram is tallied before the presence filter runs, so it can't account for it.
+  const bool is_presence_filtered = cb_show_present_->IsChecked() != cb_show_missing_->IsChecked();
+  st_rating_counts_->SetLabel("Matching: " + std::to_string(num_rated) + " rated, "
+    + std::to_string(num_unrated) + " unrated"
+    + (is_presence_filtered ? " (before presence filter)" : ""));
+}
 
-  lc_summary_->Thaw();
-  Refresh();
+void SummaryFrame::prefetchFileStatuses(const ragtag::TagMap& tag_map,
+  const std::vector<ragtag::file_id_t>& file_ids)
+{
+  std::vector<ragtag::path_t> paths;
+  paths.reserve(file_ids.size());
+  for (const auto id : file_ids) {
+    const auto path = tag_map.getFilePath(id);
+    if (path.has_value()) {
+      paths.push_back(*path);
+    }
+  }
+  file_status_cache_.prefetch(paths);
 }
 
 void SummaryFrame::refreshTagFilter()
@@ -307,7 +463,8 @@ void SummaryFrame::refreshTagFilter()
     last_tag_selection = tags_[last_tag_selection_index - 1];
   }
 
-  const auto all_tags = tag_map_.getAllTags();
+  const auto last_tags = tags_;
+  const auto all_tags = tag_map_->getAllTags();
   tags_.resize(all_tags.size());
   for (int i = 0; i < all_tags.size(); ++i) {
     tags_[i] = all_tags[i].first;
@@ -325,76 +482,171 @@ void SummaryFrame::refreshTagFilter()
     }
   }
   dd_tag_selection_->SetSelection(current_tag_selection_index);
+
+  // Rebuild the multi-tag filter's controls, keeping the constraint of every tag that survives.
+  std::map<ragtag::tag_t, int> last_constraints;
+  for (int i = 0; i < ch_tag_constraints_.size(); ++i) {
+    last_constraints[last_tags[i]] = ch_tag_constraints_[i]->GetSelection();
+  }
+  sw_tag_constraints_->Freeze();
+  sw_tag_constraints_->DestroyChildren();
+  ch_tag_constraints_.clear();
+  wxSizer* sz_tag_constraints = sw_tag_constraints_->GetSizer();
+  wxArrayString constraint_options = { "Ignore", "Include", "Exclude" };
+  for (const auto& tag : tags_) {
+    wxStaticText* tag_label = new wxStaticText(sw_tag_constraints_, wxID_ANY, tag);
+    sz_tag_constraints->Add(tag_label, 0, wxALIGN_CENTER_VERTICAL | wxALL, 3);
+    wxChoice* ch_constraint = new wxChoice(sw_tag_constraints_, wxID_ANY, wxDefaultPosition,
+      wxDefaultSize, constraint_options);
+    const auto last_constraint_it = last_constraints.find(tag);
+    ch_constraint->SetSelection(last_constraint_it != last_constraints.end()
+      ? last_constraint_it->second : TAG_CONSTRAINT_IGNORE);
+    ch_constraint->Bind(wxEVT_CHOICE, &SummaryFrame::OnFilterChangeGeneric, this);
+    sz_tag_constraints->Add(ch_constraint, 0, wxALL, 3);
+    ch_tag_constraints_.push_back(ch_constraint);
+  }
+  sw_tag_constraints_->FitInside();
+  sw_tag_constraints_->Thaw();
+}
+
+void SummaryFrame::invalidateFileStatuses()
+{
+  file_status_cache_.invalidate();
 }
 
 void SummaryFrame::highlightFileIfPresent(const ragtag::path_t& path_to_highlight)
 {
-  for (int i = 0; i < lc_summary_->GetItemCount(); ++i) {
-    const auto path_at_entry = getPathForItemIndex(i);
-    if (path_at_entry.has_value() && *path_at_entry == path_to_highlight) {
-      lc_summary_->SetItemState(i, wxLIST_STATE_SELECTED, wxLIST_STATE_SELECTED);
-    }
-    else {
-      lc_summary_->SetItemState(i, 0, wxLIST_STATE_SELECTED);
-    }
+  // The list is single-selection, so at most one item needs to be deselected.
+  const long previous_selection = lc_summary_->GetFirstSelected();
+  if (previous_selection != -1) {
+    lc_summary_->Select(previous_selection, false);
+  }
+
+  const auto id = tag_map_->getFileId(path_to_highlight);
+  if (!id.has_value()) {
+    return;
+  }
+  const auto index = summary_model_.findIndex(*id);
+  if (index.has_value()) {
+    lc_summary_->Select(*index, true);
   }
 }
 
-ragtag::TagMap::file_qualifier_t SummaryFrame::getRuleFromRatingFilterUi()
+ragtag::FilterPlan SummaryFrame::buildFilterPlan(
+  std::shared_ptr<ragtag::RatingHistogram> rating_histogram)
 {
+  // Relative costs of evaluating each filter for one file. Only the order matters. The rating
+  // filter comes after the other tag map filters so that it can tally the files they accept, but
+  // the presence filter stays last so that the filesystem is only consulted for files that every
+  // other filter accepts.
+  static const double RATING_FILTER_COST = 10.0;
+  static const double TAG_FILTER_COST = 2.0;
+  static const double MULTI_TAG_FILTER_COST = 0.5;
+  static const double PATH_FILTER_COST = 0.5;
+  static const double PRESENCE_FILTER_COST = 1000.0;
+
+  ragtag::FilterPlan plan;
+  // Stages may run on a worker thread, so they hold onto the current snapshot of the tag map
+  // rather than reading `tag_map_`, which may be replaced in the meantime.
+  const auto tag_map = tag_map_;
+
   const int min_rating = sl_min_rating_->GetValue();
   const int max_rating = sl_max_rating_->GetValue();
   const bool show_rated = cb_show_rated_->IsChecked();
   const bool show_unrated = cb_show_unrated_->IsChecked();
-  return [=](const ragtag::TagMap::FileInfo& info) {
-    if (info.rating.has_value()) {
-      return show_rated && *info.rating >= min_rating && *info.rating <= max_rating;
-    }
-    else {
+  const bool accepts_all_ratings = show_rated && show_unrated
+    && min_rating <= sl_min_rating_->GetMin() && max_rating >= sl_max_rating_->GetMax();
+  if (!accepts_all_ratings || rating_histogram != nullptr) {
+    plan.addStage("Rating", RATING_FILTER_COST, [=](ragtag::file_id_t id) {
+      if (accepts_all_ratings) {
+        return true;
+      }
+      const auto rating = tag_map->getRating(id);
+      if (rating.has_value()) {
+        return show_rated && *rating >= min_rating && *rating <= max_rating;
+      }
       return show_unrated;
-    }
-    };
-}
-
-ragtag::TagMap::file_qualifier_t SummaryFrame::getRuleFromTagFilterUi()
-{
-  const int selection_index = dd_tag_selection_->GetSelection();
-  if (selection_index == 0) {
-    // The selected item is the one representing no filter, so include all the files.
-    return [](const ragtag::TagMap::FileInfo& info) {return true;};
+      }, [=](const std::vector<ragtag::file_id_t>& ids) {
+        if (rating_histogram != nullptr) {
+          for (const auto id : ids) {
+            rating_histogram->add(tag_map->getRating(id));
+          }
+        }
+      });
   }
 
-  // -1 accounts for first option being the default "no filter" option, which isn't tied to a tag.
-  const ragtag::tag_t tag = tags_[dd_tag_selection_->GetSelection() - 1];
+  // Index 0 represents no filter and isn't tied to a tag.
+  const int selection_index = dd_tag_selection_->GetSelection();
   const bool include_yes = cb_show_yes_->IsChecked();
   const bool include_no = cb_show_no_->IsChecked();
   const bool include_uncommitted = cb_show_uncommitted_->IsChecked();
-  return [=](const ragtag::TagMap::FileInfo& info) {
-    const ragtag::TagSetting setting = info.f_tag_setting(tag);
-    return setting == ragtag::TagSetting::YES && include_yes ||
-      setting == ragtag::TagSetting::NO && include_no ||
-      setting == ragtag::TagSetting::UNCOMMITTED && include_uncommitted;
-    };
-}
+  if (selection_index > 0 && !(include_yes && include_no && include_uncommitted)) {
+    // -1 accounts for first option being the default "no filter" option.
+    const ragtag::tag_t tag = tags_[selection_index - 1];
+    plan.addStage("Tag", TAG_FILTER_COST, [=](ragtag::file_id_t id) {
+      const auto setting = tag_map->getTagSetting(id, tag)
+        .value_or(ragtag::TagSetting::UNCOMMITTED);
+      return setting == ragtag::TagSetting::YES && include_yes ||
+        setting == ragtag::TagSetting::NO && include_no ||
+        setting == ragtag::TagSetting::UNCOMMITTED && include_uncommitted;
+      });
+  }
+
+  const std::vector<ragtag::TagConstraint> tag_constraints = getTagConstraints();
+  if (!tag_constraints.empty()) {
+    // All constraints are combined at once through the tag map's index, leaving only a bit test
+    // per file.
+    const auto matches = std::make_shared<ragtag::FileSelection>();
+    matches->reset(tag_map->fileIdLimit());
+    matches->selectAll(tag_map->selectFileIdsByTags(tag_constraints,
+      ch_tag_match_mode_->GetSelection() != TAG_MATCH_ANY));
+    plan.addStage("Tags", MULTI_TAG_FILTER_COST, [matches](ragtag::file_id_t id) {
+      return matches->isSelected(id);
+      });
+  }
+
+  const std::wstring path_substring = tc_path_search_->GetValue().ToStdWstring();
+  if (!path_substring.empty()) {
+    // The tag map's path index finds the matches up front, leaving only a bit test per file.
+    const auto matches = std::make_shared<ragtag::FileSelection>();
+    matches->reset(tag_map->fileIdLimit());
+    matches->selectAll(tag_map->selectFileIdsByPath(path_substring));
+    plan.addStage("Path", PATH_FILTER_COST, [matches](ragtag::file_id_t id) {
+      return matches->isSelected(id);
+      });
+  }
 
-ragtag::TagMap::file_qualifier_t SummaryFrame::getRuleFromPresenceFilterUi()
-{
   const bool include_present = cb_show_present_->IsChecked();
   const bool include_missing = cb_show_missing_->IsChecked();
-  return [=](const ragtag::TagMap::FileInfo& info) {
-    const bool is_file_present = std::filesystem::exists(info.path);
-    return include_present && is_file_present || include_missing && !is_file_present;
-  };
+  if (include_present != include_missing) {
+    // Only the files that survive the other filters are checked, and their directories are listed
+    // together up front rather than one file at a time.
+    plan.addStage("Presence", PRESENCE_FILTER_COST, [=, this](ragtag::file_id_t id) {
+      const auto path = tag_map->getFilePath(id);
+      return path.has_value() && file_status_cache_.isPresent(*path) == include_present;
+      }, [=, this](const std::vector<ragtag::file_id_t>& ids) {
+        prefetchFileStatuses(*tag_map, ids);
+      });
+  }
+  else if (!include_present) {
+    // Neither present nor missing files are wanted, which needn't involve the filesystem.
+    plan.addStage("Presence", 0.0, [](ragtag::file_id_t) { return false; });
+  }
+
+  return plan;
 }
 
-ragtag::TagMap::file_qualifier_t SummaryFrame::getOverallRuleFromFilterUi()
+std::vector<ragtag::TagConstraint> SummaryFrame::getTagConstraints() const
 {
-  // Composes the rating filter and the tag filter (but can be expanded for other filters as we
-  // implement them).
-  return [=](const ragtag::TagMap::FileInfo& info) {
-    return getRuleFromRatingFilterUi()(info) && getRuleFromTagFilterUi()(info)
-      && getRuleFromPresenceFilterUi()(info);
-    };
+  std::vector<ragtag::TagConstraint> tag_constraints;
+  for (int i = 0; i < ch_tag_constraints_.size(); ++i) {
+    const int constraint = ch_tag_constraints_[i]->GetSelection();
+    if (constraint == TAG_CONSTRAINT_INCLUDE || constraint == TAG_CONSTRAINT_EXCLUDE) {
+      tag_constraints.push_back({ .tag = tags_[i],
+        .has_tag = constraint == TAG_CONSTRAINT_INCLUDE });
+    }
+  }
+  return tag_constraints;
 }
 
 std::optional<ragtag::path_t> SummaryFrame::promptCopyDestination()
@@ -409,6 +661,70 @@ std::optional<ragtag::path_t> SummaryFrame::promptCopyDestination()
   return ragtag::path_t(wx_path.ToStdWstring());
 }
 
+bool SummaryFrame::showCopyProgress(const wxString& title,
+  const std::function<bool(std::chrono::milliseconds)>& wait,
+  const std::function<ragtag::CopyProgress()>& get_progress)
+{
+  // Progress is tracked in bytes, scaled to fit the dialog's integer range.
+  static const int PROGRESS_RANGE = 1000;
+  static const std::chrono::milliseconds PROGRESS_INTERVAL{ 100 };
+
+  wxProgressDialog pd(title, "Beginning...\r", PROGRESS_RANGE, this,
+    wxPD_APP_MODAL | wxPD_AUTO_HIDE | wxPD_CAN_ABORT);
+  while (!wait(PROGRESS_INTERVAL)) {
+    const ragtag::CopyProgress progress = get_progress();
+    // Stop short of the full range, which would hide the dialog before the work is done.
+    const int value = progress.bytes_total == 0 ? 0 : static_cast<int>(std::min<std::uintmax_t>(
+      PROGRESS_RANGE - 1, progress.bytes_done * PROGRESS_RANGE / progress.bytes_total));
+    if (!pd.Update(value, L"Finished " + std::to_wstring(progress.files_done) + L" of "
+      + std::to_wstring(progress.files_total) + L" files\r("
+      + std::to_wstring(progress.bytes_done >> 20) + L" of "
+      + std::to_wstring(progress.bytes_total >> 20) + L" MB)...")) {
+      return false;
+    }
+  }
+  pd.Update(PROGRESS_RANGE);
+  return true;
+}
+
+std::optional<ragtag::ExportNaming> SummaryFrame::promptExportNaming(
+  const std::vector<ragtag::path_t>& files)
+{
+  const int num_collisions = ragtag::ExportNamer::countNameCollisions(files);
+  if (num_collisions == 0) {
+    return ragtag::ExportNaming::NUMBERED;
+  }
+
+  // Options are listed in the order of the ExportNaming enumerators.
+  const wxArrayString naming_options = {
+    "Number them, as in \"clip (2).mp4\"",
+    "Prefix them with their folders' names, as in \"Beach_clip.mp4\"",
+    "Add a short code identifying each file, as in \"clip_3fa2b1c0.mp4\"",
+    "Recreate the folders they come from inside the destination"
+  };
+  wxSingleChoiceDialog dialog(this, std::to_string(num_collisions) + " of the selected files "
+    "share their names with other selected files. How should they be told apart?",
+    "Files Share Names", naming_options);
+  if (dialog.ShowModal() != wxID_OK) {
+    return {};
+  }
+  return static_cast<ragtag::ExportNaming>(dialog.GetSelection());
+}
+
+ragtag::CopyMode SummaryFrame::getSelectedCopyMode() const
+{
+  switch (ch_copy_mode_->GetSelection()) {
+  case COPY_MODE_REFLINK:
+    return ragtag::CopyMode::REFLINK;
+  case COPY_MODE_HARD_LINK:
+    return ragtag::CopyMode::HARD_LINK;
+  case COPY_MODE_SYMBOLIC_LINK:
+    return ragtag::CopyMode::SYMBOLIC_LINK;
+  default:
+    return ragtag::CopyMode::COPY;
+  }
+}
+
 void SummaryFrame::updateRatingFilterEnabledState() {
   if (cb_show_rated_->IsChecked()) {
     sl_min_rating_->Enable();
@@ -422,21 +738,23 @@ void SummaryFrame::updateRatingFilterEnabledState() {
 
 void SummaryFrame::updateCopyButtonForSelections()
 {
-  const int selected_item_count = getPathsOfSelectedFiles().size();
-  if (selected_item_count == 0) {
+  if (summary_model_.numChecked() == 0) {
     b_delete_files_->Disable();
     b_remove_from_project_->Disable();
     b_copy_selections_->Disable();
+    b_export_zip_->Disable();
   }
   else {
     b_delete_files_->Enable();
     b_remove_from_project_->Enable();
     b_copy_selections_->Enable();
+    b_export_zip_->Enable();
   }
 }
 
 void SummaryFrame::resetFilters()
 {
+  tc_path_search_->ChangeValue(wxEmptyString);
   sl_min_rating_->SetValue(0);
   sl_max_rating_->SetValue(5);
   cb_show_rated_->SetValue(wxCHK_CHECKED);
@@ -445,55 +763,22 @@ void SummaryFrame::resetFilters()
   cb_show_yes_->SetValue(wxCHK_CHECKED);
   cb_show_no_->SetValue(wxCHK_UNCHECKED);
   cb_show_uncommitted_->SetValue(wxCHK_UNCHECKED);
+  ch_tag_match_mode_->SetSelection(TAG_MATCH_ALL);
+  for (wxChoice* ch_constraint : ch_tag_constraints_) {
+    ch_constraint->SetSelection(TAG_CONSTRAINT_IGNORE);
+  }
   cb_show_present_->SetValue(wxCHK_CHECKED);
   cb_show_missing_->SetValue(wxCHK_CHECKED);
 }
 
-void SummaryFrame::populateAndEllipsizePathColumn()
-{
-  for (int i = 0; i < lc_summary_->GetItemCount(); ++i) {
-    const auto path = getPathForItemIndex(i);
-    if (!path.has_value()) {
-      // Really shouldn't happen.
-      continue;
-    }
-
-    std::wstring path_displayed = path->wstring();
-    if (!std::filesystem::exists(*path)) {
-      path_displayed.append(L" [???]");
-    }
-
-    const auto ellipsized = lc_summary_->Ellipsize(path_displayed, wxWindowDC(lc_summary_),
-      wxELLIPSIZE_START, lc_summary_->GetColumnWidth(PATH_COLUMN_INDEX) - PATH_EXTENT_MARGIN_PX);
-    lc_summary_->SetItem(i, PATH_COLUMN_INDEX, ellipsized);
-  }
-}
-
 std::vector<ragtag::path_t> SummaryFrame::getPathsOfSelectedFiles() const
 {
-  std::vector<ragtag::path_t> returning;
-  for (int i = 0; i < lc_summary_->GetItemCount(); ++i) {
-    if (lc_summary_->IsItemChecked(i)) {
-      const auto path = getPathForItemIndex(i);
-      if (path.has_value()) {
-        returning.push_back(*path);
-      }
-    }
-  }
-  return returning;
+  return summary_model_.getCheckedPaths();
 }
 
 std::optional<ragtag::path_t> SummaryFrame::getPathForItemIndex(int index) const
 {
-  // This isn't as simple as invoking file_paths_[i], since list control indices shift around during
-  // sorting operations. Thankfully, the item data (where we placed a pointer to the actual path)
-  // moves along with the item.
-  wxUIntPtr p_data_nominal = lc_summary_->GetItemData(index);
-  if (p_data_nominal == 0) {
-    return {};
-  }
-
-  return *reinterpret_cast<ragtag::path_t*>(p_data_nominal);
+  return summary_model_.getPathAt(index);
 }
 
 void SummaryFrame::OnClickHeading(wxListEvent& event)
@@ -504,51 +789,54 @@ void SummaryFrame::OnClickHeading(wxListEvent& event)
     return;
   }
 
-  // This is a pain, but because wxListCtrl's sort operation requires a free-floating function
-  // (not a member function that has access to object internals), we have to manually supply it a
-  // snapshot of the information we would like to sort. We do this by sending it a pointer to an
-  // instance of a helper struct we populate with information the sorting function requires.
-  SortHelper sort_helper;
-  sort_helper.p_tag_map = &tag_map_;
-
   // GetSortIndicator() returns the column in which the current sort indicator is shown, or -1.
   // When a new column is clicked, we prefer to sort descending first (except for text), which
   // is the opposite of the default behavior.
-  bool ascending = column == PATH_COLUMN_INDEX;
+  bool ascending = column == ragtag::SummaryModel::PATH_COLUMN;
   if (lc_summary_->GetSortIndicator() == column) {
     // Same column is re-clicked.
     ascending = lc_summary_->GetUpdatedAscendingSortIndicator(column);
   }
-  sort_helper.sort_ascending = ascending;
 
-  if (column == PATH_COLUMN_INDEX) {
-    lc_summary_->SortItems(&SummaryFrame::pathSort, reinterpret_cast<wxIntPtr>(&sort_helper));
-  }
-  else if (column == RATING_COLUMN_INDEX) {
-    lc_summary_->SortItems(&SummaryFrame::ratingSort, reinterpret_cast<wxIntPtr>(&sort_helper));
-  }
-  else if (column >= FIRST_TAG_COLUMN_INDEX) {
-    // TODO: Consider caching all tags when refreshing so we don't need to re-procure the list here.
-    const auto all_tags = tag_map_.getAllTags();
-    sort_helper.tag = all_tags[column - FIRST_TAG_COLUMN_INDEX].first;
-    lc_summary_->SortItems(&SummaryFrame::tagSort, reinterpret_cast<wxIntPtr>(&sort_helper));
+  // Keep the selected file selected even though its row will likely move.
+  std::optional<ragtag::file_id_t> selected_id;
+  const long selected_index = lc_summary_->GetFirstSelected();
+  if (selected_index != -1) {
+    selected_id = summary_model_.getFileIdAt(selected_index);
+    lc_summary_->Select(selected_index, false);
   }
 
+  summary_model_.sortByColumn(column, ascending);
   lc_summary_->ShowSortIndicator(column, ascending);
+  lc_summary_->refreshRows();
+
+  if (selected_id.has_value()) {
+    const auto index = summary_model_.findIndex(*selected_id);
+    if (index.has_value()) {
+      lc_summary_->Select(*index, true);
+      lc_summary_->EnsureVisible(*index);
+    }
+  }
 }
 
 void SummaryFrame::OnResizeColumn(wxListEvent& event)
 {
-  populateAndEllipsizePathColumn();
+  // Paths are ellipsized as they're drawn, so redrawing is enough to fit them to the new width.
+  lc_summary_->Refresh();
 }
 
 void SummaryFrame::OnFileChecked(wxListEvent& event)
 {
+  // The list is virtual, so the check state only persists if we record it.
+  summary_model_.setChecked(event.GetIndex(), true);
+  lc_summary_->RefreshItem(event.GetIndex());
   updateCopyButtonForSelections();
 }
 
 void SummaryFrame::OnFileUnchecked(wxListEvent& event)
 {
+  summary_model_.setChecked(event.GetIndex(), false);
+  lc_summary_->RefreshItem(event.GetIndex());
   updateCopyButtonForSelections();
 }
 
@@ -566,48 +854,128 @@ void SummaryFrame::OnFileFocused(wxListEvent& event)
 
 void SummaryFrame::OnFilterChangeGeneric(wxCommandEvent& event)
 {
-  refreshFileList();
+  scheduleFileListRefresh();
 }
 
 void SummaryFrame::OnMinSliderMove(wxCommandEvent& event) {
   if (sl_min_rating_->GetValue() > sl_max_rating_->GetValue()) {
     sl_max_rating_->SetValue(sl_min_rating_->GetValue());
   }
-  refreshFileList();
+  updateRatingCounts();
+  if (!is_dragging_rating_slider_) {
+    scheduleFileListRefresh();
+  }
 }
 
 void SummaryFrame::OnMaxSliderMove(wxCommandEvent& event) {
   if (sl_max_rating_->GetValue() < sl_min_rating_->GetValue()) {
     sl_min_rating_->SetValue(sl_max_rating_->GetValue());
   }
-  refreshFileList();
+  updateRatingCounts();
+  if (!is_dragging_rating_slider_) {
+    scheduleFileListRefresh();
+  }
+}
+
+void SummaryFrame::OnRatingSliderDrag(wxScrollEvent& event) {
+  is_dragging_rating_slider_ = true;
+  event.Skip();  // Let the slider follow up with wxEVT_SLIDER.
+}
+
+void SummaryFrame::OnRatingSliderRelease(wxScrollEvent& event) {
+  is_dragging_rating_slider_ = false;
+  scheduleFileListRefresh();
+  event.Skip();
 }
 
 void SummaryFrame::OnClickShowRated(wxCommandEvent& event)
 {
   updateRatingFilterEnabledState();
-  refreshFileList();
+  scheduleFileListRefresh();
 }
 
 void SummaryFrame::OnResetFilters(wxCommandEvent& event)
 {
   resetFilters();
   updateRatingFilterEnabledState();
-  refreshFileList();
+  scheduleFileListRefresh();
 }
 
 void SummaryFrame::OnSelectAllFiles(wxCommandEvent& event)
 {
-  for (int i = 0; i < lc_summary_->GetItemCount(); ++i) {
-    lc_summary_->CheckItem(i, true);
-  }
+  summary_model_.setAllChecked(true);
+  lc_summary_->Refresh();
+  updateCopyButtonForSelections();
 }
 
 void SummaryFrame::OnDeselectAllFiles(wxCommandEvent& event)
 {
-  for (int i = 0; i < lc_summary_->GetItemCount(); ++i) {
-    lc_summary_->CheckItem(i, false);
+  summary_model_.setAllChecked(false);
+  lc_summary_->Refresh();
+  updateCopyButtonForSelections();
+}
+
+void SummaryFrame::OnSelectRandomFiles(wxCommandEvent& event)
+{
+  static const long DEFAULT_SAMPLE_SIZE = 20;
+
+  // The listing may still be filling in, so the project bounds the size of the sample. Sampling
+  // selects every qualifying file if fewer qualify.
+  const auto tag_map = tag_map_;
+  const long num_files = tag_map->numFiles();
+  if (num_files == 0) {
+    return;
+  }
+  const long sample_size = wxGetNumberFromUser(
+    "Select files at random from those passing the current filters.", "Number of files:",
+    "Select Random Files", std::min(DEFAULT_SAMPLE_SIZE, num_files), 1, num_files, this);
+  if (sample_size < 0) {
+    // User canceled the dialog.
+    return;
+  }
+
+  // Offer a fresh seed, but show the last one so that a selection can be repeated.
+  std::random_device random_device;
+  const std::uint64_t fresh_seed = (static_cast<std::uint64_t>(random_device()) << 32)
+    | random_device();
+  const wxString seed_message = last_random_seed_.has_value()
+    ? wxString::Format("Seed (the last selection used %llu):",
+      static_cast<unsigned long long>(*last_random_seed_))
+    : wxString("Seed (enter an earlier seed to repeat its selection):");
+  wxString seed_text = wxGetTextFromUser(seed_message, "Select Random Files",
+    wxString::Format("%llu", static_cast<unsigned long long>(fresh_seed)), this);
+  if (seed_text.empty()) {
+    // User canceled the dialog.
+    return;
+  }
+  unsigned long long seed = 0;
+  if (!seed_text.Trim().Trim(false).ToULongLong(&seed)) {
+    wxMessageDialog dialog(this, "The seed must be a whole number from 0 to "
+      + std::to_string(std::numeric_limits<std::uint64_t>::max()) + ".", "Invalid Seed",
+      wxOK | wxCENTER | wxICON_WARNING);
+    dialog.ShowModal();
+    return;
   }
+  last_random_seed_ = seed;
+
+  // Files are sampled from the tag map rather than from the listing's rows, so that a seed selects
+  // the same files however the listing is sorted and however far a refresh has progressed. Each
+  // active filter adds one stage to the plan, so a lone stage alongside tag constraints means the
+  // constraints are the only filter. Those can be sampled by rank without visiting every file.
+  const ragtag::FilterPlan plan = buildFilterPlan(nullptr);
+  const std::vector<ragtag::TagConstraint> tag_constraints = getTagConstraints();
+  const std::vector<ragtag::file_id_t> sample = !tag_constraints.empty() && plan.numStages() == 1
+    ? tag_map->sampleFileIdsByTags(tag_constraints,
+      ch_tag_match_mode_->GetSelection() != TAG_MATCH_ANY, static_cast<int>(sample_size), seed)
+    : tag_map->sampleFileIds([&plan](const ragtag::TagMap::FileInfo& info) {
+      return plan.accepts(info.id);
+      }, static_cast<int>(sample_size), seed);
+
+  // Files that the listing doesn't show yet are checked as soon as it does.
+  summary_model_.setAllChecked(false);
+  summary_model_.checkFileIds(sample);
+  lc_summary_->Refresh();
+  updateCopyButtonForSelections();
 }
 
 void SummaryFrame::OnCopySelections(wxCommandEvent& event)
@@ -628,66 +996,198 @@ void SummaryFrame::OnCopySelections(wxCommandEvent& event)
     return;
   }
 
-  int num_files_successfully_copied = 0;
-  std::vector<ragtag::path_t> uncopied_files;
-  bool user_canceled = false;
-  // Carriage return after "copy..." prepare enough space for the filename during the primary loop.
-  // TODO: Even this isn't perfect, because long filenames with spaces can require additional lines.
-  // Figure out a way around this, perhaps by manually ellipsizing?
-  wxProgressDialog pd("Copying Selected Files", "Beginning copy...\r", files_to_copy.size(), this,
-    wxPD_APP_MODAL | wxPD_AUTO_HIDE | wxPD_CAN_ABORT);
-  for (int i = 0; i < files_to_copy.size(); ++i) {
-    const auto& file = files_to_copy[i];
-
-    if (!pd.Update(i, L"Copying\r'" + file.wstring() + L"'...")) {
-      // User canceled copy operation.
-      user_canceled = true;
-      break;
-    }
-
-    // TODO: Somehow prompt whether we'd like to overwrite files.
-    bool success = std::filesystem::copy_file(file, *directory / file.filename(),
-      std::filesystem::copy_options::skip_existing);
-    if (success) {
-      ++num_files_successfully_copied;
-    }
-    else {
-      uncopied_files.push_back(file);
-    }
+  const auto naming = promptExportNaming(files_to_copy);
+  if (!naming.has_value()) {
+    return;
   }
 
+  // Names are settled in memory before anything touches the disk. Files already present under a
+  // planned name are reported as conflicts by the copy itself.
+  // TODO: Somehow prompt whether we'd like to overwrite files.
+  const auto names = ragtag::ExportNamer::planNames(files_to_copy, *naming);
+  std::vector<ragtag::CopyJob> jobs;
+  jobs.reserve(files_to_copy.size());
+  for (size_t i = 0; i < files_to_copy.size(); ++i) {
+    jobs.push_back({ files_to_copy[i], *directory / names[i] });
+  }
+  ragtag::CopyOptions copy_options;
+  copy_options.mode = getSelectedCopyMode();
+  copy_options.verify = cb_verify_copies_->GetValue();
+  ragtag::CopyEngine engine(copy_options);
+  engine.start(std::move(jobs));
+
+  const bool user_canceled = !showCopyProgress("Copying Selected Files",
+    [&engine](const std::chrono::milliseconds timeout) {return engine.waitFor(timeout);},
+    [&engine]() {return engine.getProgress();});
   if (user_canceled) {
+    // Wait for files in flight to be abandoned.
+    engine.cancel();
+    engine.takeReport();
     return;
   }
-  else {
-    pd.Update(files_to_copy.size());
-  }
+  const ragtag::CopyReport report = engine.takeReport();
 
+  const int num_files_successfully_copied = report.count(ragtag::CopyOutcome::COPIED)
+    + report.count(ragtag::CopyOutcome::SKIPPED);
   const std::wstring copied_plural1 = num_files_successfully_copied == 1 ? L"file" : L"files";
   const std::wstring copied_plural2 = num_files_successfully_copied == 1 ? L"was" : L"were";
   const std::wstring selected_plural = files_to_copy.size() == 1 ? L"file" : L"files";
+  // Files that couldn't be linked as requested were copied in full, which the user should know
+  // about since the copies take up space and don't reflect later changes to the originals.
+  std::wstring fallback_details;
+  for (const auto& result : report.results) {
+    if (result.outcome == ragtag::CopyOutcome::COPIED && result.fallback_reason) {
+      fallback_details += L"\n" + result.job.source.wstring() + L" ("
+        + wxString(result.fallback_reason.message()).ToStdWstring() + L")";
+    }
+  }
+  if (!fallback_details.empty()) {
+    fallback_details = L"\n\nThese files couldn't be linked and were copied instead:"
+      + fallback_details;
+  }
+
+  std::wstring verification_details;
+  if (copy_options.verify) {
+    static const ragtag::path_t MANIFEST_NAME = L"RagTag Checksums.sfv";
+    const ragtag::path_t manifest = *directory / MANIFEST_NAME;
+    if (ragtag::CopyEngine::writeManifest(report, manifest)) {
+      verification_details = L"\n\nCopies were checked against the originals, and their "
+        L"checksums were saved to " + manifest.wstring() + L".";
+    }
+    else {
+      verification_details = L"\n\nCopies were checked against the originals, but the checksum "
+        L"manifest " + manifest.wstring() + L" couldn't be written.";
+    }
+  }
+
   if (num_files_successfully_copied == files_to_copy.size()) {
     // TODO: Make custom dialog that allows user to choose whether to show the folder to which the
     // files were copied.
     wxMessageDialog dialog(this, std::to_wstring(num_files_successfully_copied) + L" "
-      + copied_plural1 + L" " + copied_plural2 + L" copied successfully.", "Copy Success");
+      + copied_plural1 + L" " + copied_plural2 + L" copied successfully." + fallback_details
+      + verification_details, "Copy Success");
     dialog.ShowModal();
   }
   else {
-    // TODO: Be more specific about which files were not copied.
-    wxMessageDialog dialog(this, L"Not all files were copied successfully.\n\n"
+    std::vector<ragtag::path_t> conflicted_files;
+    std::wstring failed_files;
+    std::wstring mismatched_files;
+    for (const auto& result : report.results) {
+      if (result.outcome == ragtag::CopyOutcome::CONFLICTED) {
+        conflicted_files.push_back(result.job.source);
+      }
+      else if (result.outcome == ragtag::CopyOutcome::FAILED) {
+        failed_files += L"\n" + result.job.source.wstring() + L" ("
+          + wxString(result.error.message()).ToStdWstring() + L")";
+      }
+      else if (result.outcome == ragtag::CopyOutcome::MISMATCHED) {
+        mismatched_files += L"\n" + result.job.source.wstring() + L" (expected "
+          + wxString::Format("%08X", result.checksum.value_or(0)).ToStdWstring() + L", read "
+          + wxString::Format("%08X", result.destination_checksum.value_or(0)).ToStdWstring()
+          + L")";
+      }
+    }
+
+    std::wstring details;
+    if (!conflicted_files.empty()) {
+      details += L"\n\nThese files were not copied because the directory already contains a"
+        L" different file with the same name:\n"
+        + RagTagUtil::getPathsAsNewlineDelimitedString(conflicted_files);
+    }
+    if (!failed_files.empty()) {
+      details += L"\n\nThese files could not be copied:" + failed_files;
+    }
+    // Mismatches point at failing hardware or a flaky connection rather than at the user's
+    // choices, so they lead the message.
+    const std::wstring headline = mismatched_files.empty()
+      ? L"Not all files were copied successfully."
+      : L"Some copies did not match their originals when read back and were deleted. The "
+      L"destination drive or connection may be faulty.";
+    if (!mismatched_files.empty()) {
+      details = L"\n\nThese files did not match (CRC-32 checksums):" + mismatched_files + details;
+    }
+    wxMessageDialog dialog(this, headline + L"\n\n"
       + std::to_wstring(num_files_successfully_copied) + L" of "
       + std::to_wstring(files_to_copy.size()) + L" " + selected_plural + L" " + copied_plural2
-      + L" copied successfully.\n\n"
-      + L"Perhaps a file is missing or the directory contains a file sharing the name of a file you"
-      + L" are attempting to copy. Otherwise, there may be a permissions issue.\n\n"
-      + L"Files not copied:\n" + RagTagUtil::getPathsAsNewlineDelimitedString(uncopied_files),
-      "Copy Incomplete", wxOK | wxCENTER | wxICON_WARNING);
+      + L" copied successfully." + details + fallback_details + verification_details,
+      mismatched_files.empty() ? "Copy Incomplete" : "Copy Verification Failed",
+      wxOK | wxCENTER | wxICON_WARNING);
     dialog.ShowModal();
   }
   ShellExecute(NULL, L"open", directory->c_str(), NULL, NULL, SW_SHOWNORMAL);
 }
 
+void SummaryFrame::OnExportSelectionsToZip(wxCommandEvent& event)
+{
+  const std::vector<ragtag::path_t> files_to_export = getPathsOfSelectedFiles();
+  if (files_to_export.empty()) {
+    wxMessageDialog dialog(this, "Please select one or more files to export, then try again.",
+      "No Files to Export");
+    dialog.ShowModal();
+    return;
+  }
+
+  const wxString wx_path = wxFileSelector("Export Selected Files to ZIP Archive", wxEmptyString,
+    "Selected Files.zip", "zip", "ZIP archives (*.zip)|*.zip",
+    wxFD_SAVE | wxFD_OVERWRITE_PROMPT, this);
+  if (wx_path.empty()) {
+    // User canceled the dialog.
+    return;
+  }
+  const ragtag::path_t archive(wx_path.ToStdWstring());
+
+  const auto naming = promptExportNaming(files_to_export);
+  if (!naming.has_value()) {
+    return;
+  }
+  const auto names = ragtag::ExportNamer::planNames(files_to_export, *naming);
+  std::vector<ragtag::CopyJob> jobs;
+  jobs.reserve(files_to_export.size());
+  for (size_t i = 0; i < files_to_export.size(); ++i) {
+    jobs.push_back({ files_to_export[i], names[i] });
+  }
+  ragtag::ZipExporter exporter{ ragtag::ZipOptions() };
+  exporter.start(std::move(jobs), archive);
+
+  const bool user_canceled = !showCopyProgress("Exporting Selected Files",
+    [&exporter](const std::chrono::milliseconds timeout) {return exporter.waitFor(timeout);},
+    [&exporter]() {return exporter.getProgress();});
+  if (user_canceled) {
+    // The partial archive is deleted once the exporter stops.
+    exporter.cancel();
+    exporter.takeReport();
+    return;
+  }
+  const ragtag::CopyReport report = exporter.takeReport();
+
+  const int num_files_exported = report.count(ragtag::CopyOutcome::COPIED);
+  const std::wstring exported_plural1 = num_files_exported == 1 ? L"file" : L"files";
+  const std::wstring exported_plural2 = num_files_exported == 1 ? L"was" : L"were";
+  if (num_files_exported == files_to_export.size()) {
+    wxMessageDialog dialog(this, std::to_wstring(num_files_exported) + L" " + exported_plural1
+      + L" " + exported_plural2 + L" added to the archive successfully.", "Export Success");
+    dialog.ShowModal();
+  }
+  else {
+    std::wstring failed_files;
+    for (const auto& result : report.results) {
+      if (result.outcome != ragtag::CopyOutcome::COPIED) {
+        failed_files += L"\n" + result.job.source.wstring() + L" ("
+          + wxString(result.error.message()).ToStdWstring() + L")";
+      }
+    }
+    wxMessageDialog dialog(this, L"Not all files were exported successfully.\n\n"
+      + std::to_wstring(num_files_exported) + L" of " + std::to_wstring(files_to_export.size())
+      + L" selected files " + exported_plural2 + L" added to the archive.\n\n"
+      + L"These files could not be added:" + failed_files,
+      "Export Incomplete", wxOK | wxCENTER | wxICON_WARNING);
+    dialog.ShowModal();
+  }
+  if (num_files_exported > 0) {
+    ShellExecute(NULL, L"open", archive.parent_path().c_str(), NULL, NULL, SW_SHOWNORMAL);
+  }
+}
+
 void SummaryFrame::OnDeleteFiles(wxCommandEvent& event)
 {
   const std::vector<ragtag::path_t> paths_to_delete = getPathsOfSelectedFiles();
@@ -731,6 +1231,7 @@ void SummaryFrame::OnRemoveFromProject(wxCommandEvent& event)
 void SummaryFrame::OnKeyPressed(wxKeyEvent& event)
 {
   if (event.GetKeyCode() == WXK_F5) {
+    file_status_cache_.invalidate();
     refreshTagFilter();
     refreshFileList();
   }
@@ -748,73 +1249,3 @@ void SummaryFrame::OnClose(wxCloseEvent& event)
   // convenient if we don't flat-out destroy the summary frame when it's closed but merely hide it.
   Hide();
 }
-
-int wxCALLBACK SummaryFrame::pathSort(wxIntPtr item1, wxIntPtr item2, wxIntPtr sort_data)
-{
-  // It's understood that the items to sort are paths and that `sort_data` is a pointer to our
-  // sorting helper struct.
-  const ragtag::path_t path1 = *reinterpret_cast<ragtag::path_t*>(item1);
-  const ragtag::path_t path2 = *reinterpret_cast<ragtag::path_t*>(item2);
-  const SortHelper sort_helper = *reinterpret_cast<SortHelper*>(sort_data);
-  return sort_helper.sort_ascending ? path1.compare(path2) : -path1.compare(path2);
-}
-
-int wxCALLBACK SummaryFrame::tagSort(wxIntPtr item1, wxIntPtr item2, wxIntPtr sort_data)
-{
-  // It's understood that the items to sort are paths and that `sort_data` is a pointer to our
-  // sorting helper struct.
-  const ragtag::path_t path1 = *reinterpret_cast<ragtag::path_t*>(item1);
-  const ragtag::path_t path2 = *reinterpret_cast<ragtag::path_t*>(item2);
-  const SortHelper sort_helper = *reinterpret_cast<SortHelper*>(sort_data);
-  const ragtag::TagMap& tag_map = *sort_helper.p_tag_map;  // Alias for convenience
-  auto setting1 = tag_map.getTagSetting(path1, sort_helper.tag);
-  auto setting2 = tag_map.getTagSetting(path2, sort_helper.tag);
-
-  if (!setting1.has_value()) {
-    setting1 = ragtag::TagSetting::UNCOMMITTED;
-  }
-  if (!setting2.has_value()) {
-    setting2 = ragtag::TagSetting::UNCOMMITTED;
-  }
-
-  int natural_sort = 0;
-  if (*setting1 == *setting2) {
-    natural_sort = 0;
-  }
-  else if (*setting1 == ragtag::TagSetting::YES
-    || (*setting1 == ragtag::TagSetting::UNCOMMITTED && *setting2 == ragtag::TagSetting::NO)) {
-    natural_sort = 1;
-  }
-  else {
-    natural_sort = -1;
-  }
-
-  return sort_helper.sort_ascending ? natural_sort : -natural_sort;
-}
-
-int wxCALLBACK SummaryFrame::ratingSort(wxIntPtr item1, wxIntPtr item2, wxIntPtr sort_data)
-{
-  const ragtag::path_t path1 = *reinterpret_cast<ragtag::path_t*>(item1);
-  const ragtag::path_t path2 = *reinterpret_cast<ragtag::path_t*>(item2);
-  const SortHelper sort_helper = *reinterpret_cast<SortHelper*>(sort_data);
-  const ragtag::TagMap& tag_map = *sort_helper.p_tag_map;  // Alias for convenience
-  auto rating1 = tag_map.getRating(path1);
-  auto rating2 = tag_map.getRating(path2);
-  
-  int natural_sort = 0;
-  if (!rating1.has_value() && !rating2.has_value()) {
-    natural_sort = 0;
-  }
-  else if (rating1.has_value() && !rating2.has_value()) {
-    natural_sort = 1;
-  }
-  else if (!rating1.has_value() && rating2.has_value()) {
-    natural_sort = -1;
-  }
-  else {
-    natural_sort = *rating1 > *rating2 ? 1 :
-                   *rating1 < *rating2 ? -1 : 0;
-  }
-
-  return sort_helper.sort_ascending ? natural_sort : -natural_sort;
-}
@@ -16,17 +16,36 @@
 #ifndef INCLUDE_SUMMARY_FRAME_H
 #define INCLUDE_SUMMARY_FRAME_H
 
+#include "copy_engine.h"
+#include "export_namer.h"
+#include "file_selection.h"
+#include "file_status_cache.h"
+#include "filter_plan.h"
+#include "rag_tag_util.h"
+#include "rating_histogram.h"
+#include "recompute_scheduler.h"
+#include "summary_list_ctrl.h"
+#include "summary_model.h"
 #include "tag_map.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 #include <wx/button.h>
 #include <wx/checkbox.h>
+#include <wx/choice.h>
 #include <wx/combobox.h>
 #include <wx/event.h>
 #include <wx/frame.h>
 #include <wx/listctrl.h>
+#include <wx/scrolwin.h>
 #include <wx/slider.h>
 #include <wx/stattext.h>
+#include <wx/textctrl.h>
 #include <wx/window.h>
 
 //! Window displaying all files that have been added to a RagTag project. Offers controls for
@@ -45,11 +64,19 @@ public:
   void setTagMap(const ragtag::TagMap& tag_map);
 
   //! Updates the list of files and table columns to match the currently loaded tag map.
+  //! 
+  //! The list is updated before this function returns, superseding any update scheduled by
+  //! scheduleFileListRefresh().
   void refreshFileList();
 
   //! Updates the listing of tags in the tag filter dropdown to match the currently loaded tag map.
   void refreshTagFilter();
 
+  //! Forgets which files are known to be present on disk so that the next refresh checks anew.
+  //! 
+  //! Presence is otherwise cached for a short while, so call this after deleting or moving files.
+  void invalidateFileStatuses();
+
   //! Checks whether a given file is present in the file listing and highlights its line item if it
   //! is.
   //! 
@@ -59,51 +86,65 @@ public:
   void highlightFileIfPresent(const ragtag::path_t& path_to_highlight);
 
 private:
-  //! The index of the list control column that displays the file path.
-  static const int PATH_COLUMN_INDEX;
-
-  //! The index of the list control column that displays the file rating.
-  static const int RATING_COLUMN_INDEX;
-
-  //! The index of the first column used to display the state of a tag on the file.
-  static const int FIRST_TAG_COLUMN_INDEX;
-
-  //! The margin in pixels to preserve as empty space within the Path column when calculating the
-  //! extent of ellipsized text.
-  static const int PATH_EXTENT_MARGIN_PX;
+  //! Interprets the state of all filter user interface elements as a plan for selecting files.
+  //! 
+  //! Each control is read once, here, rather than once per file. Filters that would accept every
+  //! file are left out of the plan, and the file presence filter, which must consult the
+  //! filesystem, is ordered after the filters that only consult the tag map. The rating filter is
+  //! ordered after the other tag map filters so that it sees exactly the files they accept.
+  //! 
+  //! @param rating_histogram Histogram to tally the ratings of the files accepted by every tag map
+  //!     filter other than the rating filter into, or null to skip tallying. The presence filter
+  //!     runs afterward and isn't reflected.
+  //! @returns A plan representing all filter selections the user has made.
+  ragtag::FilterPlan buildFilterPlan(std::shared_ptr<ragtag::RatingHistogram> rating_histogram);
 
-  //! Helper struct used in sorting operations to communicate information not included directly in
-  //! the list control.
-  struct SortHelper {
-    //! Pointer to the tag map used to generate the table.
-    ragtag::TagMap* p_tag_map{ nullptr };
+  //! Gathers the tag constraints the user has chosen to include or exclude.
+  //! 
+  //! @returns The constraints, in the order of the tags they constrain. Whether files must satisfy
+  //!     all of them or any of them is given by the tag match mode selection.
+  std::vector<ragtag::TagConstraint> getTagConstraints() const;
 
-    //! The tag used for sorting (only relevant for columns representing tags).
-    ragtag::tag_t tag{};
+  //! Schedules the list of files to be updated in the background once the filter controls have
+  //! settled.
+  //! 
+  //! The filter is evaluated on a worker thread against the current snapshot of the tag map, and
+  //! the result is swapped in on the UI thread when ready. When many files match, the matches
+  //! found so far are shown as soon as they fill the list and then periodically until the filter
+  //! completes. Changing the filter again before then cancels the computation in favor of a new
+  //! one.
+  void scheduleFileListRefresh();
 
-    //! True to sort ascending order; false to sort by descending order.
-    bool sort_ascending{ false };
-  };
+  //! Swaps in the partial or final results of a background update of the file list, if any are
+  //! ready.
+  void commitFileListRefresh();
 
-  //! Interprets the state of the rating filter user interface as a rule for selecting files.
+  //! Replaces the rows of the file list with the given files and updates the filtered-file count.
   //! 
-  //! @returns A file qualifier representing the rating filter selections the user has made.
-  ragtag::TagMap::file_qualifier_t getRuleFromRatingFilterUi();
+  //! @param file_ids The IDs of the files that passed the filter, within `tag_map_`.
+  //! @param stage_stats Description of the filter's performance to show as a tooltip.
+  //! @param is_complete False if the filter is still running and more files may yet be added.
+  void showFilteredFiles(const std::vector<ragtag::file_id_t>& file_ids,
+    const std::string& stage_stats, bool is_complete = true);
 
-  //! Interprets the state of the tag filter user interface as a rule for selecting files.
+  //! Labels each tag in the tag filter dropdown with how many of the given files have each setting
+  //! of the tag.
   //! 
-  //! @returns A file qualifier representing the tag filter selections the user has made.
-  ragtag::TagMap::file_qualifier_t getRuleFromTagFilterUi();
+  //! @param file_ids The IDs of the files to count, within `tag_map_`.
+  void updateTagFacetCounts(const std::vector<ragtag::file_id_t>& file_ids);
 
-  //! Interprets the state of the file presence filter user interface as a rule for selecting files.
-  //! 
-  //! @returns A file qualifier representing the file presence filter selections the user has made.
-  ragtag::TagMap::file_qualifier_t getRuleFromPresenceFilterUi();
+  //! Updates the label beside the rating sliders with how many files the current slider positions
+  //! would accept, according to the histogram tallied by the last completed filter run.
+  void updateRatingCounts();
 
-  //! Composes a file selection rule from the state of all filter user interface elements.
+  //! Brings the file status cache up to date for a set of files in one batch.
+  //! 
+  //! Safe to call from any thread.
   //! 
-  //! @returns A file qualifier representing all filter selections the user has made.
-  ragtag::TagMap::file_qualifier_t getOverallRuleFromFilterUi();
+  //! @param tag_map The tag map the IDs belong to.
+  //! @param file_ids The IDs of the files of interest.
+  void prefetchFileStatuses(const ragtag::TagMap& tag_map,
+    const std::vector<ragtag::file_id_t>& file_ids);
 
   //! Prompts the user to select a directory to copy selected files to.
   //! 
@@ -113,6 +154,29 @@ private:
   //! optional if the user exits the prompt without choosing a directory.
   std::optional<ragtag::path_t> promptCopyDestination();
 
+  //! Determines how selected files should be reproduced in the copy destination.
+  //! 
+  //! @returns The copy mode chosen in the copy mode dropdown.
+  ragtag::CopyMode getSelectedCopyMode() const;
+
+  //! Asks the user how to name files being copied into one directory when some of them share a
+  //! name. Doesn't prompt if every name is unique.
+  //! 
+  //! @param files The files to be copied.
+  //! @returns The naming strategy to use, or an empty optional if the user cancels.
+  std::optional<ragtag::ExportNaming> promptExportNaming(const std::vector<ragtag::path_t>& files);
+
+  //! Shows a progress dialog for a copy or export running in the background until the work is
+  //! finished or the user cancels.
+  //! 
+  //! @param title Title of the progress dialog.
+  //! @param wait Function waiting up to a given time for the work, returning true once it's done.
+  //! @param get_progress Function obtaining the progress of the work.
+  //! @returns False if the user canceled. The caller is responsible for stopping the work.
+  bool showCopyProgress(const wxString& title,
+    const std::function<bool(std::chrono::milliseconds)>& wait,
+    const std::function<ragtag::CopyProgress()>& get_progress);
+
   //! Enables or disables rating filter controls based on whether the user has allowed rated files
   //! to be displayed.
   void updateRatingFilterEnabledState();
@@ -124,13 +188,6 @@ private:
   //! Resets all filter UI elements to their default state.
   void resetFilters();
 
-  //! Fills the Path column with the ellipsized path for each item.
-  //! 
-  //! This function also appends a text indicator when the file is not present on disk.
-  //! 
-  //! Paths are ellipsized to preserve the end of the path where possible.
-  void populateAndEllipsizePathColumn();
-
   //! Retrieves the list of all paths selected in the file listing.
   //! 
   //! @returns A list of all paths corresponding to selected items within the file listing.
@@ -181,26 +238,42 @@ private:
   //! Invoked when manipulating controls that adjust the file filter (for controls that don't need
   //! a more specialized action).
   //! 
-  //! Applies the filter and refreshes the file list to show the results of the filter.
+  //! Applies the filter and schedules the file list to show the results of the filter.
   //! 
-  //! @param event The wxCommandEvent of type wxEVT_CHECKBOX or wxEVT_COMBOBOX describing the
-  //!     action.
+  //! @param event The wxCommandEvent of type wxEVT_CHECKBOX, wxEVT_COMBOBOX, wxEVT_CHOICE, or
+  //!     wxEVT_TEXT describing the action.
   void OnFilterChangeGeneric(wxCommandEvent& event);
 
   //! Invoked when the user adjusts the slider controlling the minimum rating of the filter.
   //! 
-  //! Refreshes the file list and modifies the max slider if needed to prevent overlap.
+  //! Modifies the max slider if needed to prevent overlap and updates the count of matching files.
+  //! The file list is refreshed too unless the slider is still being dragged.
   //! 
   //! @param event The wxCommandEvent of type wxEVT_SLIDER describing the action.
   void OnMinSliderMove(wxCommandEvent& event);
 
   //! Invoked when the user adjusts the slider controlling the maximum rating of the filter.
   //! 
-  //! Refreshes the file list and modifies the min slider if needed to prevent overlap.
+  //! Modifies the min slider if needed to prevent overlap and updates the count of matching files.
+  //! The file list is refreshed too unless the slider is still being dragged.
   //! 
   //! @param event The wxCommandEvent of type wxEVT_SLIDER describing the action.
   void OnMaxSliderMove(wxCommandEvent& event);
 
+  //! Invoked while the user drags the thumb of either rating slider.
+  //! 
+  //! Defers refreshing the file list until the thumb is released.
+  //! 
+  //! @param event The wxScrollEvent of type wxEVT_SCROLL_THUMBTRACK describing the action.
+  void OnRatingSliderDrag(wxScrollEvent& event);
+
+  //! Invoked when the user releases the thumb of either rating slider.
+  //! 
+  //! Refreshes the file list to show the results of the filter.
+  //! 
+  //! @param event The wxScrollEvent of type wxEVT_SCROLL_THUMBRELEASE describing the action.
+  void OnRatingSliderRelease(wxScrollEvent& event);
+
   //! Invoked when the Show Rated checkbox is adjusted.
   //! 
   //! Adjusts the filter and refreshes the file list to show the results of the filter.
@@ -232,6 +305,16 @@ private:
   //! @param event The wxCommandEvent of type wxEVT_BUTTON describing the action.
   void OnDeselectAllFiles(wxCommandEvent& event);
 
+  //! Invoked when the Select Random Files button is clicked or otherwise activated.
+  //! 
+  //! Prompts the user for a number of files and a seed, then checks the boxes of that many files
+  //! chosen uniformly at random from the files passing the current filters, unchecking all others.
+  //! The seed is offered fresh each time but can be replaced with an earlier one to repeat a
+  //! selection of the same project with the same filters.
+  //! 
+  //! @param event The wxCommandEvent of type wxEVT_BUTTON describing the action.
+  void OnSelectRandomFiles(wxCommandEvent& event);
+
   //! Invoked when the Copy Selected Files to Directory button is clicked or otherwise activated.
   //! 
   //! Prompts the user for a destination to copy selected files to, and performs the copy if the
@@ -240,6 +323,13 @@ private:
   //! @param event The wxCommandEvent of type wxEVT_BUTTON describing the action.
   void OnCopySelections(wxCommandEvent& event);
 
+  //! Invoked when the Export Selected Files to ZIP button is clicked or otherwise activated.
+  //! 
+  //! Prompts the user for an archive to create and writes the selected files into it.
+  //! 
+  //! @param event The wxCommandEvent of type wxEVT_BUTTON describing the action.
+  void OnExportSelectionsToZip(wxCommandEvent& event);
+
   //! Invoked when the Delete Selected Files button is clicked or otherwise activated.
   //! 
   //! Prompts the user to confirm their intent to delete these files, then performs the deletion if
@@ -270,56 +360,61 @@ private:
   //! @param event The wxCloseEvent of type wxEVT_CLOSE_WINDOW describing the action.
   void OnClose(wxCloseEvent& event);
 
-  // SORTING FUNCTIONS =============================================================================
-  // Implementation note: The signature of these functions is required by wxListCtrl::SortItems().
-  
-  //! Logic for sorting files by their path.
-  //! 
-  //! @param item1 Pointer to user-defined data associated with the first list control item (which
-  //!     by convention we've set to be the path for that item).
-  //! @param item2 Pointer to user-defined data associated with the second list control item (which
-  //!     by convention we've set to be the path for that item).
-  //! @param sort_data Additional context used for sorting. As we've chosen to implement this
-  //!     function, this must be a pointer to a properly populated instance of SortHelper.
-  static int wxCALLBACK pathSort(wxIntPtr item1, wxIntPtr item2, wxIntPtr sort_data);
-
-  //! Logic for sorting files by the state of a given tag.
-  //! 
-  //! The tag to sort by must be defined in the SortHelper object the caller supplies by pointer to
-  //! this function via the `sort_data` parameter.
-  //! 
-  //! @param item1 Pointer to user-defined data associated with the first list control item (which
-  //!     by convention we've set to be the path for that item).
-  //! @param item2 Pointer to user-defined data associated with the second list control item (which
-  //!     by convention we've set to be the path for that item).
-  //! @param sort_data Additional context used for sorting. As we've chosen to implement this
-  //!     function, this must be a pointer to a properly populated instance of SortHelper.
-  static int wxCALLBACK tagSort(wxIntPtr item1, wxIntPtr item2, wxIntPtr sort_data);
-
-  //! Logic for sorting files by their rating.
-  //! 
-  //! @param item1 Pointer to user-defined data associated with the first list control item (which
-  //!     by convention we've set to be the path for that item).
-  //! @param item2 Pointer to user-defined data associated with the second list control item (which
-  //!     by convention we've set to be the path for that item).
-  //! @param sort_data Additional context used for sorting. As we've chosen to implement this
-  //!     function, this must be a pointer to a properly populated instance of SortHelper.
-  static int wxCALLBACK ratingSort(wxIntPtr item1, wxIntPtr item2, wxIntPtr sort_data);
+  //! Options of each tag's control within the multi-tag filter, by index.
+  enum TagConstraintChoice {
+    TAG_CONSTRAINT_IGNORE = 0,  //!< The tag doesn't affect the filter.
+    TAG_CONSTRAINT_INCLUDE,     //!< Files must have the tag set to YES.
+    TAG_CONSTRAINT_EXCLUDE      //!< Files must not have the tag set to YES.
+  };
+
+  //! Options of the multi-tag filter's mode control, by index.
+  enum TagMatchModeChoice {
+    TAG_MATCH_ALL = 0,  //!< Files must satisfy every tag constraint.
+    TAG_MATCH_ANY       //!< Files must satisfy at least one tag constraint.
+  };
+
+  //! Options of the copy mode control, by index.
+  enum CopyModeChoice {
+    COPY_MODE_COPY = 0,       //!< Copy files' contents.
+    COPY_MODE_REFLINK,        //!< Clone files where the file system supports it.
+    COPY_MODE_HARD_LINK,      //!< Create hard links to files.
+    COPY_MODE_SYMBOLIC_LINK   //!< Create symbolic links to files.
+  };
+
+  //! Time for which the filter controls must be left alone before the file list is recomputed.
+  static const std::chrono::milliseconds FILE_LIST_REFRESH_DELAY;
 
   //! Tag map used as the ground truth for this window's display of files, tags, etc.
-  ragtag::TagMap tag_map_{};
+  //! 
+  //! The tag map is replaced rather than modified, so background computations can safely share
+  //! it. Never null.
+  std::shared_ptr<const ragtag::TagMap> tag_map_{ std::make_shared<const ragtag::TagMap>() };
 
   //! Collection of tags referenced as user data by elements of the tag filter dropdown control.
   //! 
   //! Indices within this vector correspond to equivalent indices within `dd_tag_selection_`.
   std::vector<ragtag::tag_t> tags_{};
 
-  //! Collection of file paths referenced as user data by file listing entries.
-  //! 
-  //! Indices within this vector correspond to equivalent indices within `lc_summary_`.
-  std::vector<ragtag::path_t> file_paths_{};  // Indices to match those of lc_summary_
+  //! Ratings of the files accepted by every filter other than the rating and presence filters, as
+  //! of the last completed filter run.
+  ragtag::RatingHistogram rating_histogram_{ RagTagUtil::MAX_STARS };
+
+  //! Whether the user is dragging the thumb of a rating slider.
+  bool is_dragging_rating_slider_{ false };
+
+  //! Seed used for the most recent random selection of files, if any.
+  std::optional<std::uint64_t> last_random_seed_{};
+
+  //! Rows, sort order, and check state of the file listing, drawn from `tag_map_`.
+  ragtag::SummaryModel summary_model_;
+
+  //! Cache of whether project files are present on disk, shared by the presence filter and the
+  //! file listing.
+  ragtag::FileStatusCache file_status_cache_{};
 
   // USER INTERFACE ELEMENTS =======================================================================
+  //! Text box holding a substring that paths must contain to be included in the file listing.
+  wxTextCtrl* tc_path_search_{};
   //! Slider controlling minimum rating bound for rating filter.
   wxSlider* sl_min_rating_{};
   //! Slider controlling maximum rating bound for rating filter.
@@ -328,6 +423,8 @@ private:
   wxCheckBox* cb_show_rated_{};
   //! Checkbox controlling whether unrated files are included in the file listing.
   wxCheckBox* cb_show_unrated_{};
+  //! Text displaying how many files the rating filter accepts.
+  wxStaticText* st_rating_counts_{};
   //! Dropdown box of tags to use for filtering, establishing the "active filter tag."
   wxComboBox* dd_tag_selection_{};
   //! Checkbox controlling whether files for which the active filter tag is committed as YES should
@@ -339,6 +436,15 @@ private:
   //! Checkbox controlling whether files for which the active filter tag is UNCOMMITTED should be
   //! included in the file listing.
   wxCheckBox* cb_show_uncommitted_{};
+  //! Dropdown selecting whether files must satisfy all or any of the multi-tag filter's
+  //! constraints.
+  wxChoice* ch_tag_match_mode_{};
+  //! Scrollable area holding one constraint control per tag for the multi-tag filter.
+  wxScrolledWindow* sw_tag_constraints_{};
+  //! Controls setting each tag's constraint within the multi-tag filter.
+  //! 
+  //! Indices within this vector correspond to equivalent indices within `tags_`.
+  std::vector<wxChoice*> ch_tag_constraints_{};
   //! Checkbox controlling whether files present on disk should be included in the file listing.
   wxCheckBox* cb_show_present_{};
   //! Checkbox controlling whether files not present on disk should be included in the file listing.
@@ -347,13 +453,24 @@ private:
   wxStaticText* st_filtered_file_count_{};
   //! List control representing the "file listing," containing all project files and the status of
   //! all tags on these files.
-  wxListCtrl* lc_summary_{};
+  SummaryListCtrl* lc_summary_{};
   //! Button allowing the user to delete selected files.
   wxButton* b_delete_files_{};
   //! Button allowing the user to remove selected files from the project.
   wxButton* b_remove_from_project_{};
+  //! Dropdown selecting whether selected files are copied or linked to the copy destination.
+  wxChoice* ch_copy_mode_{};
+  //! Checkbox controlling whether copies are read back, checked against their originals, and
+  //! listed in a checksum manifest.
+  wxCheckBox* cb_verify_copies_{};
   //! Button allowing the user to copy selected files to a destination on disk.
   wxButton* b_copy_selections_{};
+  //! Button allowing the user to export selected files to a ZIP archive.
+  wxButton* b_export_zip_{};
+
+  //! Scheduler for background updates of the file list. Declared last so that its worker thread
+  //! is stopped before anything the worker uses is destroyed.
+  ragtag::RecomputeScheduler file_list_scheduler_;
 };
 
 // Forward-declare SummaryFrameEvent so that wxWidgets' wxDECLARE_EVENT macro can do what it needs.
@@ -0,0 +1,60 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "summary_list_ctrl.h"
+
+const int SummaryListCtrl::PATH_EXTENT_MARGIN_PX = 30;
+
+SummaryListCtrl::SummaryListCtrl(wxWindow* parent, const ragtag::SummaryModel& model,
+  ragtag::FileStatusCache& file_status_cache)
+  : wxListCtrl(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize,
+    wxLC_REPORT | wxLC_SINGLE_SEL | wxLC_VIRTUAL), model_(model),
+  file_status_cache_(file_status_cache),
+  path_ellipsizer_([this](const std::wstring& text) { return GetTextExtent(text).GetWidth(); })
+{
+  EnableCheckBoxes();
+}
+
+void SummaryListCtrl::refreshRows()
+{
+  SetItemCount(model_.numRows());
+  Refresh();
+}
+
+wxString SummaryListCtrl::OnGetItemText(long item, long column) const
+{
+  if (column != ragtag::SummaryModel::PATH_COLUMN) {
+    return model_.getCellText(item, column);
+  }
+
+  const auto path = model_.getPathAt(item);
+  if (!path.has_value()) {
+    // Really shouldn't happen.
+    return wxEmptyString;
+  }
+
+  std::wstring path_displayed = path->wstring();
+  if (!file_status_cache_.isPresent(*path)) {
+    path_displayed.append(L" [???]");
+  }
+
+  return path_ellipsizer_.ellipsizeStart(path_displayed,
+    GetColumnWidth(ragtag::SummaryModel::PATH_COLUMN) - PATH_EXTENT_MARGIN_PX);
+}
+
+bool SummaryListCtrl::OnGetItemIsChecked(long item) const
+{
+  return model_.isChecked(item);
+}
@@ -0,0 +1,79 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#ifndef INCLUDE_SUMMARY_LIST_CTRL_H
+#define INCLUDE_SUMMARY_LIST_CTRL_H
+
+#include "ellipsization_cache.h"
+#include "file_status_cache.h"
+#include "summary_model.h"
+#include <wx/listctrl.h>
+#include <wx/string.h>
+#include <wx/window.h>
+
+//! File listing of the project summary window.
+//! 
+//! The control runs in virtual mode: it stores nothing per row and instead asks its SummaryModel
+//! for the text and check state of whichever rows are being drawn. The owner is responsible for
+//! calling refreshRows() after modifying the model.
+class SummaryListCtrl : public wxListCtrl {
+public:
+  //! Constructor.
+  //! 
+  //! @param parent The parent window.
+  //! @param model The model supplying the rows of the listing. Must outlive the control.
+  //! @param file_status_cache Cache used to determine whether listed files are present. Must
+  //!     outlive the control.
+  SummaryListCtrl(wxWindow* parent, const ragtag::SummaryModel& model,
+    ragtag::FileStatusCache& file_status_cache);
+
+  //! Synchronizes the row count with the model and redraws the visible rows.
+  void refreshRows();
+
+protected:
+  //! Produces the text of a cell on demand.
+  //! 
+  //! Text for the Path column is ellipsized to the column width, preserving the end of the path,
+  //! and is suffixed with an indicator when the file is not present on disk. Only rows being drawn
+  //! are requested, and ellipsized paths are cached by text and width, so redrawing or resizing the
+  //! column doesn't re-measure rows that were already fitted.
+  //! 
+  //! @param item The index of the row.
+  //! @param column The index of the column.
+  //! @returns The text to display within the cell.
+  wxString OnGetItemText(long item, long column) const override;
+
+  //! Reports the check state of a row on demand.
+  //! 
+  //! @param item The index of the row.
+  //! @returns True if the row's checkbox should be drawn as checked.
+  bool OnGetItemIsChecked(long item) const override;
+
+private:
+  //! The margin in pixels to preserve as empty space within the Path column when calculating the
+  //! extent of ellipsized text.
+  static const int PATH_EXTENT_MARGIN_PX;
+
+  //! The model supplying the rows of the listing.
+  const ragtag::SummaryModel& model_;
+
+  //! Cache used to determine whether listed files are present.
+  ragtag::FileStatusCache& file_status_cache_;
+
+  //! Cache of ellipsized Path column text. Mutable because it's filled in as rows are drawn.
+  mutable ragtag::EllipsizationCache path_ellipsizer_;
+};
+
+#endif  // INCLUDE_SUMMARY_LIST_CTRL_H
@@ -0,0 +1,269 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "summary_model.h"
+#include <algorithm>
+
+namespace ragtag {
+  const int SummaryModel::PATH_COLUMN = 0;
+  const int SummaryModel::RATING_COLUMN = 1;
+  const int SummaryModel::FIRST_TAG_COLUMN = 2;
+  const size_t SummaryModel::MAX_SORT_KEYS = 3;
+
+  SummaryModel::SummaryModel(const Glyphs& glyphs) : glyphs_(glyphs) {}
+
+  void SummaryModel::setTagMap(const TagMap* tag_map) {
+    tag_map_ = tag_map;
+    tags_.clear();
+    rows_.clear();
+    row_indices_.clear();
+    checked_.reset(0);
+    num_checked_ = 0;
+
+    if (tag_map_ == nullptr) {
+      return;
+    }
+
+    // Keep sorting by the same columns, except for tags the new tag map doesn't have.
+    std::erase_if(sort_criteria_, [this](const SortEngine::Criterion& criterion) {
+      return criterion.field == SortEngine::Field::TAG && !tag_map_->isTagRegistered(criterion.tag);
+      });
+
+    for (const auto& tag_it : tag_map_->getAllTags()) {
+      tags_.push_back(tag_it.first);
+    }
+    row_indices_.assign(tag_map_->fileIdLimit(), -1);
+    checked_.reset(tag_map_->fileIdLimit());
+  }
+
+  void SummaryModel::setRows(const std::vector<file_id_t>& file_ids) {
+    // Check marks are left alone so that files hidden by a filter are checked again when they
+    // reappear. Only the count of marked rows needs recomputing.
+    num_checked_ = 0;
+    rows_.clear();
+    rows_.reserve(file_ids.size());
+    for (const file_id_t id : file_ids) {
+      if (id < 0 || id >= checked_.idLimit()) {
+        // Not a file of the tag map we were given.
+        continue;
+      }
+      rows_.push_back(id);
+      if (checked_.isSelected(id)) {
+        ++num_checked_;
+      }
+    }
+
+    applySort();
+  }
+
+  void SummaryModel::sortByColumn(const int column, const bool ascending) {
+    SortEngine::Criterion criterion;
+    if (column == PATH_COLUMN) {
+      criterion.field = SortEngine::Field::PATH;
+    }
+    else if (column == RATING_COLUMN) {
+      criterion.field = SortEngine::Field::RATING;
+    }
+    else if (column >= FIRST_TAG_COLUMN && column < numColumns()) {
+      criterion.field = SortEngine::Field::TAG;
+      criterion.tag = tags_[column - FIRST_TAG_COLUMN];
+    }
+    else {
+      return;
+    }
+    criterion.ascending = ascending;
+
+    // The column becomes the primary key. An earlier sort by the same column is superseded.
+    std::erase_if(sort_criteria_, [&criterion](const SortEngine::Criterion& existing) {
+      return existing.field == criterion.field && existing.tag == criterion.tag;
+      });
+    sort_criteria_.insert(sort_criteria_.begin(), criterion);
+    if (sort_criteria_.size() > MAX_SORT_KEYS) {
+      sort_criteria_.resize(MAX_SORT_KEYS);
+    }
+    applySort();
+  }
+
+  long SummaryModel::numRows() const {
+    return static_cast<long>(rows_.size());
+  }
+
+  int SummaryModel::numColumns() const {
+    return FIRST_TAG_COLUMN + static_cast<int>(tags_.size());
+  }
+
+  const std::vector<tag_t>& SummaryModel::getTags() const {
+    return tags_;
+  }
+
+  std::optional<file_id_t> SummaryModel::getFileIdAt(const long index) const {
+    if (index < 0 || index >= numRows()) {
+      return {};
+    }
+    return rows_[index];
+  }
+
+  std::optional<path_t> SummaryModel::getPathAt(const long index) const {
+    const auto id = getFileIdAt(index);
+    if (!id.has_value() || tag_map_ == nullptr) {
+      return {};
+    }
+    return tag_map_->getFilePath(*id);
+  }
+
+  std::optional<long> SummaryModel::findIndex(const file_id_t id) const {
+    if (id < 0 || id >= static_cast<file_id_t>(row_indices_.size()) || row_indices_[id] < 0) {
+      return {};
+    }
+    return row_indices_[id];
+  }
+
+  std::wstring SummaryModel::getCellText(const long index, const int column) const {
+    const auto id = getFileIdAt(index);
+    if (!id.has_value() || tag_map_ == nullptr) {
+      return {};
+    }
+
+    if (column == PATH_COLUMN) {
+      const auto path = tag_map_->getFilePath(*id);
+      return path.has_value() ? path->wstring() : std::wstring();
+    }
+
+    if (column == RATING_COLUMN) {
+      const auto rating = tag_map_->getRating(*id);
+      return rating.has_value() ? getStarText(*rating) : glyphs_.no_rating;
+    }
+
+    const int tag_index = column - FIRST_TAG_COLUMN;
+    if (tag_index < 0 || tag_index >= static_cast<int>(tags_.size())) {
+      return {};
+    }
+
+    const auto setting = tag_map_->getTagSetting(*id, tags_[tag_index]);
+    if (!setting.has_value() || *setting == TagSetting::UNCOMMITTED) {
+      return glyphs_.tag_uncommitted;
+    }
+    return *setting == TagSetting::YES ? glyphs_.tag_yes : glyphs_.tag_no;
+  }
+
+  bool SummaryModel::isChecked(const long index) const {
+    const auto id = getFileIdAt(index);
+    return id.has_value() && checked_.isSelected(*id);
+  }
+
+  void SummaryModel::setChecked(const long index, const bool checked) {
+    const auto id = getFileIdAt(index);
+    if (id.has_value() && checked_.setSelected(*id, checked)) {
+      num_checked_ += checked ? 1 : -1;
+    }
+  }
+
+  void SummaryModel::setAllChecked(const bool checked) {
+    if (checked) {
+      checked_.selectAll(rows_);
+      num_checked_ = numRows();
+    }
+    else {
+      checked_.clear();
+      num_checked_ = 0;
+    }
+  }
+
+  void SummaryModel::checkPaths(const std::vector<path_t>& paths) {
+    if (tag_map_ == nullptr) {
+      return;
+    }
+
+    for (const auto& path : paths) {
+      const auto id = tag_map_->getFileId(path);
+      if (id.has_value()) {
+        checkFileIds({ *id });
+      }
+    }
+  }
+
+  void SummaryModel::checkFileIds(const std::vector<file_id_t>& file_ids) {
+    for (const file_id_t id : file_ids) {
+      if (!checked_.setSelected(id, true)) {
+        continue;
+      }
+      if (findIndex(id).has_value()) {
+        ++num_checked_;
+      }
+    }
+  }
+
+  long SummaryModel::numChecked() const {
+    return num_checked_;
+  }
+
+  std::vector<path_t> SummaryModel::getCheckedPaths() const {
+    std::vector<path_t> returning;
+    if (tag_map_ == nullptr) {
+      return returning;
+    }
+
+    returning.reserve(num_checked_);
+    for (const file_id_t id : rows_) {
+      if (checked_.isSelected(id)) {
+        const auto path = tag_map_->getFilePath(id);
+        if (path.has_value()) {
+          returning.push_back(*path);
+        }
+      }
+    }
+    return returning;
+  }
+
+  std::vector<path_t> SummaryModel::getAllCheckedPaths() const {
+    std::vector<path_t> returning;
+    if (tag_map_ == nullptr) {
+      return returning;
+    }
+
+    returning.reserve(checked_.count());
+    for (const file_id_t id : checked_.getSelectedIds()) {
+      const auto path = tag_map_->getFilePath(id);
+      if (path.has_value()) {
+        returning.push_back(*path);
+      }
+    }
+    return returning;
+  }
+
+  std::wstring SummaryModel::getStarText(const rating_t rating) const {
+    std::wstring returning;
+    for (int i = 1; i <= glyphs_.max_stars; ++i) {
+      if (rating >= static_cast<rating_t>(i)) {
+        returning.append(glyphs_.rating_full_star);
+      }
+      else if (rating >= static_cast<rating_t>(i) - 0.5f) {
+        returning.append(glyphs_.rating_half_star);
+      }
+    }
+    return returning;
+  }
+
+  void SummaryModel::applySort() {
+    if (!sort_criteria_.empty() && tag_map_ != nullptr) {
+      rows_ = SortEngine::sort(*tag_map_, rows_, sort_criteria_);
+    }
+
+    std::fill(row_indices_.begin(), row_indices_.end(), -1);
+    for (long i = 0; i < numRows(); ++i) {
+      row_indices_[rows_[i]] = i;
+    }
+  }
+}  // namespace ragtag
@@ -0,0 +1,231 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#ifndef INCLUDE_SUMMARY_MODEL_H
+#define INCLUDE_SUMMARY_MODEL_H
+
+#include "file_selection.h"
+#include "sort_engine.h"
+#include "tag_map.h"
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace ragtag {
+  //! Data behind the project summary's file listing, kept independent of any user interface.
+  //! 
+  //! The model tracks which files of a TagMap are shown ("rows," identified by file ID), the order
+  //! in which they are shown, and which of them are checked. Cell text is produced on demand, so a
+  //! list control in virtual mode only ever formats the rows that are actually on screen.
+  //! 
+  //! Rows are addressed in two ways: by file ID, which is stable, and by index, which is the row's
+  //! current position in the listing and changes whenever the rows are filtered or sorted.
+  //! 
+  //! Check marks are kept by file ID, so they survive sorting and filtering: a checked file that is
+  //! filtered out is checked again when it reappears. Counts and bulk queries only consider files
+  //! that are currently rows, so hidden files are never acted upon.
+  class SummaryModel {
+  public:
+    //! The index of the column that displays the file path.
+    static const int PATH_COLUMN;
+
+    //! The index of the column that displays the file rating.
+    static const int RATING_COLUMN;
+
+    //! The index of the first column used to display the state of a tag on the file.
+    static const int FIRST_TAG_COLUMN;
+
+    //! Maximum number of columns the rows are sorted by at once.
+    static const size_t MAX_SORT_KEYS;
+
+    //! Text used to present ratings and tag settings within cells.
+    struct Glyphs {
+      //! Text for a tag set to TagSetting::YES.
+      std::wstring tag_yes{};
+      //! Text for a tag set to TagSetting::NO.
+      std::wstring tag_no{};
+      //! Text for a tag set to TagSetting::UNCOMMITTED.
+      std::wstring tag_uncommitted{};
+      //! Text for a full star of rating.
+      std::wstring rating_full_star{};
+      //! Text for a half star of rating.
+      std::wstring rating_half_star{};
+      //! Text for a file that has no rating.
+      std::wstring no_rating{};
+      //! Maximum quantity of stars used to present a rating.
+      int max_stars{ 5 };
+    };
+
+    //! Constructor.
+    //! 
+    //! @param glyphs Text used to present ratings and tag settings within cells.
+    explicit SummaryModel(const Glyphs& glyphs);
+
+    //! Associates a tag map with the model and clears all rows.
+    //! 
+    //! The model refers to the tag map rather than copying it, so the tag map must outlive the
+    //! model or be replaced by a subsequent call. The tags registered with the tag map at the time
+    //! of this call become the model's tag columns.
+    //! 
+    //! @param tag_map The tag map whose files the rows describe, or nullptr to detach the model.
+    void setTagMap(const TagMap* tag_map);
+
+    //! Replaces the rows of the model.
+    //! 
+    //! The current sort (if any) is applied to the new rows. Every file keeps its check mark,
+    //! whether or not it remains a row.
+    //! 
+    //! @param file_ids The IDs of the files to show, in their unsorted order.
+    void setRows(const std::vector<file_id_t>& file_ids);
+
+    //! Sorts the rows by the contents of a column, breaking ties by previously sorted columns.
+    //! 
+    //! Paths sort lexicographically, unrated files sort below rated files, and tag settings sort
+    //! in the order NO, UNCOMMITTED, YES. The column becomes the most significant sort key, and up
+    //! to MAX_SORT_KEYS - 1 of the columns sorted by before it remain as tiebreakers, so sorting by
+    //! path, then rating, then a tag orders rows by tag, then rating, then path. Rows that compare
+    //! equal by every key keep their relative order.
+    //! 
+    //! @param column The column to sort by.
+    //! @param ascending True to sort in ascending order; false to sort in descending order.
+    void sortByColumn(int column, bool ascending);
+
+    //! Obtains the count of rows.
+    //! 
+    //! @returns The number of rows in the model.
+    long numRows() const;
+
+    //! Obtains the count of columns, including the path and rating columns.
+    //! 
+    //! @returns The number of columns in the model.
+    int numColumns() const;
+
+    //! Retrieves the tags presented as columns, in column order.
+    //! 
+    //! @returns The tags presented as columns.
+    const std::vector<tag_t>& getTags() const;
+
+    //! Retrieves the file ID of the row at a given index.
+    //! 
+    //! @param index The index of the row.
+    //! @returns The file ID of the row or an empty optional if the index is out of range.
+    std::optional<file_id_t> getFileIdAt(long index) const;
+
+    //! Retrieves the path of the file in the row at a given index.
+    //! 
+    //! @param index The index of the row.
+    //! @returns The path of the file or an empty optional if the index is out of range.
+    std::optional<path_t> getPathAt(long index) const;
+
+    //! Finds the current index of the row for a given file.
+    //! 
+    //! @param id The ID of the file to find.
+    //! @returns The index of the file's row or an empty optional if the file is not a row.
+    std::optional<long> findIndex(file_id_t id) const;
+
+    //! Produces the text displayed within a cell.
+    //! 
+    //! The path column produces the full path; shortening it to fit is left to the view.
+    //! 
+    //! @param index The index of the row.
+    //! @param column The index of the column.
+    //! @returns The text of the cell or an empty string if the cell doesn't exist.
+    std::wstring getCellText(long index, int column) const;
+
+    //! Tests whether the row at a given index is checked.
+    //! 
+    //! @param index The index of the row.
+    //! @returns True if the row exists and is checked.
+    bool isChecked(long index) const;
+
+    //! Checks or unchecks the row at a given index.
+    //! 
+    //! @param index The index of the row.
+    //! @param checked True to check the row; false to uncheck it.
+    void setChecked(long index, bool checked);
+
+    //! Checks every row or unchecks every file.
+    //! 
+    //! @param checked True to check all rows; false to uncheck all files, including those that
+    //!     aren't currently rows.
+    void setAllChecked(bool checked);
+
+    //! Checks files by path, whether or not they are currently rows.
+    //! 
+    //! This is useful for carrying check marks over from a previous tag map, since file IDs aren't
+    //! comparable across tag maps.
+    //! 
+    //! @param paths The paths of the files to check. Paths not found in the tag map are ignored.
+    void checkPaths(const std::vector<path_t>& paths);
+
+    //! Checks files by ID, whether or not they are currently rows.
+    //! 
+    //! @param file_ids The IDs of the files to check, within the tag map. IDs out of range are
+    //!     ignored.
+    void checkFileIds(const std::vector<file_id_t>& file_ids);
+
+    //! Obtains the count of checked rows.
+    //! 
+    //! @returns The number of checked rows.
+    long numChecked() const;
+
+    //! Retrieves the paths of all checked rows in display order.
+    //! 
+    //! @returns The paths of all checked rows.
+    std::vector<path_t> getCheckedPaths() const;
+
+    //! Retrieves the paths of all checked files, including those that aren't currently rows.
+    //! 
+    //! @returns The paths of all checked files in order of file ID.
+    std::vector<path_t> getAllCheckedPaths() const;
+
+  private:
+    //! Produces the text presenting a rating as a string of repeated stars.
+    //! 
+    //! @param rating The rating to present.
+    //! @returns The text presenting the rating.
+    std::wstring getStarText(rating_t rating) const;
+
+    //! Reorders `rows_` per the current sort criteria and updates `row_indices_`.
+    void applySort();
+
+    //! Text used to present ratings and tag settings within cells.
+    Glyphs glyphs_;
+
+    //! The tag map whose files the rows describe.
+    const TagMap* tag_map_{ nullptr };
+
+    //! Tags presented as columns, in column order.
+    std::vector<tag_t> tags_{};
+
+    //! File IDs of all rows in display order.
+    std::vector<file_id_t> rows_{};
+
+    //! Index of each file's row, indexed by file ID. Files that aren't rows map to -1.
+    std::vector<long> row_indices_{};
+
+    //! Check marks of all files, including those that aren't currently rows.
+    FileSelection checked_{};
+
+    //! Count of rows marked within `checked_`.
+    long num_checked_{ 0 };
+
+    //! Criteria the rows are sorted by, most significant first. If empty, rows are left in their
+    //! given order.
+    std::vector<SortEngine::Criterion> sort_criteria_{};
+  };
+}  // namespace ragtag
+
+#endif  // INCLUDE_SUMMARY_MODEL_H
@@ -14,10 +14,16 @@
 // <https://www.gnu.org/licenses/>.
 
 #include "tag_map.h"
+#include "random_sampler.h"
 #include <algorithm>
+#include <bit>
 #include <codecvt>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <tuple>
 
 namespace ragtag {
   // Ensure these are no larger than max int so that we can safely cast size_t to int.
@@ -26,6 +32,30 @@ namespace ragtag {
 
   TagMap::TagMap() {}
 
+  TagMap::TagMap(const TagMap& other) : tag_registry_(other.tag_registry_),
+    file_map_(other.file_map_), files_by_id_(other.files_by_id_.size(), nullptr),
+    live_files_(other.live_files_), untagged_files_(other.untagged_files_),
+    num_untagged_files_(other.num_untagged_files_), tag_membership_(other.tag_membership_),
+    rating_counts_(other.rating_counts_), path_index_(other.path_index_) {
+    rebuildFileIdLookup();
+  }
+
+  TagMap& TagMap::operator=(const TagMap& other) {
+    if (this != &other) {
+      tag_registry_ = other.tag_registry_;
+      file_map_ = other.file_map_;
+      files_by_id_.assign(other.files_by_id_.size(), nullptr);
+      rebuildFileIdLookup();
+      live_files_ = other.live_files_;
+      untagged_files_ = other.untagged_files_;
+      num_untagged_files_ = other.num_untagged_files_;
+      tag_membership_ = other.tag_membership_;
+      rating_counts_ = other.rating_counts_;
+      path_index_ = other.path_index_;
+    }
+    return *this;
+  }
+
   bool TagMap::operator==(const TagMap& rhs) const noexcept {
     return tag_registry_ == rhs.tag_registry_ &&
       file_map_ == rhs.file_map_;
@@ -40,7 +70,16 @@ namespace ragtag {
       return false;
     }
 
-    return tag_registry_.emplace(tag, properties).second;
+    if (!tag_registry_.emplace(tag, properties).second) {
+      return false;
+    }
+    tag_membership_[tag] = TagMembership{};
+
+    // No file has a setting for the new tag yet, so every file is now untagged. Copying the bitmap
+    // of all files sets exactly the bits of the files that were complete, a word at a time.
+    untagged_files_ = live_files_;
+    num_untagged_files_ = numFiles();
+    return true;
   }
 
   bool TagMap::deleteTag(const tag_t tag) {
@@ -60,7 +99,10 @@ namespace ragtag {
     }
 
     // erase() returns number of elements removed.
-    return was_tag_cleared_from_all_files && tag_registry_.erase(tag) > 0;
+    const bool was_tag_erased = tag_registry_.erase(tag) > 0;
+    tag_membership_.erase(tag);
+    rebuildUntaggedFiles();
+    return was_tag_cleared_from_all_files && was_tag_erased;
   }
 
   bool TagMap::copyTag(tag_t tag, tag_t copy_name)
@@ -134,12 +176,39 @@ namespace ragtag {
   }
 
   bool TagMap::addFile(const path_t& path) {
-    return file_map_.emplace(path, FileProperties{}).second;
+    FileProperties properties;
+    properties.id = fileIdLimit();
+    const auto emplace_ret = file_map_.emplace(path, properties);
+    if (!emplace_ret.second) {
+      return false;
+    }
+
+    files_by_id_.push_back(&*emplace_ret.first);
+    setBit(live_files_, properties.id, true);
+    updateUntaggedFile(*emplace_ret.first);
+    path_index_.add(properties.id, path.wstring());
+    return true;
   }
 
   bool TagMap::removeFile(const path_t& path) {
-    // erase() returns number of elements removed.
-    return file_map_.erase(path) > 0;
+    const auto file_it = file_map_.find(path);
+    if (file_it == file_map_.end()) {
+      return false;
+    }
+
+    // Leave a hole rather than compacting so that IDs of other files don't shift.
+    files_by_id_[file_it->second.id] = nullptr;
+    setBit(live_files_, file_it->second.id, false);
+    if (setBit(untagged_files_, file_it->second.id, false)) {
+      --num_untagged_files_;
+    }
+    for (const auto& tag_it : file_it->second.tags) {
+      updateTagMembership(file_it->second.id, tag_it.first, TagSetting::UNCOMMITTED);
+    }
+    updateRatingCount(file_it->second.rating, -1);
+    path_index_.remove(file_it->second.id, path.wstring());
+    file_map_.erase(file_it);
+    return true;
   }
 
   bool TagMap::setTag(const path_t& path, const tag_t tag, const TagSetting setting) {
@@ -168,12 +237,16 @@ namespace ragtag {
         return true;
       }
       file_it->second.tags.erase(current_tag_it);
+      updateUntaggedFile(*file_it);
+      updateTagMembership(file_it->second.id, tag, setting);
       return true;
     }
 
     // Returns bool denoting whether insertion took place (true) or assignment took place (false),
     // but we don't really mind one way or the other, so we can ignore the result.
     file_it->second.tags.insert_or_assign(tag, setting).second;
+    updateUntaggedFile(*file_it);
+    updateTagMembership(file_it->second.id, tag, setting);
     return true;
   }
 
@@ -228,7 +301,9 @@ namespace ragtag {
       return false;
     }
 
+    updateRatingCount(file_it->second.rating, -1);
     file_it->second.rating = rating;
+    updateRatingCount(rating, 1);
     return true;
   }
 
@@ -251,6 +326,7 @@ namespace ragtag {
       return false;
     }
 
+    updateRatingCount(file_it->second.rating, -1);
     file_it->second.rating = {};
     return true;
   }
@@ -318,6 +394,7 @@ namespace ragtag {
       // Construct relevant FileInfo object...
       FileInfo info;
       info.path = file.first;
+      info.id = file.second.id;
       info.rating = file.second.rating;
       // In effect, this function allows the invoking of getTagSetting() without an explicit path.
       // This allows the developer to focus on the traits of the tags.
@@ -339,11 +416,379 @@ namespace ragtag {
     return qualified_file_vector;
   }
 
+  std::vector<file_id_t> TagMap::selectFileIds(const file_qualifier_t& fn) const {
+    std::vector<file_id_t> qualified_id_vector;
+    for (const auto& file : file_map_) {
+      if (qualifies(file, fn)) {
+        qualified_id_vector.push_back(file.second.id);
+      }
+    }
+
+    return qualified_id_vector;
+  }
+
+  std::vector<file_id_t> TagMap::getAllFileIds() const {
+    std::vector<file_id_t> id_vector;
+    id_vector.reserve(file_map_.size());
+    for (const auto& file : file_map_) {
+      id_vector.push_back(file.second.id);
+    }
+    return id_vector;
+  }
+
   int TagMap::numFiles() const {
     // Safe conversion provided MAX_NUM_FILES is enforced.
     return static_cast<int>(file_map_.size());
   }
 
+  std::optional<path_t> TagMap::findUntaggedFile(const path_t& reference,
+    const bool find_next) const {
+    // An unknown reference sits just before the first file or just after the last.
+    const auto file_it = file_map_.find(reference);
+    const file_id_t reference_id = file_it != file_map_.end() ? file_it->second.id
+      : find_next ? -1 : fileIdLimit();
+    const auto found_id = findUntaggedFileId(reference_id, find_next);
+    if (!found_id.has_value()) {
+      return {};
+    }
+    return files_by_id_[*found_id]->first;
+  }
+
+  std::optional<file_id_t> TagMap::findUntaggedFileId(const file_id_t reference,
+    const bool find_next) const {
+    if (num_untagged_files_ == 0) {
+      return {};
+    }
+
+    if (find_next) {
+      const auto next_id = findNextBit(untagged_files_, reference + 1);
+      return next_id.has_value() ? next_id : findNextBit(untagged_files_, 0);
+    }
+
+    const auto previous_id = findPreviousBit(untagged_files_, reference - 1);
+    return previous_id.has_value() ? previous_id
+      : findPreviousBit(untagged_files_, std::numeric_limits<file_id_t>::max());
+  }
+
+  int TagMap::numUntaggedFiles() const {
+    return num_untagged_files_;
+  }
+
+  std::map<tag_t, TagSettingCounts> TagMap::countTagSettings(
+    const std::vector<file_id_t>& file_ids) const {
+    std::vector<bitmap_word_t> selection;
+    for (const file_id_t id : file_ids) {
+      if (id >= 0 && id < fileIdLimit() && files_by_id_[id] != nullptr) {
+        setBit(selection, id, true);
+      }
+    }
+
+    int num_selected = 0;
+    for (const bitmap_word_t word : selection) {
+      num_selected += std::popcount(word);
+    }
+
+    std::map<tag_t, TagSettingCounts> counts;
+    for (const auto& membership_it : tag_membership_) {
+      TagSettingCounts& tag_counts = counts[membership_it.first];  // Alias for convenience
+      tag_counts.yes = countCommonBits(selection, membership_it.second.yes);
+      tag_counts.no = countCommonBits(selection, membership_it.second.no);
+      // Only YES and NO are recorded, so every other selected file is UNCOMMITTED.
+      tag_counts.uncommitted = num_selected - tag_counts.yes - tag_counts.no;
+    }
+    return counts;
+  }
+
+  std::vector<file_id_t> TagMap::selectFileIdsByTags(
+    const std::vector<TagConstraint>& constraints, const bool match_all) const {
+    constexpr int BITS_PER_WORD = std::numeric_limits<bitmap_word_t>::digits;
+    std::vector<file_id_t> returning;
+    forEachMatchingWord(constraints, match_all, [&returning](size_t i, bitmap_word_t word) {
+      for (; word != 0; word &= word - 1) {
+        returning.push_back(static_cast<file_id_t>(i * BITS_PER_WORD + std::countr_zero(word)));
+      }
+      });
+    return returning;
+  }
+
+  std::vector<file_id_t> TagMap::queryFileIds(const file_qualifier_t& fn,
+    const QueryOptions& options) const {
+    std::vector<file_id_t> returning;
+    if (options.limit.has_value() && *options.limit <= 0) {
+      return returning;
+    }
+    const size_t offset = static_cast<size_t>(std::max(options.offset, 0));
+
+    if (options.order == QueryOrder::PATH) {
+      // Files are already stored in path order, so the window is found by walking to it.
+      size_t num_skipped = 0;
+      const auto visit = [&](const std::pair<const path_t, FileProperties>& file) {
+        if (!qualifies(file, fn)) {
+          return true;
+        }
+        if (num_skipped < offset) {
+          ++num_skipped;
+          return true;
+        }
+        returning.push_back(file.second.id);
+        return !options.limit.has_value() || returning.size() < static_cast<size_t>(*options.limit);
+        };
+      if (options.ascending) {
+        for (auto it = file_map_.begin(); it != file_map_.end() && visit(*it); ++it) {}
+      }
+      else {
+        for (auto it = file_map_.rbegin(); it != file_map_.rend() && visit(*it); ++it) {}
+      }
+      return returning;
+    }
+
+    // Candidates are ranked by key and then by position in path order. Descending keys are negated
+    // so that a plain less-than ranks every candidate.
+    typedef std::tuple<double, int, file_id_t> candidate_t;
+    const auto key_of = [&options](const FileProperties& properties) {
+      double key = 0.0;
+      if (options.order == QueryOrder::RATING) {
+        key = properties.rating.has_value() ? *properties.rating
+          : -std::numeric_limits<double>::infinity();
+      }
+      else {
+        const auto tag_it = properties.tags.find(options.tag);
+        key = tag_it == properties.tags.end() || tag_it->second == TagSetting::UNCOMMITTED ? 1.0
+          : tag_it->second == TagSetting::YES ? 2.0 : 0.0;
+      }
+      return options.ascending ? key : -key;
+      };
+
+    // With a limit, only the best `offset + limit` candidates can land in the window, so they're
+    // kept in a max-heap whose top is the first to be displaced by a better candidate.
+    std::optional<size_t> window_end;
+    if (options.limit.has_value()) {
+      window_end = offset + static_cast<size_t>(*options.limit);
+    }
+    std::vector<candidate_t> candidates;
+    int position = 0;
+    for (const auto& file : file_map_) {
+      const int file_position = position++;
+      if (!qualifies(file, fn)) {
+        continue;
+      }
+      const candidate_t candidate{ key_of(file.second), file_position, file.second.id };
+      if (!window_end.has_value()) {
+        candidates.push_back(candidate);
+      }
+      else if (candidates.size() < *window_end) {
+        candidates.push_back(candidate);
+        std::push_heap(candidates.begin(), candidates.end());
+      }
+      else if (candidate < candidates.front()) {
+        std::pop_heap(candidates.begin(), candidates.end());
+        candidates.back() = candidate;
+        std::push_heap(candidates.begin(), candidates.end());
+      }
+    }
+    if (window_end.has_value()) {
+      std::sort_heap(candidates.begin(), candidates.end());
+    }
+    else {
+      std::sort(candidates.begin(), candidates.end());
+    }
+
+    for (size_t i = offset; i < candidates.size(); ++i) {
+      returning.push_back(std::get<2>(candidates[i]));
+    }
+    return returning;
+  }
+
+  std::vector<file_id_t> TagMap::selectFileIdsByPath(const std::wstring& substring) const {
+    const std::wstring needle = PathTrigramIndex::foldCase(substring);
+    const auto matches = [this, &needle](const file_id_t id) {
+      return files_by_id_[id] != nullptr && PathTrigramIndex::foldCase(
+        files_by_id_[id]->first.wstring()).find(needle) != std::wstring::npos;
+      };
+
+    std::vector<file_id_t> returning;
+    const auto candidates = path_index_.findCandidates(needle);
+    if (candidates.has_value()) {
+      std::copy_if(candidates->begin(), candidates->end(), std::back_inserter(returning), matches);
+    }
+    else {
+      for (file_id_t id = 0; id < fileIdLimit(); ++id) {
+        if (matches(id)) {
+          returning.push_back(id);
+        }
+      }
+    }
+    return returning;
+  }
+
+  std::vector<file_id_t> TagMap::sampleFileIds(const file_qualifier_t& fn, const int count,
+    const std::uint64_t seed) const {
+    if (count <= 0) {
+      return {};
+    }
+
+    // The i-th qualifying file replaces a random member of the reservoir with probability
+    // count / i, which leaves every file equally likely to remain once the pass is done. Files are
+    // paired with their positions so that the sample can be put back in path order.
+    std::mt19937_64 engine(seed);
+    std::vector<std::pair<int, file_id_t>> reservoir;
+    reservoir.reserve(std::min(static_cast<size_t>(count), file_map_.size()));
+    int position = 0;
+    int num_qualified = 0;
+    for (const auto& file : file_map_) {
+      const int file_position = position++;
+      if (!qualifies(file, fn)) {
+        continue;
+      }
+      if (num_qualified < count) {
+        reservoir.emplace_back(file_position, file.second.id);
+      }
+      else {
+        const int slot = std::uniform_int_distribution<int>(0, num_qualified)(engine);
+        if (slot < count) {
+          reservoir[slot] = { file_position, file.second.id };
+        }
+      }
+      ++num_qualified;
+    }
+
+    std::sort(reservoir.begin(), reservoir.end());
+    std::vector<file_id_t> returning;
+    returning.reserve(reservoir.size());
+    for (const auto& entry : reservoir) {
+      returning.push_back(entry.second);
+    }
+    return returning;
+  }
+
+  std::vector<file_id_t> TagMap::sampleFileIdsByTags(const std::vector<TagConstraint>& constraints,
+    const bool match_all, const int count, const std::uint64_t seed) const {
+    constexpr int BITS_PER_WORD = std::numeric_limits<bitmap_word_t>::digits;
+
+    // Alongside each word of matches, note the rank among all matches of its first match.
+    std::vector<bitmap_word_t> matches;
+    std::vector<int> word_ranks;
+    int num_matches = 0;
+    forEachMatchingWord(constraints, match_all, [&](size_t, bitmap_word_t word) {
+      matches.push_back(word);
+      word_ranks.push_back(num_matches);
+      num_matches += std::popcount(word);
+      });
+
+    std::vector<file_id_t> returning;
+    for (const int rank : RandomSampler::sampleIndices(num_matches, count, seed)) {
+      // The last word whose first rank doesn't exceed this rank is the word holding the match.
+      const size_t i = static_cast<size_t>(
+        std::upper_bound(word_ranks.begin(), word_ranks.end(), rank) - word_ranks.begin() - 1);
+      bitmap_word_t word = matches[i];
+      for (int skipped = word_ranks[i]; skipped < rank; ++skipped) {
+        word &= word - 1;
+      }
+      returning.push_back(static_cast<file_id_t>(i * BITS_PER_WORD + std::countr_zero(word)));
+    }
+    return returning;
+  }
+
+  std::optional<TagSettingCounts> TagMap::getTagSettingCounts(const tag_t& tag) const {
+    const auto membership_it = tag_membership_.find(tag);
+    if (membership_it == tag_membership_.end()) {
+      return {};
+    }
+
+    TagSettingCounts counts;
+    counts.yes = membership_it->second.num_yes;
+    counts.no = membership_it->second.num_no;
+    counts.uncommitted = numFiles() - counts.yes - counts.no;
+    return counts;
+  }
+
+  int TagMap::countRatedFiles(const rating_t min_rating, const rating_t max_rating) const {
+    if (min_rating > max_rating) {
+      return 0;
+    }
+    int count = 0;
+    const auto end_it = rating_counts_.upper_bound(max_rating);
+    for (auto count_it = rating_counts_.lower_bound(min_rating); count_it != end_it; ++count_it) {
+      count += count_it->second;
+    }
+    return count;
+  }
+
+  int TagMap::countFiles(const file_qualifier_t& fn) const {
+    if (!fn) {
+      return numFiles();
+    }
+
+    const std::pair<const path_t, FileProperties>* current_file = nullptr;
+    FileInfo info;
+    info.f_tag_setting = [&current_file](tag_t tag) {
+      const auto tag_it = current_file->second.tags.find(tag);
+      return tag_it == current_file->second.tags.end() ? TagSetting::UNCOMMITTED : tag_it->second;
+      };
+
+    int count = 0;
+    for (const auto& file : file_map_) {
+      current_file = &file;
+      info.path = file.first;
+      info.id = file.second.id;
+      info.rating = file.second.rating;
+      if (std::invoke(fn, info)) {
+        ++count;
+      }
+    }
+    return count;
+  }
+
+  int TagMap::countFilesByTags(const std::vector<TagConstraint>& constraints,
+    const bool match_all) const {
+    int count = 0;
+    forEachMatchingWord(constraints, match_all, [&count](size_t, bitmap_word_t word) {
+      count += std::popcount(word);
+      });
+    return count;
+  }
+
+  std::optional<file_id_t> TagMap::getFileId(const path_t& path) const {
+    const auto file_it = file_map_.find(path);
+    if (file_it == file_map_.end()) {
+      return {};
+    }
+    return file_it->second.id;
+  }
+
+  std::optional<path_t> TagMap::getFilePath(const file_id_t id) const {
+    if (id < 0 || id >= fileIdLimit() || files_by_id_[id] == nullptr) {
+      return {};
+    }
+    return files_by_id_[id]->first;
+  }
+
+  std::optional<TagSetting> TagMap::getTagSetting(const file_id_t id, const tag_t& tag) const {
+    if (id < 0 || id >= fileIdLimit() || files_by_id_[id] == nullptr) {
+      return {};
+    }
+
+    const auto& file_tags = files_by_id_[id]->second.tags;
+    const auto tag_it = file_tags.find(tag);
+    if (tag_it == file_tags.end()) {
+      // If tag isn't explicitly declared, it's uncommitted.
+      return TagSetting::UNCOMMITTED;
+    }
+    return tag_it->second;
+  }
+
+  std::optional<rating_t> TagMap::getRating(const file_id_t id) const {
+    if (id < 0 || id >= fileIdLimit() || files_by_id_[id] == nullptr) {
+      return {};
+    }
+    return files_by_id_[id]->second.rating;
+  }
+
+  file_id_t TagMap::fileIdLimit() const {
+    // Safe conversion provided MAX_NUM_FILES is enforced.
+    return static_cast<file_id_t>(files_by_id_.size());
+  }
+
   nlohmann::json TagMap::toJson() const {
     nlohmann::json json;
 
@@ -650,6 +1095,178 @@ namespace ragtag {
     }
   }
 
+  bool TagMap::qualifies(const std::pair<const path_t, FileProperties>& file,
+    const file_qualifier_t& fn) {
+    if (!fn) {
+      return true;
+    }
+
+    FileInfo info;
+    info.path = file.first;
+    info.id = file.second.id;
+    info.rating = file.second.rating;
+    info.f_tag_setting = [&file](tag_t tag) {
+      const auto tag_it = file.second.tags.find(tag);
+      return tag_it == file.second.tags.end() ? TagSetting::UNCOMMITTED : tag_it->second;
+      };
+    return std::invoke(fn, info);
+  }
+
+  void TagMap::rebuildFileIdLookup() {
+    // The table is expected to be sized already, which preserves holes left by removed files.
+    std::fill(files_by_id_.begin(), files_by_id_.end(), nullptr);
+    for (auto& file : file_map_) {
+      files_by_id_[file.second.id] = &file;
+    }
+  }
+
+  void TagMap::updateUntaggedFile(const std::pair<const path_t, FileProperties>& file) {
+    // Only YES and NO settings of registered tags are stored, so a file is fully tagged exactly
+    // when it stores a setting for every tag. (See getFileTagCoverage().)
+    const bool is_untagged = tag_registry_.empty()
+      || file.second.tags.size() != tag_registry_.size();
+    if (setBit(untagged_files_, file.second.id, is_untagged)) {
+      num_untagged_files_ += is_untagged ? 1 : -1;
+    }
+  }
+
+  void TagMap::updateTagMembership(const file_id_t id, const tag_t& tag,
+    const TagSetting setting) {
+    TagMembership& membership = tag_membership_[tag];  // Alias for convenience
+    const bool is_yes = setting == TagSetting::YES;
+    const bool is_no = setting == TagSetting::NO;
+    if (setBit(membership.yes, id, is_yes)) {
+      membership.num_yes += is_yes ? 1 : -1;
+    }
+    if (setBit(membership.no, id, is_no)) {
+      membership.num_no += is_no ? 1 : -1;
+    }
+  }
+
+  bool TagMap::setBit(std::vector<bitmap_word_t>& bitmap, const file_id_t id,
+    const bool value) {
+    constexpr int BITS_PER_WORD = std::numeric_limits<bitmap_word_t>::digits;
+    const size_t word_index = static_cast<size_t>(id) / BITS_PER_WORD;
+    if (word_index >= bitmap.size()) {
+      if (!value) {
+        // Bits beyond the end are already clear.
+        return false;
+      }
+      bitmap.resize(word_index + 1, 0);
+    }
+
+    const bitmap_word_t mask = bitmap_word_t{ 1 } << (id % BITS_PER_WORD);
+    const bitmap_word_t previous = bitmap[word_index];
+    if (value) {
+      bitmap[word_index] |= mask;
+    }
+    else {
+      bitmap[word_index] &= ~mask;
+    }
+    return bitmap[word_index] != previous;
+  }
+
+  std::optional<file_id_t> TagMap::findNextBit(const std::vector<bitmap_word_t>& bitmap,
+    const file_id_t from) {
+    constexpr int BITS_PER_WORD = std::numeric_limits<bitmap_word_t>::digits;
+    const file_id_t start = std::max(from, 0);
+    size_t word_index = static_cast<size_t>(start) / BITS_PER_WORD;
+    if (word_index >= bitmap.size()) {
+      return {};
+    }
+    // Ignore the bits of the first word that come before the start.
+    bitmap_word_t word = bitmap[word_index] & (~bitmap_word_t{ 0 } << (start % BITS_PER_WORD));
+    while (word == 0) {
+      if (++word_index >= bitmap.size()) {
+        return {};
+      }
+      word = bitmap[word_index];
+    }
+    return static_cast<file_id_t>(word_index * BITS_PER_WORD + std::countr_zero(word));
+  }
+
+  std::optional<file_id_t> TagMap::findPreviousBit(const std::vector<bitmap_word_t>& bitmap,
+    const file_id_t to) {
+    constexpr int BITS_PER_WORD = std::numeric_limits<bitmap_word_t>::digits;
+    if (to < 0 || bitmap.empty()) {
+      return {};
+    }
+    size_t word_index = static_cast<size_t>(to) / BITS_PER_WORD;
+    bitmap_word_t word = 0;
+    if (word_index >= bitmap.size()) {
+      word_index = bitmap.size() - 1;
+      word = bitmap[word_index];
+    }
+    else {
+      // Ignore the bits of the first word that come after the end.
+      word = bitmap[word_index] & (~bitmap_word_t{ 0 } >> (BITS_PER_WORD - 1 - to % BITS_PER_WORD));
+    }
+    while (word == 0) {
+      if (word_index == 0) {
+        return {};
+      }
+      word = bitmap[--word_index];
+    }
+    return static_cast<file_id_t>(word_index * BITS_PER_WORD + std::bit_width(word) - 1);
+  }
+
+  void TagMap::updateRatingCount(const std::optional<rating_t> rating, const int delta) {
+    if (!rating.has_value()) {
+      return;
+    }
+    const auto count_it = rating_counts_.try_emplace(*rating, 0).first;
+    count_it->second += delta;
+    if (count_it->second <= 0) {
+      rating_counts_.erase(count_it);
+    }
+  }
+
+  void TagMap::forEachMatchingWord(const std::vector<TagConstraint>& constraints,
+    const bool match_all, const std::function<void(size_t, bitmap_word_t)>& fn) const {
+    constexpr int BITS_PER_WORD = std::numeric_limits<bitmap_word_t>::digits;
+    // Resolve each constraint's bitmap up front so that the pass below needn't look up tags.
+    static const std::vector<bitmap_word_t> EMPTY_BITMAP;
+    std::vector<std::pair<const std::vector<bitmap_word_t>*, bool>> resolved;
+    resolved.reserve(constraints.size());
+    for (const auto& constraint : constraints) {
+      const auto membership_it = tag_membership_.find(constraint.tag);
+      resolved.emplace_back(membership_it == tag_membership_.end() ? &EMPTY_BITMAP
+        : &membership_it->second.yes, constraint.has_tag);
+    }
+
+    const size_t limit = files_by_id_.size();
+    for (size_t i = 0; i * BITS_PER_WORD < limit; ++i) {
+      // Files that have been removed leave holes in the ID space that mustn't match.
+      const bitmap_word_t existing = i < live_files_.size() ? live_files_[i] : 0;
+
+      bitmap_word_t combined = match_all ? existing : 0;
+      for (const auto& [yes, has_tag] : resolved) {
+        const bitmap_word_t yes_word = i < yes->size() ? (*yes)[i] : 0;
+        const bitmap_word_t satisfied = has_tag ? yes_word : ~yes_word & existing;
+        combined = match_all ? combined & satisfied : combined | satisfied;
+      }
+      std::invoke(fn, i, combined);
+    }
+  }
+
+  int TagMap::countCommonBits(const std::vector<bitmap_word_t>& lhs,
+    const std::vector<bitmap_word_t>& rhs) {
+    const size_t num_words = std::min(lhs.size(), rhs.size());
+    int count = 0;
+    for (size_t i = 0; i < num_words; ++i) {
+      count += std::popcount(lhs[i] & rhs[i]);
+    }
+    return count;
+  }
+
+  void TagMap::rebuildUntaggedFiles() {
+    untagged_files_.assign(live_files_.size(), 0);
+    num_untagged_files_ = 0;
+    for (const auto& file : file_map_) {
+      updateUntaggedFile(file);
+    }
+  }
+
   // These numbers don't have to match the enumerator mapping so long as they form a one-to-one
   // mapping exactly reversed by numberToTagSetting().
   std::optional<int> TagMap::tagSettingToNumber(TagSetting setting) {
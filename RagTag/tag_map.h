@@ -16,6 +16,8 @@
 #ifndef INCLUDE_TAG_MAP_H
 #define INCLUDE_TAG_MAP_H
 
+#include "path_trigram_index.h"
+#include <cstdint>
 #include <filesystem>
 #include <functional>
 #include <map>
@@ -35,6 +37,12 @@ namespace ragtag {
   typedef float rating_t;
   //! Type used to describe hotkeys.
   typedef wchar_t rtchar_t;
+  //! Type used to identify files within a TagMap.
+  //! 
+  //! IDs are assigned densely as files are added and are never reused by the TagMap that assigned
+  //! them, so they remain valid keys for as long as the file stays in the TagMap (and in copies of
+  //! that TagMap).
+  typedef int file_id_t;
 
   //! Way to describe a tag's applicability to a file.
   enum class TagSetting {
@@ -77,6 +85,51 @@ namespace ragtag {
     }
   };
 
+  //! Count of files having each setting of one tag.
+  struct TagSettingCounts {
+    //! Number of files for which the tag is set to TagSetting::YES.
+    int yes{ 0 };
+    //! Number of files for which the tag is set to TagSetting::NO.
+    int no{ 0 };
+    //! Number of files for which the tag is set to TagSetting::UNCOMMITTED.
+    int uncommitted{ 0 };
+
+    //! Tests equality of this TagSettingCounts instance and another.
+    //! 
+    //! @param rhs TagSettingCounts instance to compare this instance with.
+    //! @returns True if all three counts match.
+    bool operator==(const TagSettingCounts& rhs) const noexcept = default;
+  };
+
+  //! Requirement placed on one tag when selecting files by a combination of tags.
+  struct TagConstraint {
+    //! The tag constrained.
+    tag_t tag{};
+    //! True to require the tag to be set to TagSetting::YES; false to require it not to be.
+    bool has_tag{ true };
+  };
+
+  //! Key by which the results of TagMap::queryFileIds() are ordered.
+  enum class QueryOrder {
+    PATH,    //!< Order by path.
+    RATING,  //!< Order by rating, with unrated files ordered before rated files.
+    TAG      //!< Order by setting of a tag: NO, then UNCOMMITTED, then YES.
+  };
+
+  //! Ordering and windowing applied to the results of TagMap::queryFileIds().
+  struct QueryOptions {
+    //! Key by which the results are ordered.
+    QueryOrder order{ QueryOrder::PATH };
+    //! Tag whose setting the results are ordered by when `order` is QueryOrder::TAG.
+    tag_t tag{};
+    //! True to order the results by increasing key; false to order them by decreasing key.
+    bool ascending{ true };
+    //! Number of leading results to skip.
+    int offset{ 0 };
+    //! Maximum number of results to produce after skipping, or an empty optional for no limit.
+    std::optional<int> limit{};
+  };
+
   //! Database of files, descriptors, and the relationship between the two.
   //!  
   //! Descriptors take the form of tags and ratings. Files must be added to the TagMap via addFile()
@@ -101,6 +154,32 @@ namespace ragtag {
     //! Produces a TagMap with no files and no registered tags.
     TagMap();
 
+    //! Copy constructor.
+    //! 
+    //! The copy preserves the file IDs assigned by the original.
+    //! 
+    //! @param other The TagMap to copy.
+    TagMap(const TagMap& other);
+
+    //! Move constructor.
+    //! 
+    //! @param other The TagMap to move from.
+    TagMap(TagMap&& other) = default;
+
+    //! Copy assignment operator.
+    //! 
+    //! The copy preserves the file IDs assigned by the original.
+    //! 
+    //! @param other The TagMap to copy.
+    //! @returns A reference to this TagMap.
+    TagMap& operator=(const TagMap& other);
+
+    //! Move assignment operator.
+    //! 
+    //! @param other The TagMap to move from.
+    //! @returns A reference to this TagMap.
+    TagMap& operator=(TagMap&& other) = default;
+
     //! Tests equality of this TagMap and another.
     //! 
     //! TagMaps are equal if they describe identical files, tags, and file descriptors.
@@ -299,6 +378,8 @@ namespace ragtag {
     public:
       //! Path of the file.
       path_t path{};
+      //! ID of the file.
+      file_id_t id{ -1 };
       //! The file's rating or an empty optional if the file has no rating.
       std::optional<rating_t> rating{};
       //! Function that produces the TagSetting for a given tag on this file.
@@ -317,11 +398,229 @@ namespace ragtag {
     //! @returns The paths of files that satisfy the criteria.
     std::vector<path_t> selectFiles(const file_qualifier_t& fn) const;
 
+    //! Selects files in the TagMap based on specified criteria, producing their file IDs.
+    //! 
+    //! IDs are produced in the same order that selectFiles() produces paths.
+    //! 
+    //! @param fn File selection criteria.
+    //! @returns The IDs of files that satisfy the criteria.
+    std::vector<file_id_t> selectFileIds(const file_qualifier_t& fn) const;
+
+    //! Retrieves the IDs of all files in the TagMap.
+    //! 
+    //! IDs are produced in the same order that selectFiles() produces paths.
+    //! 
+    //! @returns The IDs of all files in the TagMap.
+    std::vector<file_id_t> getAllFileIds() const;
+
     //! Obtains the count of all files in the TagMap.
     //! 
     //! @returns The count of all files in the TagMap.
     int numFiles() const;
 
+    // UNTAGGED FILE QUEUE =========================================================================
+    //! Finds the nearest untagged file in the project forward or backward from a reference file,
+    //! wrapping around the ends of the project.
+    //! 
+    //! Untagged in this context refers to files whose tag coverage is anything other than
+    //! TagCoverage::ALL. Files are ordered by file ID. A loaded project assigns IDs in path order,
+    //! so the queue visits the untagged files of one directory before moving on to the next; files
+    //! added since come last. Beyond looking up the reference file, this is the same as
+    //! findUntaggedFileId().
+    //! 
+    //! The reference file needn't be untagged or even part of the TagMap. If it isn't part of the
+    //! TagMap, the search begins from the start (or end) of the project.
+    //! 
+    //! @param reference The file to look forward or backward from.
+    //! @param find_next If true, look forward; if false, look backward.
+    //! @returns The neighboring untagged file, the reference file itself if it's the only untagged
+    //!     file, or an empty optional if no file in the TagMap is untagged.
+    std::optional<path_t> findUntaggedFile(const path_t& reference, bool find_next) const;
+
+    //! Finds the nearest untagged file forward or backward from a reference file ID, wrapping
+    //! around the ends of the range of file IDs.
+    //! 
+    //! The queue is a bitmap over file IDs maintained as tags change, so a step scans only the
+    //! words between the reference and the next untagged file, taking constant time unless the
+    //! untagged files are far apart.
+    //! 
+    //! @param reference The file ID to look forward or backward from. Needn't belong to a file in
+    //!     the TagMap.
+    //! @param find_next If true, look forward; if false, look backward.
+    //! @returns The ID of the neighboring untagged file, the reference itself if it's the only
+    //!     untagged file, or an empty optional if no file in the TagMap is untagged.
+    std::optional<file_id_t> findUntaggedFileId(file_id_t reference, bool find_next) const;
+
+    //! Obtains the count of untagged files in the TagMap.
+    //! 
+    //! @returns The number of files whose tag coverage is anything other than TagCoverage::ALL.
+    int numUntaggedFiles() const;
+
+    // TAG FACETS ==================================================================================
+    //! Counts how many files of a selection have each setting of each tag.
+    //! 
+    //! The TagMap keeps a bitmap over file IDs of the files set to YES and another of the files set
+    //! to NO for every tag, so the counts come from intersecting those bitmaps with a bitmap of the
+    //! selection and counting bits rather than looking up each file's tags. The cost is O(n + t *
+    //! N / 64) for n selected files, t tags, and N files in the TagMap.
+    //! 
+    //! @param file_ids The IDs of the selected files. IDs that don't belong to a file in the TagMap
+    //!     are ignored, as are repeated IDs.
+    //! @returns The counts for each registered tag.
+    std::map<tag_t, TagSettingCounts> countTagSettings(
+      const std::vector<file_id_t>& file_ids) const;
+
+    //! Selects the files that satisfy all or any of a set of tag constraints.
+    //! 
+    //! The constraints are evaluated together in a single pass over the tag membership bitmaps,
+    //! combining 64 files at a time, so the cost grows with the number of constraints times N / 64
+    //! for N files in the TagMap rather than with the number of constraints times N.
+    //! 
+    //! @param constraints The constraints to evaluate. Constraints on unregistered tags treat the
+    //!     tag as set on no file.
+    //! @param match_all True to select files satisfying every constraint; false to select files
+    //!     satisfying at least one. With no constraints, every file is selected if true and none
+    //!     if false.
+    //! @returns The IDs of the selected files in ascending order.
+    std::vector<file_id_t> selectFileIdsByTags(const std::vector<TagConstraint>& constraints,
+      bool match_all) const;
+
+    // QUERIES =====================================================================================
+    //! Selects one window of the files satisfying specified criteria, in a specified order.
+    //! 
+    //! Only the window is materialized. Ordering by path walks the files in their stored order and
+    //! stops at the end of the window, so a page costs time proportional to its offset plus its
+    //! size. Other orders keep a bounded heap of the best `offset + limit` files while scanning, so
+    //! the top K files cost O(N log K) time and O(K) space for N files in the TagMap. Files with
+    //! equal keys are ordered by path, so consecutive pages neither repeat nor skip files.
+    //! 
+    //! @param fn File selection criteria. If empty, every file qualifies.
+    //! @param options Order of the results and the window of them to produce.
+    //! @returns The IDs of the files within the window, in order.
+    std::vector<file_id_t> queryFileIds(const file_qualifier_t& fn,
+      const QueryOptions& options) const;
+
+    //! Selects the files whose paths contain a substring, ignoring case.
+    //! 
+    //! The TagMap keeps a trigram index of its paths up to date as files are added and removed, so
+    //! only the paths containing every three-character sequence of the substring are compared
+    //! against it, rather than every path in the TagMap.
+    //! 
+    //! @param substring The substring to search for. Substrings shorter than three characters are
+    //!     compared against every path.
+    //! @returns The IDs of the matching files in ascending order.
+    std::vector<file_id_t> selectFileIdsByPath(const std::wstring& substring) const;
+
+    //! Selects files uniformly at random among those satisfying specified criteria.
+    //! 
+    //! Files are reservoir sampled in a single pass, so only the sample is ever held in memory.
+    //! 
+    //! @param fn File selection criteria. If empty, every file qualifies.
+    //! @param count The number of files to select. If fewer files qualify, all of them are
+    //!     selected.
+    //! @param seed Seed for the random number generator. The same seed selects the same files from
+    //!     the same TagMap every time on a given platform.
+    //! @returns The IDs of the selected files, in the same order that selectFileIds() produces IDs.
+    std::vector<file_id_t> sampleFileIds(const file_qualifier_t& fn, int count,
+      std::uint64_t seed) const;
+
+    //! Selects files uniformly at random among those satisfying all or any of a set of tag
+    //! constraints.
+    //! 
+    //! The constraints are combined as in selectFileIdsByTags(), but rather than listing every
+    //! match, random ranks are chosen among the matches and each is found by counting bits a word
+    //! at a time.
+    //! 
+    //! @param constraints The constraints to evaluate, as in selectFileIdsByTags().
+    //! @param match_all True to sample files satisfying every constraint; false to sample files
+    //!     satisfying at least one.
+    //! @param count The number of files to select. If fewer files match, all of them are selected.
+    //! @param seed Seed for the random number generator. The same seed selects the same files from
+    //!     the same TagMap every time on a given platform.
+    //! @returns The IDs of the selected files in ascending order.
+    std::vector<file_id_t> sampleFileIdsByTags(const std::vector<TagConstraint>& constraints,
+      bool match_all, int count, std::uint64_t seed) const;
+
+    // COUNTS ======================================================================================
+    //! Obtains how many files in the TagMap have each setting of a tag.
+    //! 
+    //! The counts are maintained as tags change, so this takes O(log t) time for t tags.
+    //! 
+    //! @param tag The tag of interest.
+    //! @returns The counts for the tag, or an empty optional if the tag isn't registered.
+    std::optional<TagSettingCounts> getTagSettingCounts(const tag_t& tag) const;
+
+    //! Counts the rated files with ratings within a range.
+    //! 
+    //! The number of files with each distinct rating is maintained as ratings change, so this takes
+    //! time proportional to the number of distinct ratings in the range rather than the number of
+    //! files.
+    //! 
+    //! @param min_rating The lowest rating to count, inclusive.
+    //! @param max_rating The highest rating to count, inclusive.
+    //! @returns The number of files rated from `min_rating` to `max_rating`.
+    int countRatedFiles(rating_t min_rating, rating_t max_rating) const;
+
+    //! Counts the files satisfying specified criteria without collecting them.
+    //! 
+    //! A single FileInfo is reused for every file, so nothing is allocated per file beyond what
+    //! copying its path requires.
+    //! 
+    //! @param fn File selection criteria. If empty, every file qualifies.
+    //! @returns The number of files that satisfy the criteria.
+    int countFiles(const file_qualifier_t& fn) const;
+
+    //! Counts the files satisfying all or any of a set of tag constraints without collecting them.
+    //! 
+    //! The constraints are combined as in selectFileIdsByTags(), and matches are counted a word at
+    //! a time as the combined bitmap is produced rather than stored.
+    //! 
+    //! @param constraints The constraints to evaluate, as in selectFileIdsByTags().
+    //! @param match_all True to count files satisfying every constraint; false to count files
+    //!     satisfying at least one.
+    //! @returns The number of files satisfying the constraints.
+    int countFilesByTags(const std::vector<TagConstraint>& constraints, bool match_all) const;
+
+    // FILE ID OPERATIONS ==========================================================================
+    //! Retrieves the ID assigned to a file.
+    //! 
+    //! @param path The path of the file to retrieve the ID of.
+    //! @returns The ID of the file or an empty optional if the file is not in the TagMap.
+    std::optional<file_id_t> getFileId(const path_t& path) const;
+
+    //! Retrieves the path of the file with a given ID.
+    //! 
+    //! @param id The ID of the file.
+    //! @returns The path of the file or an empty optional if no file in the TagMap has this ID.
+    std::optional<path_t> getFilePath(file_id_t id) const;
+
+    //! Retrieves a tag setting for the file with a given ID.
+    //! 
+    //! Equivalent to getTagSetting() but without the path lookup.
+    //! 
+    //! @param id The ID of the file to retrieve a tag setting for.
+    //! @param tag The tag of interest.
+    //! @returns The TagSetting for this tag on this file or an empty optional if the retrieval
+    //!     of this information fails.
+    std::optional<TagSetting> getTagSetting(file_id_t id, const tag_t& tag) const;
+
+    //! Retrieves the rating for the file with a given ID.
+    //! 
+    //! Equivalent to getRating() but without the path lookup.
+    //! 
+    //! @param id The ID of the file to retrieve the rating of.
+    //! @returns The rating assigned to this file or an empty optional in the case that either the
+    //!     lookup fails or the file has no rating assigned.
+    std::optional<rating_t> getRating(file_id_t id) const;
+
+    //! Obtains the exclusive upper bound of file IDs assigned by this TagMap.
+    //! 
+    //! All valid file IDs are nonnegative and less than this value, which makes it suitable for
+    //! sizing containers indexed by file ID. Not every ID below the bound is necessarily in use.
+    //! 
+    //! @returns One more than the largest file ID assigned so far.
+    file_id_t fileIdLimit() const;
+
     // READING AND WRITING =========================================================================
     //! Generate and retrieve a JSON representation of this TagMap.
     //!
@@ -351,6 +650,11 @@ namespace ragtag {
   private:
     //! Internal helper struct to collect properties associated with files.
     struct FileProperties {
+      //! ID assigned to the file when it was added to the TagMap.
+      //! 
+      //! IDs are bookkeeping rather than description, so they don't participate in equality tests.
+      file_id_t id{};
+
       //! File rating or an empty optional if no rating.
       std::optional<rating_t> rating;
 
@@ -393,11 +697,128 @@ namespace ragtag {
     //! @returns The wide-string equivalent of the input string.
     static std::wstring toWString(const std::string& string);
 
+    //! Tests a file against file selection criteria.
+    //! 
+    //! @param file The entry of `file_map_` to test.
+    //! @param fn File selection criteria. If empty, every file qualifies.
+    //! @returns True if the file satisfies the criteria.
+    static bool qualifies(const std::pair<const path_t, FileProperties>& file,
+      const file_qualifier_t& fn);
+
+    //! Rebuilds `files_by_id_` so that it refers to the entries of `file_map_`.
+    //! 
+    //! `files_by_id_` must already have the correct size. Needed after copying, since the copied
+    //! lookup table would otherwise refer to the entries of the original TagMap.
+    void rebuildFileIdLookup();
+
+    //! Sets or clears a file's bit in `untagged_files_` according to its current tags.
+    //! 
+    //! @param file The entry of `file_map_` to re-evaluate.
+    void updateUntaggedFile(const std::pair<const path_t, FileProperties>& file);
+
+    //! Type of one block of the tag membership bitmaps.
+    typedef std::uint64_t bitmap_word_t;
+
+    //! Bitmaps over file IDs of the files having a committed setting of one tag.
+    struct TagMembership {
+      //! Files for which the tag is set to TagSetting::YES.
+      std::vector<bitmap_word_t> yes{};
+      //! Files for which the tag is set to TagSetting::NO.
+      std::vector<bitmap_word_t> no{};
+      //! Number of bits set in `yes`.
+      int num_yes{ 0 };
+      //! Number of bits set in `no`.
+      int num_no{ 0 };
+    };
+
+    //! Records the setting of a tag on a file within `tag_membership_`.
+    //! 
+    //! @param id The ID of the file.
+    //! @param tag The tag whose setting changed. Must be registered.
+    //! @param setting The new setting of the tag on the file.
+    void updateTagMembership(file_id_t id, const tag_t& tag, TagSetting setting);
+
+    //! Sets or clears one bit of a bitmap, growing the bitmap if needed.
+    //! 
+    //! @param bitmap The bitmap to modify.
+    //! @param id The ID of the file corresponding to the bit.
+    //! @param value The new value of the bit.
+    //! @returns True if the bit changed.
+    static bool setBit(std::vector<bitmap_word_t>& bitmap, file_id_t id, bool value);
+
+    //! Finds the first bit set in a bitmap at or after a given position.
+    //! 
+    //! @param bitmap The bitmap to search.
+    //! @param from The position to start from. Negative positions count as zero.
+    //! @returns The position of the bit, or an empty optional if no such bit is set.
+    static std::optional<file_id_t> findNextBit(const std::vector<bitmap_word_t>& bitmap,
+      file_id_t from);
+
+    //! Finds the last bit set in a bitmap at or before a given position.
+    //! 
+    //! @param bitmap The bitmap to search.
+    //! @param to The position to start from, searching backward.
+    //! @returns The position of the bit, or an empty optional if no such bit is set.
+    static std::optional<file_id_t> findPreviousBit(const std::vector<bitmap_word_t>& bitmap,
+      file_id_t to);
+
+    //! Adjusts the number of files recorded within `rating_counts_` as having a rating.
+    //! 
+    //! @param rating The rating, or an empty optional to do nothing.
+    //! @param delta The amount to adjust the count by.
+    void updateRatingCount(std::optional<rating_t> rating, int delta);
+
+    //! Combines a set of tag constraints word by word into a bitmap of the files satisfying them,
+    //! handing each word to a function rather than storing the bitmap.
+    //! 
+    //! @param constraints The constraints to evaluate, as in selectFileIdsByTags().
+    //! @param match_all True to require every constraint; false to require at least one.
+    //! @param fn Function receiving the index of each word of the bitmap and the word itself, in
+    //!     increasing order of index.
+    void forEachMatchingWord(const std::vector<TagConstraint>& constraints, bool match_all,
+      const std::function<void(size_t, bitmap_word_t)>& fn) const;
+
+    //! Counts the bits set in both of two bitmaps.
+    //! 
+    //! @param lhs One bitmap.
+    //! @param rhs The other bitmap.
+    //! @returns The number of bits set in both.
+    static int countCommonBits(const std::vector<bitmap_word_t>& lhs,
+      const std::vector<bitmap_word_t>& rhs);
+
+    //! Re-evaluates every file for `untagged_files_`. Needed after a tag is deleted, since that can
+    //! complete any file at once.
+    void rebuildUntaggedFiles();
+
     //! Map of all tags and associated properties.
     std::map<tag_t, TagProperties> tag_registry_{};
 
     //! Map of all files and associated properties.
     std::map<std::filesystem::path, FileProperties> file_map_{};
+
+    //! Lookup table from file ID to the corresponding entry of `file_map_`.
+    //! 
+    //! Entries for files that have been removed are null.
+    std::vector<std::pair<const path_t, FileProperties>*> files_by_id_{};
+
+    //! Bitmap over file IDs of all files in the TagMap.
+    std::vector<bitmap_word_t> live_files_{};
+
+    //! Bitmap over file IDs of all files whose tag coverage is anything other than
+    //! TagCoverage::ALL.
+    std::vector<bitmap_word_t> untagged_files_{};
+
+    //! Number of bits set in `untagged_files_`.
+    int num_untagged_files_{ 0 };
+
+    //! Membership bitmaps of every registered tag.
+    std::map<tag_t, TagMembership> tag_membership_{};
+
+    //! Number of files with each distinct rating. Ratings no file has are absent.
+    std::map<rating_t, int> rating_counts_{};
+
+    //! Index of the paths of all files, keyed by file ID.
+    PathTrigramIndex path_index_{};
   };
 }  // namespace ragtag
 
@@ -0,0 +1,503 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#include "zip_exporter.h"
+#include <algorithm>
+#include <ctime>
+#include <cwctype>
+#include <filesystem>
+#include <set>
+#include <zlib.h>
+
+namespace {
+  const std::uint32_t LOCAL_HEADER_SIGNATURE = 0x04034b50;
+  const std::uint32_t DATA_DESCRIPTOR_SIGNATURE = 0x08074b50;
+  const std::uint32_t CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+  const std::uint32_t ZIP64_END_SIGNATURE = 0x06064b50;
+  const std::uint32_t ZIP64_LOCATOR_SIGNATURE = 0x07064b50;
+  const std::uint32_t END_SIGNATURE = 0x06054b50;
+
+  // ZIP64 requires version 4.5 of the format.
+  const std::uint16_t VERSION = 45;
+  // Bit 3: sizes and CRC follow the data. Bit 11: names are UTF-8.
+  const std::uint16_t FLAGS = 0x0808;
+  const std::uint16_t METHOD_STORED = 0;
+  const std::uint16_t METHOD_DEFLATED = 8;
+  const std::uint16_t ZIP64_EXTRA_ID = 0x0001;
+  // Placeholder for a field whose value is given in the ZIP64 extra field instead.
+  const std::uint32_t IN_ZIP64_EXTRA = 0xffffffff;
+
+  // Largest distance deflate can refer back, and so the most of the preceding data worth priming
+  // a compressor with.
+  const std::size_t DEFLATE_WINDOW_SIZE = 32768;
+
+  void put16(std::string& out, const std::uint16_t value) {
+    out += static_cast<char>(value & 0xff);
+    out += static_cast<char>(value >> 8);
+  }
+
+  void put32(std::string& out, const std::uint32_t value) {
+    put16(out, static_cast<std::uint16_t>(value & 0xffff));
+    put16(out, static_cast<std::uint16_t>(value >> 16));
+  }
+
+  void put64(std::string& out, const std::uint64_t value) {
+    put32(out, static_cast<std::uint32_t>(value & 0xffffffff));
+    put32(out, static_cast<std::uint32_t>(value >> 32));
+  }
+
+  // Converts a last-write time to the local date and time fields of a ZIP entry.
+  void toDosDateTime(const std::filesystem::file_time_type time, std::uint16_t& dos_date,
+    std::uint16_t& dos_time) {
+    const auto system_time = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+      std::chrono::file_clock::to_sys(time));
+    const std::time_t seconds = std::chrono::system_clock::to_time_t(system_time);
+    const std::tm* local = std::localtime(&seconds);
+    if (local == nullptr || local->tm_year < 80 || local->tm_year > 80 + 127) {
+      // Out of the format's range, 1980 through 2107.
+      dos_date = (1 << 5) | 1;
+      dos_time = 0;
+      return;
+    }
+    dos_date = static_cast<std::uint16_t>(((local->tm_year - 80) << 9) | ((local->tm_mon + 1) << 5)
+      | local->tm_mday);
+    dos_time = static_cast<std::uint16_t>((local->tm_hour << 11) | (local->tm_min << 5)
+      | (local->tm_sec / 2));
+  }
+}  // namespace
+
+namespace ragtag {
+  ZipExporter::ZipExporter(const ZipOptions& options) : options_(options) {}
+
+  ZipExporter::~ZipExporter() {
+    cancel();
+    if (coordinator_.joinable()) {
+      coordinator_.join();
+    }
+  }
+
+  void ZipExporter::start(std::vector<CopyJob> jobs, const path_t& archive) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (is_running_) {
+        return;
+      }
+      is_running_ = true;
+    }
+    if (coordinator_.joinable()) {
+      coordinator_.join();
+    }
+
+    archive_path_ = archive;
+    is_canceled_ = false;
+    bytes_done_ = 0;
+    bytes_total_ = 0;
+    files_done_ = 0;
+    files_total_ = static_cast<int>(jobs.size());
+    report_ = CopyReport();
+    report_.results.reserve(jobs.size());
+    std::set<std::u8string> names;
+    for (auto& job : jobs) {
+      CopyResult result;
+      result.job = std::move(job);
+      if (!names.insert(result.job.destination.lexically_normal().generic_u8string()).second) {
+        // An archive can't hold two entries with the same path.
+        result.outcome = CopyOutcome::CONFLICTED;
+        ++files_done_;
+      }
+      report_.results.push_back(std::move(result));
+    }
+
+    coordinator_ = std::thread(&ZipExporter::runBatch, this);
+  }
+
+  bool ZipExporter::waitFor(const std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return finished_.wait_for(lock, timeout, [this]() {return !is_running_;});
+  }
+
+  CopyProgress ZipExporter::getProgress() const {
+    CopyProgress progress;
+    progress.bytes_done = bytes_done_;
+    progress.bytes_total = bytes_total_;
+    progress.files_done = files_done_;
+    progress.files_total = files_total_;
+    return progress;
+  }
+
+  void ZipExporter::cancel() {
+    is_canceled_ = true;
+  }
+
+  CopyReport ZipExporter::takeReport() {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      finished_.wait(lock, [this]() {return !is_running_;});
+    }
+    if (coordinator_.joinable()) {
+      coordinator_.join();
+    }
+    CopyReport report = std::move(report_);
+    report_ = CopyReport();
+    return report;
+  }
+
+  CopyReport ZipExporter::run(std::vector<CopyJob> jobs, const path_t& archive,
+    const ZipOptions& options) {
+    ZipExporter exporter(options);
+    exporter.start(std::move(jobs), archive);
+    return exporter.takeReport();
+  }
+
+  bool ZipExporter::isStoredFormat(const path_t& path) {
+    static const std::set<std::wstring> STORED_EXTENSIONS = {
+      // Video
+      L".3gp", L".avi", L".flv", L".m2ts", L".m4v", L".mkv", L".mov", L".mp4", L".mpeg", L".mpg",
+      L".mts", L".webm", L".wmv",
+      // Audio
+      L".aac", L".flac", L".m4a", L".mp3", L".ogg", L".opus", L".wma",
+      // Images
+      L".avif", L".gif", L".heic", L".heif", L".jpeg", L".jpg", L".png", L".webp",
+      // Archives
+      L".7z", L".bz2", L".gz", L".rar", L".xz", L".zip"
+    };
+    std::wstring extension = path.extension().wstring();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](const wchar_t c) {
+      return static_cast<wchar_t>(std::towlower(c));
+      });
+    return STORED_EXTENSIONS.count(extension) > 0;
+  }
+
+  void ZipExporter::runBatch() {
+    auto& results = report_.results;  // Alias for convenience
+
+    std::uintmax_t bytes_total = 0;
+    for (auto& result : results) {
+      if (result.outcome != CopyOutcome::CANCELED) {
+        continue;
+      }
+      std::error_code error;
+      const auto size = std::filesystem::file_size(result.job.source, error);
+      if (error) {
+        result.outcome = CopyOutcome::FAILED;
+        result.error = error;
+        ++files_done_;
+        continue;
+      }
+      result.bytes = size;
+      bytes_total += size;
+    }
+    bytes_total_ = bytes_total;
+
+    bool is_writable = false;
+    std::uint64_t archive_size = 0;
+    {
+      std::ofstream archive(archive_path_, std::ios::binary | std::ios::trunc);
+      is_writable = static_cast<bool>(archive);
+      std::vector<CentralEntry> entries;
+      std::vector<Block> blocks(std::max(options_.num_threads, 1));
+      for (auto& result : results) {
+        if (!is_writable || is_canceled_) {
+          break;
+        }
+        if (result.outcome == CopyOutcome::CANCELED) {
+          is_writable = addFile(result, archive, blocks, entries);
+        }
+      }
+      if (is_writable && !is_canceled_) {
+        writeCentralDirectory(archive, entries);
+        archive_size = static_cast<std::uint64_t>(archive.tellp());
+      }
+      archive.close();
+      is_writable = is_writable && !archive.fail();
+    }
+
+    std::error_code error;
+    if (is_writable && !is_canceled_) {
+      // Files that failed partway through were overwritten by whatever came next, but the last of
+      // them could have left data past the end.
+      std::filesystem::resize_file(archive_path_, archive_size, error);
+      is_writable = !error;
+    }
+    if (!is_writable || is_canceled_) {
+      // Nothing was added after all.
+      std::filesystem::remove(archive_path_, error);
+      for (auto& result : results) {
+        if (is_canceled_ && result.outcome == CopyOutcome::COPIED) {
+          result.outcome = CopyOutcome::CANCELED;
+        }
+        else if (!is_canceled_ && (result.outcome == CopyOutcome::COPIED
+          || result.outcome == CopyOutcome::CANCELED)) {
+          result.outcome = CopyOutcome::FAILED;
+          result.error = std::make_error_code(std::errc::io_error);
+        }
+      }
+    }
+
+    report_.was_canceled = is_canceled_ && report_.count(CopyOutcome::CANCELED) > 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      is_running_ = false;
+    }
+    finished_.notify_all();
+  }
+
+  bool ZipExporter::addFile(CopyResult& result, std::ofstream& archive,
+    std::vector<Block>& blocks, std::vector<CentralEntry>& entries) {
+    const CopyJob& job = result.job;  // Alias for convenience
+    std::uintmax_t bytes_read = 0;
+    const auto finish = [&](const CopyOutcome outcome) {
+      result.outcome = outcome;
+      if (outcome == CopyOutcome::FAILED && result.bytes > bytes_read) {
+        bytes_done_ += result.bytes - bytes_read;
+      }
+      ++files_done_;
+      };
+
+    std::error_code error;
+    const auto write_time = std::filesystem::last_write_time(job.source, error);
+    std::ifstream source(job.source, std::ios::binary);
+    if (error || !source) {
+      result.error = error ? error : std::make_error_code(std::errc::io_error);
+      finish(CopyOutcome::FAILED);
+      return true;
+    }
+
+    CentralEntry entry;
+    const std::u8string name = job.destination.lexically_normal().generic_u8string();
+    entry.name.assign(name.begin(), name.end());
+    entry.offset = static_cast<std::uint64_t>(archive.tellp());
+    entry.method = isStoredFormat(job.source) ? METHOD_STORED : METHOD_DEFLATED;
+    toDosDateTime(write_time, entry.dos_date, entry.dos_time);
+
+    std::string header;
+    put32(header, LOCAL_HEADER_SIGNATURE);
+    put16(header, VERSION);
+    put16(header, FLAGS);
+    put16(header, entry.method);
+    put16(header, entry.dos_time);
+    put16(header, entry.dos_date);
+    put32(header, 0);  // CRC-32, given in the data descriptor
+    put32(header, IN_ZIP64_EXTRA);
+    put32(header, IN_ZIP64_EXTRA);
+    put16(header, static_cast<std::uint16_t>(entry.name.size()));
+    put16(header, 20);  // Length of the extra field
+    header += entry.name;
+    put16(header, ZIP64_EXTRA_ID);
+    put16(header, 16);
+    put64(header, 0);  // Sizes, given in the data descriptor
+    put64(header, 0);
+    if (!archive.write(header.data(), header.size())) {
+      return false;
+    }
+
+    std::string dictionary;
+    bool is_done = false;
+    while (!is_done) {
+      if (is_canceled_) {
+        finish(CopyOutcome::CANCELED);
+        return true;
+      }
+
+      // Read a round of blocks, one per thread.
+      std::size_t num_blocks = 0;
+      while (num_blocks < blocks.size() && !is_done) {
+        Block& block = blocks[num_blocks++];
+        block.input.resize(std::max(options_.block_size, static_cast<std::size_t>(1)));
+        source.read(block.input.data(), static_cast<std::streamsize>(block.input.size()));
+        block.input.resize(static_cast<std::size_t>(source.gcount()));
+        if (source.bad()) {
+          // Abandon the entry. The next one will be written over it.
+          archive.seekp(static_cast<std::streamoff>(entry.offset));
+          result.error = std::make_error_code(std::errc::io_error);
+          finish(CopyOutcome::FAILED);
+          return static_cast<bool>(archive);
+        }
+        block.is_last = source.eof()
+          || source.peek() == std::ifstream::traits_type::eof();
+        is_done = block.is_last;
+      }
+
+      if (entry.method == METHOD_DEFLATED) {
+        // Each block is primed with the end of the block before it, which is the data its
+        // back-references may reach.
+        std::vector<std::string> dictionaries(num_blocks);
+        dictionaries[0] = dictionary;
+        for (std::size_t i = 1; i < num_blocks; ++i) {
+          const std::string& previous = blocks[i - 1].input;
+          dictionaries[i] = previous.substr(previous.size()
+            - std::min(previous.size(), DEFLATE_WINDOW_SIZE));
+        }
+        std::vector<std::thread> threads;
+        threads.reserve(num_blocks - 1);
+        for (std::size_t i = 1; i < num_blocks; ++i) {
+          threads.emplace_back([&, i]() {
+            deflateBlock(blocks[i], dictionaries[i], options_.compression_level);
+            });
+        }
+        deflateBlock(blocks[0], dictionaries[0], options_.compression_level);  // Our share
+        for (auto& thread : threads) {
+          thread.join();
+        }
+      }
+      else {
+        for (std::size_t i = 0; i < num_blocks; ++i) {
+          Block& block = blocks[i];
+          block.crc = static_cast<std::uint32_t>(crc32(0L,
+            reinterpret_cast<const Bytef*>(block.input.data()),
+            static_cast<uInt>(block.input.size())));
+          block.is_ok = true;
+        }
+      }
+
+      for (std::size_t i = 0; i < num_blocks; ++i) {
+        const Block& block = blocks[i];
+        if (!block.is_ok) {
+          archive.seekp(static_cast<std::streamoff>(entry.offset));
+          result.error = std::make_error_code(std::errc::not_enough_memory);
+          finish(CopyOutcome::FAILED);
+          return static_cast<bool>(archive);
+        }
+        const std::string& data = entry.method == METHOD_DEFLATED ? block.output : block.input;
+        if (!archive.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+          return false;
+        }
+        entry.crc = static_cast<std::uint32_t>(crc32_combine(entry.crc, block.crc,
+          static_cast<z_off_t>(block.input.size())));
+        entry.compressed_size += data.size();
+        entry.size += block.input.size();
+        bytes_read += block.input.size();
+        bytes_done_ += block.input.size();
+      }
+      const std::string& last_input = blocks[num_blocks - 1].input;
+      dictionary = last_input.substr(last_input.size()
+        - std::min(last_input.size(), DEFLATE_WINDOW_SIZE));
+    }
+
+    std::string descriptor;
+    put32(descriptor, DATA_DESCRIPTOR_SIGNATURE);
+    put32(descriptor, entry.crc);
+    put64(descriptor, entry.compressed_size);
+    put64(descriptor, entry.size);
+    if (!archive.write(descriptor.data(), descriptor.size())) {
+      return false;
+    }
+
+    entries.push_back(std::move(entry));
+    finish(CopyOutcome::COPIED);
+    return true;
+  }
+
+  void ZipExporter::deflateBlock(Block& block, const std::string& dictionary, const int level) {
+    block.is_ok = false;
+    block.crc = static_cast<std::uint32_t>(crc32(0L,
+      reinterpret_cast<const Bytef*>(block.input.data()), static_cast<uInt>(block.input.size())));
+
+    // Negative window bits produce raw deflate data, without the zlib wrapper ZIP doesn't use.
+    z_stream stream{};
+    if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+      return;
+    }
+    if (!dictionary.empty()) {
+      deflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(dictionary.data()),
+        static_cast<uInt>(dictionary.size()));
+    }
+
+    // A sync flush ends the block on a byte boundary without ending the stream, so the next
+    // block's data can follow directly. Only the file's last block ends the stream.
+    const int flush = block.is_last ? Z_FINISH : Z_SYNC_FLUSH;
+    block.output.resize(deflateBound(&stream, static_cast<uLong>(block.input.size())) + 64);
+    stream.next_in = reinterpret_cast<Bytef*>(block.input.data());
+    stream.avail_in = static_cast<uInt>(block.input.size());
+    while (true) {
+      stream.next_out = reinterpret_cast<Bytef*>(block.output.data()) + stream.total_out;
+      stream.avail_out = static_cast<uInt>(block.output.size() - stream.total_out);
+      const int status = deflate(&stream, flush);
+      if (status == Z_STREAM_ERROR) {
+        break;
+      }
+      if (block.is_last ? status == Z_STREAM_END
+        : stream.avail_in == 0 && stream.avail_out > 0) {
+        block.is_ok = true;
+        break;
+      }
+      block.output.resize(block.output.size() * 2);
+    }
+    block.output.resize(stream.total_out);
+    deflateEnd(&stream);
+  }
+
+  void ZipExporter::writeCentralDirectory(std::ofstream& archive,
+    const std::vector<CentralEntry>& entries) {
+    const std::uint64_t directory_offset = static_cast<std::uint64_t>(archive.tellp());
+    std::string directory;
+    for (const auto& entry : entries) {
+      put32(directory, CENTRAL_HEADER_SIGNATURE);
+      put16(directory, VERSION);  // Version made by
+      put16(directory, VERSION);  // Version needed to extract
+      put16(directory, FLAGS);
+      put16(directory, entry.method);
+      put16(directory, entry.dos_time);
+      put16(directory, entry.dos_date);
+      put32(directory, entry.crc);
+      put32(directory, IN_ZIP64_EXTRA);
+      put32(directory, IN_ZIP64_EXTRA);
+      put16(directory, static_cast<std::uint16_t>(entry.name.size()));
+      put16(directory, 28);  // Length of the extra field
+      put16(directory, 0);  // Length of the comment
+      put16(directory, 0);  // Disk number
+      put16(directory, 0);  // Internal attributes
+      put32(directory, 0);  // External attributes
+      put32(directory, IN_ZIP64_EXTRA);
+      directory += entry.name;
+      put16(directory, ZIP64_EXTRA_ID);
+      put16(directory, 24);
+      put64(directory, entry.size);
+      put64(directory, entry.compressed_size);
+      put64(directory, entry.offset);
+    }
+
+    const std::uint64_t zip64_end_offset = directory_offset + directory.size();
+    std::string end;
+    put32(end, ZIP64_END_SIGNATURE);
+    put64(end, 44);  // Size of the rest of this record
+    put16(end, VERSION);
+    put16(end, VERSION);
+    put32(end, 0);  // This disk
+    put32(end, 0);  // Disk holding the central directory
+    put64(end, entries.size());
+    put64(end, entries.size());
+    put64(end, directory.size());
+    put64(end, directory_offset);
+
+    put32(end, ZIP64_LOCATOR_SIGNATURE);
+    put32(end, 0);  // Disk holding the ZIP64 end record
+    put64(end, zip64_end_offset);
+    put32(end, 1);  // Total number of disks
+
+    // The classic end record defers to the ZIP64 one.
+    put32(end, END_SIGNATURE);
+    put16(end, 0);
+    put16(end, 0);
+    put16(end, 0xffff);
+    put16(end, 0xffff);
+    put32(end, IN_ZIP64_EXTRA);
+    put32(end, IN_ZIP64_EXTRA);
+    put16(end, 0);  // Length of the comment
+
+    archive.write(directory.data(), static_cast<std::streamsize>(directory.size()));
+    archive.write(end.data(), static_cast<std::streamsize>(end.size()));
+  }
+}  // namespace ragtag
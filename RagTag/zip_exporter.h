@@ -0,0 +1,213 @@
+// Copyright (C) 2025 by Edward Foley
+//
+// This file is part of RagTag.
+//
+// RagTag is free software: you can redistribute it and/or modify it under the terms of the GNU
+// General Public License as published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// RagTag is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+// the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with RagTag. If not, see
+// <https://www.gnu.org/licenses/>.
+
+#ifndef INCLUDE_ZIP_EXPORTER_H
+#define INCLUDE_ZIP_EXPORTER_H
+
+#include "copy_engine.h"
+#include "tag_map.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace ragtag {
+  //! Settings controlling how a ZipExporter goes about its work.
+  struct ZipOptions {
+    //! Number of blocks compressed concurrently.
+    int num_threads{ 4 };
+    //! Amount of each file compressed as a unit. Progress is reported and cancellation is checked
+    //! after each round of blocks.
+    std::size_t block_size{ 1 << 20 };
+    //! zlib compression level, from 1 (fastest) to 9 (smallest).
+    int compression_level{ 6 };
+  };
+
+  //! Writes a batch of files straight into a ZIP archive on a background thread.
+  //! 
+  //! The archive is written in one sequential pass, with no temporary copies of the files. Each
+  //! file is compressed in blocks on several threads at once in the manner of pigz: every block is
+  //! deflated independently (primed with the end of the block before it, so little compression is
+  //! lost) and flushed to a byte boundary, so the blocks' output can simply be concatenated.
+  //! Formats that are already compressed, such as most video, audio, and image files, are stored
+  //! as they are, since deflating them again costs time and saves nothing.
+  //! 
+  //! Archives always use ZIP64 records, so neither the files nor the archive are limited to 4 GB.
+  //! Entries are written with data descriptors so that nothing need be known about a file before
+  //! it's read. Names are stored as UTF-8.
+  //! 
+  //! Jobs name a file to add and the path it's given within the archive. A file that can't be read
+  //! is left out and the rest of the archive is written regardless. If the archive itself can't be
+  //! written, or the batch is canceled, the partial archive is deleted.
+  //! 
+  //! Progress and cancellation may be used from any thread while a batch runs.
+  class ZipExporter {
+  public:
+    //! Constructor.
+    //! 
+    //! @param options Settings applied to every archive the exporter writes.
+    explicit ZipExporter(const ZipOptions& options);
+
+    //! Destructor. Cancels any batch in progress and waits for it to stop.
+    ~ZipExporter();
+
+    ZipExporter(const ZipExporter&) = delete;
+    ZipExporter& operator=(const ZipExporter&) = delete;
+
+    //! Begins writing an archive in the background. Has no effect if a batch is already running.
+    //! 
+    //! @param jobs The files to add. Each job's destination is the entry's path within the
+    //!     archive, which must be relative.
+    //! @param archive The archive to create. Any existing file at this path is replaced.
+    void start(std::vector<CopyJob> jobs, const path_t& archive);
+
+    //! Waits a limited time for the running batch to finish.
+    //! 
+    //! @param timeout The longest time to wait.
+    //! @returns True if no batch is running or unfinished.
+    bool waitFor(std::chrono::milliseconds timeout);
+
+    //! Obtains the running totals of the current or most recent batch.
+    //! 
+    //! @returns The progress so far.
+    CopyProgress getProgress() const;
+
+    //! Asks the running batch to stop as soon as possible. The partial archive is deleted.
+    void cancel();
+
+    //! Waits for the current batch to finish and hands over its results.
+    //! 
+    //! @returns The results of the batch, in which added files are marked COPIED. Empty if start()
+    //!     wasn't called since the last report.
+    CopyReport takeReport();
+
+    //! Writes an archive, blocking until done.
+    //! 
+    //! @param jobs The files to add and their paths within the archive.
+    //! @param archive The archive to create.
+    //! @param options Settings controlling the archive.
+    //! @returns The results of the batch.
+    static CopyReport run(std::vector<CopyJob> jobs, const path_t& archive,
+      const ZipOptions& options);
+
+    //! Determines whether a file is of a format that's already compressed and should be stored
+    //! as is.
+    //! 
+    //! @param path The file of interest.
+    //! @returns True if the file's extension denotes a compressed format.
+    static bool isStoredFormat(const path_t& path);
+
+  private:
+    //! An entry as recorded in the archive's central directory.
+    struct CentralEntry {
+      //! UTF-8 path of the entry within the archive.
+      std::string name{};
+      //! Offset of the entry's local header from the start of the archive.
+      std::uint64_t offset{ 0 };
+      //! CRC-32 of the uncompressed data.
+      std::uint32_t crc{ 0 };
+      //! Size of the entry's data as stored.
+      std::uint64_t compressed_size{ 0 };
+      //! Size of the entry's data once extracted.
+      std::uint64_t size{ 0 };
+      //! Compression method: 0 for stored, 8 for deflated.
+      std::uint16_t method{ 0 };
+      //! Last-write time of the source in MS-DOS format.
+      std::uint16_t dos_time{ 0 };
+      //! Last-write date of the source in MS-DOS format.
+      std::uint16_t dos_date{ 0 };
+    };
+
+    //! A span of a file compressed as a unit.
+    struct Block {
+      //! The uncompressed data.
+      std::string input{};
+      //! The deflated data.
+      std::string output{};
+      //! CRC-32 of `input`.
+      std::uint32_t crc{ 0 };
+      //! Whether this is the last block of its file, which must end the deflate stream.
+      bool is_last{ false };
+      //! Whether compression succeeded.
+      bool is_ok{ false };
+    };
+
+    //! Body of the thread writing an archive.
+    void runBatch();
+
+    //! Adds a single file to the archive.
+    //! 
+    //! @param result Holds the job on entry and receives its outcome.
+    //! @param archive The archive being written.
+    //! @param blocks Scratch space for blocks.
+    //! @param entries Receives the file's central directory entry if the file is added.
+    //! @returns False if the archive can no longer be written, in which case the batch must stop.
+    bool addFile(CopyResult& result, std::ofstream& archive, std::vector<Block>& blocks,
+      std::vector<CentralEntry>& entries);
+
+    //! Deflates a block.
+    //! 
+    //! @param block The block to deflate. Receives the compressed data and CRC.
+    //! @param dictionary Data immediately preceding the block in its file, used to prime the
+    //!     compressor. May be empty.
+    //! @param level zlib compression level.
+    static void deflateBlock(Block& block, const std::string& dictionary, int level);
+
+    //! Appends the archive's central directory and end records.
+    //! 
+    //! @param archive The archive being written.
+    //! @param entries The entries added to the archive, in order.
+    static void writeCentralDirectory(std::ofstream& archive,
+      const std::vector<CentralEntry>& entries);
+
+    //! Settings applied to every batch.
+    const ZipOptions options_;
+
+    //! The archive being written.
+    path_t archive_path_{};
+
+    //! Thread writing the archive, if any.
+    std::thread coordinator_{};
+
+    //! Guards `is_running_`.
+    mutable std::mutex mutex_{};
+
+    //! Signaled when a batch finishes.
+    std::condition_variable finished_{};
+
+    //! Whether the coordinator is still at work on a batch.
+    bool is_running_{ false };
+
+    //! Results of the current batch. Written only by the coordinator while the batch runs.
+    CopyReport report_{};
+
+    //! Whether cancellation has been requested.
+    std::atomic<bool> is_canceled_{ false };
+
+    //! Running totals of the current batch. See CopyProgress.
+    std::atomic<std::uintmax_t> bytes_done_{ 0 };
+    std::atomic<std::uintmax_t> bytes_total_{ 0 };
+    std::atomic<int> files_done_{ 0 };
+    std::atomic<int> files_total_{ 0 };
+  };
+}  // namespace ragtag
+
+#endif  // INCLUDE_ZIP_EXPORTER_H
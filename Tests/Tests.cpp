@@ -1,9 +1,34 @@
 using namespace std;
 
+#include "copy_engine.h"
+#include "directory_model.h"
+#include "directory_snapshot_cache.h"
+#include "ellipsization_cache.h"
+#include "export_namer.h"
+#include "file_selection.h"
+#include "file_status_cache.h"
+#include "filter_plan.h"
+#include "fuzzy_finder.h"
+#include "navigation_index.h"
+#include "path_trigram_index.h"
+#include "random_sampler.h"
+#include "rating_histogram.h"
+#include "recompute_scheduler.h"
+#include "sort_engine.h"
+#include "summary_model.h"
 #include "tag_map.h"
+#include "zip_exporter.h"
+#include <algorithm>
+#include <atomic>
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <set>
+#include <thread>
+#include <zlib.h>
 
 namespace ragtag {
   TEST_CASE("TagMap registerTag(), deleteTag(), isTagRegistered(), numTags()", "[all][TagMap-1]") {
@@ -289,4 +314,1564 @@ namespace ragtag {
       });
     CHECK(flightless_or_high_rated_creatures.size() == 5);
   }
+
+  TEST_CASE("TagMap file IDs", "[all][TagMap-7]") {
+    TagMap tag_map;
+    REQUIRE(tag_map.fileIdLimit() == 0);
+    REQUIRE(tag_map.addFile(L"apple"));
+    REQUIRE(tag_map.addFile(L"banana"));
+    REQUIRE(tag_map.addFile(L"cherry"));
+    CHECK(tag_map.fileIdLimit() == 3);
+
+    const auto banana_id = tag_map.getFileId(L"banana");
+    REQUIRE(banana_id.has_value());
+    CHECK(tag_map.getFilePath(*banana_id) == path_t(L"banana"));
+    CHECK_FALSE(tag_map.getFileId(L"durian").has_value());
+
+    // IDs of removed files are retired rather than reused.
+    REQUIRE(tag_map.removeFile(L"banana"));
+    CHECK_FALSE(tag_map.getFilePath(*banana_id).has_value());
+    REQUIRE(tag_map.addFile(L"durian"));
+    CHECK(*tag_map.getFileId(L"durian") == 3);
+    CHECK(tag_map.fileIdLimit() == 4);
+
+    // Copies resolve IDs against their own storage.
+    REQUIRE(tag_map.setRating(L"cherry", 4.5f));
+    const TagMap copy = tag_map;
+    const auto cherry_id = copy.getFileId(L"cherry");
+    REQUIRE(cherry_id.has_value());
+    CHECK(*cherry_id == *tag_map.getFileId(L"cherry"));
+    CHECK(copy.getRating(*cherry_id) == 4.5f);
+    CHECK(copy.fileIdLimit() == 4);
+    tag_map.clearRating(L"cherry");
+    CHECK(copy.getRating(*cherry_id) == 4.5f);
+
+    const auto ids = copy.selectFileIds([](const TagMap::FileInfo& info) {
+      return info.rating.has_value();
+      });
+    REQUIRE(ids.size() == 1);
+    CHECK(ids[0] == *cherry_id);
+    CHECK(copy.getAllFileIds() == std::vector<file_id_t>{ 0, 2, 3 });
+  }
+
+  TEST_CASE("TagMap findUntaggedFile(), numUntaggedFiles()", "[all][TagMap-8]") {
+    TagMap tag_map;
+    CHECK_FALSE(tag_map.findUntaggedFile(L"a/x", true).has_value());
+
+    // Without any tags defined, every file counts as untagged.
+    REQUIRE(tag_map.addFile(L"a/x"));
+    REQUIRE(tag_map.addFile(L"a/y"));
+    REQUIRE(tag_map.addFile(L"b/z"));
+    CHECK(tag_map.numUntaggedFiles() == 3);
+
+    REQUIRE(tag_map.registerTag(L"red"));
+    REQUIRE(tag_map.registerTag(L"blue"));
+    REQUIRE(tag_map.setTag(L"a/y", L"red", TagSetting::YES));
+    REQUIRE(tag_map.setTag(L"a/y", L"blue", TagSetting::NO));
+    CHECK(tag_map.numUntaggedFiles() == 2);
+
+    // The queue crosses directories and wraps around.
+    CHECK(tag_map.findUntaggedFile(L"a/x", true) == path_t(L"b/z"));
+    CHECK(tag_map.findUntaggedFile(L"b/z", true) == path_t(L"a/x"));
+    CHECK(tag_map.findUntaggedFile(L"a/x", false) == path_t(L"b/z"));
+    CHECK(tag_map.findUntaggedFile(L"a/y", true) == path_t(L"b/z"));
+    CHECK(tag_map.findUntaggedFile(L"a/y", false) == path_t(L"a/x"));
+
+    // Clearing a tag requeues a file; registering a tag requeues every file.
+    REQUIRE(tag_map.clearTag(L"a/y", L"blue"));
+    CHECK(tag_map.numUntaggedFiles() == 3);
+    REQUIRE(tag_map.setTag(L"a/y", L"blue", TagSetting::NO));
+    REQUIRE(tag_map.registerTag(L"green"));
+    CHECK(tag_map.numUntaggedFiles() == 3);
+
+    // Deleting the only missing tag completes the file again.
+    REQUIRE(tag_map.deleteTag(L"green"));
+    CHECK(tag_map.numUntaggedFiles() == 2);
+
+    // Copies carry their own queue.
+    const TagMap copy = tag_map;
+    REQUIRE(tag_map.removeFile(L"b/z"));
+    CHECK(tag_map.numUntaggedFiles() == 1);
+    CHECK(tag_map.findUntaggedFile(L"a/x", true) == path_t(L"a/x"));
+    CHECK(copy.numUntaggedFiles() == 2);
+    CHECK(copy.findUntaggedFile(L"a/x", true) == path_t(L"b/z"));
+
+    // Files outside the TagMap start the search at either end.
+    CHECK(copy.findUntaggedFile(L"c/w", true) == path_t(L"a/x"));
+    CHECK(copy.findUntaggedFile(L"c/w", false) == path_t(L"b/z"));
+
+    // Searches by ID reach across bitmap words and wrap around.
+    TagMap wide;
+    REQUIRE(wide.registerTag(L"red"));
+    for (int i = 0; i < 200; ++i) {
+      REQUIRE(wide.addFile(L"f" + std::to_wstring(i)));
+      if (i != 3 && i != 150) {
+        REQUIRE(wide.setTag(L"f" + std::to_wstring(i), L"red", TagSetting::YES));
+      }
+    }
+    CHECK(wide.numUntaggedFiles() == 2);
+    CHECK(wide.findUntaggedFileId(3, true) == 150);
+    CHECK(wide.findUntaggedFileId(150, true) == 3);
+    CHECK(wide.findUntaggedFileId(199, true) == 3);
+    CHECK(wide.findUntaggedFileId(3, false) == 150);
+    CHECK(wide.findUntaggedFileId(100, false) == 3);
+    REQUIRE(wide.registerTag(L"blue"));
+    CHECK(wide.numUntaggedFiles() == 200);
+    REQUIRE(wide.removeFile(L"f0"));
+    CHECK(wide.numUntaggedFiles() == 199);
+    CHECK(wide.findUntaggedFileId(199, true) == 1);
+  }
+
+  TEST_CASE("SummaryModel rows, sorting, cell text, and check state", "[all][SummaryModel-1]") {
+    TagMap tag_map;
+    REQUIRE(tag_map.registerTag(L"red"));
+    REQUIRE(tag_map.addFile(L"b"));
+    REQUIRE(tag_map.setTag(L"b", L"red", TagSetting::YES));
+    REQUIRE(tag_map.setRating(L"b", 1.5f));
+    REQUIRE(tag_map.addFile(L"a"));
+    REQUIRE(tag_map.setTag(L"a", L"red", TagSetting::NO));
+    REQUIRE(tag_map.addFile(L"c"));
+    REQUIRE(tag_map.setRating(L"c", 3.0f));
+
+    SummaryModel model({ .tag_yes = L"Y", .tag_no = L"N", .tag_uncommitted = L"?",
+      .rating_full_star = L"*", .rating_half_star = L"+", .no_rating = L"--" });
+    model.setTagMap(&tag_map);
+    CHECK(model.numRows() == 0);
+    CHECK(model.numColumns() == 3);
+
+    model.setRows(tag_map.selectFileIds([](const TagMap::FileInfo& info) {return true;}));
+    REQUIRE(model.numRows() == 3);
+
+    model.sortByColumn(SummaryModel::PATH_COLUMN, true);
+    CHECK(model.getPathAt(0) == path_t(L"a"));
+    CHECK(model.getPathAt(2) == path_t(L"c"));
+    CHECK(model.getCellText(0, SummaryModel::RATING_COLUMN) == L"--");
+    CHECK(model.getCellText(1, SummaryModel::RATING_COLUMN) == L"*+");
+    CHECK(model.getCellText(0, SummaryModel::FIRST_TAG_COLUMN) == L"N");
+    CHECK(model.getCellText(1, SummaryModel::FIRST_TAG_COLUMN) == L"Y");
+    CHECK(model.getCellText(2, SummaryModel::FIRST_TAG_COLUMN) == L"?");
+    CHECK(model.getCellText(3, SummaryModel::PATH_COLUMN).empty());
+
+    // Unrated files sort below rated files.
+    model.sortByColumn(SummaryModel::RATING_COLUMN, false);
+    CHECK(model.getPathAt(0) == path_t(L"c"));
+    CHECK(model.getPathAt(1) == path_t(L"b"));
+    CHECK(model.getPathAt(2) == path_t(L"a"));
+    CHECK(model.findIndex(*tag_map.getFileId(L"a")) == 2);
+
+    // Tag settings sort as NO, UNCOMMITTED, YES.
+    model.sortByColumn(SummaryModel::FIRST_TAG_COLUMN, true);
+    CHECK(model.getPathAt(0) == path_t(L"a"));
+    CHECK(model.getPathAt(1) == path_t(L"c"));
+    CHECK(model.getPathAt(2) == path_t(L"b"));
+
+    model.setChecked(0, true);
+    model.setChecked(2, true);
+    CHECK(model.numChecked() == 2);
+    CHECK(model.getCheckedPaths() == std::vector<path_t>{L"a", L"b"});
+
+    // Narrowing the rows keeps the sort and hides, but remembers, the check state of hidden rows.
+    model.setRows({ *tag_map.getFileId(L"b"), *tag_map.getFileId(L"c") });
+    CHECK(model.getPathAt(0) == path_t(L"c"));
+    CHECK(model.numChecked() == 1);
+    CHECK(model.isChecked(1));
+    CHECK_FALSE(model.findIndex(*tag_map.getFileId(L"a")).has_value());
+    CHECK(model.getCheckedPaths() == std::vector<path_t>{L"b"});
+    CHECK(model.getAllCheckedPaths().size() == 2);
+
+    model.setAllChecked(true);
+    CHECK(model.numChecked() == 2);
+
+    // Hidden rows that reappear are still checked.
+    model.setRows(tag_map.getAllFileIds());
+    CHECK(model.numChecked() == 3);
+
+    model.setAllChecked(false);
+    CHECK(model.numChecked() == 0);
+    CHECK(model.getCheckedPaths().empty());
+    CHECK(model.getAllCheckedPaths().empty());
+
+    // Check marks can be carried over to a different tag map by path.
+    TagMap other_tag_map = tag_map;
+    REQUIRE(other_tag_map.removeFile(L"b"));
+    model.setTagMap(&other_tag_map);
+    model.setRows(other_tag_map.getAllFileIds());
+    model.checkPaths({ L"b", L"c" });
+    CHECK(model.numChecked() == 1);
+    CHECK(model.getCheckedPaths() == std::vector<path_t>{L"c"});
+
+    // Check marks can be set by file ID, even for files that aren't rows yet.
+    model.setAllChecked(false);
+    model.setRows({});
+    model.checkFileIds({ *other_tag_map.getFileId(L"a"), -1, other_tag_map.fileIdLimit() });
+    CHECK(model.numChecked() == 0);
+    CHECK(model.getAllCheckedPaths() == std::vector<path_t>{L"a"});
+    model.setRows(other_tag_map.getAllFileIds());
+    CHECK(model.numChecked() == 1);
+    CHECK(model.getCheckedPaths() == std::vector<path_t>{L"a"});
+  }
+
+  TEST_CASE("DirectoryModel setListing(), getPathAt(), findIndex()", "[all][DirectoryModel-1]") {
+    const path_t directory = L"pictures";
+    DirectoryModel model;
+    CHECK_FALSE(model.getDirectory().has_value());
+    CHECK(model.numRows() == 0);
+
+    model.setListing(directory, std::make_shared<const std::vector<path_t>>(std::vector<path_t>{
+      directory / L"a.png", directory / L"b.mp4", directory / L"c.png" }));
+    CHECK(model.getDirectory() == directory);
+    REQUIRE(model.numRows() == 3);
+    CHECK(model.getPathAt(0) == directory / L"a.png");
+    CHECK(model.getPathAt(2) == directory / L"c.png");
+    CHECK_FALSE(model.getPathAt(3).has_value());
+    CHECK_FALSE(model.getPathAt(-1).has_value());
+    CHECK(model.findIndex(directory / L"b.mp4") == 1);
+    CHECK_FALSE(model.findIndex(directory / L"d.png").has_value());
+
+    model.setListing(directory, nullptr);
+    CHECK(model.numRows() == 0);
+    model.clear();
+    CHECK_FALSE(model.getDirectory().has_value());
+  }
+
+  TEST_CASE("DirectorySnapshotCache getSnapshot(), invalidate()", "[all][DirectorySnapshotCache-1]") {
+    const path_t directory = std::filesystem::temp_directory_path() / "ragtag_snapshot_cache";
+    std::filesystem::remove_all(directory);
+    REQUIRE(std::filesystem::create_directory(directory));
+    std::ofstream(directory / "c.png") << "x";
+    std::ofstream(directory / "a.png") << "x";
+    REQUIRE(std::filesystem::create_directory(directory / "subdirectory"));
+
+    // Only regular files are listed, and they're listed in sorted order.
+    const auto scanned = DirectorySnapshotCache::scan(directory);
+    REQUIRE(scanned.has_value());
+    CHECK(*scanned == std::vector<path_t>{ directory / "a.png", directory / "c.png" });
+    CHECK_FALSE(DirectorySnapshotCache::scan(directory / "nonexistent").has_value());
+
+    SECTION("Watched") {
+      DirectorySnapshotCache cache;
+      const auto first = cache.getSnapshot(directory);
+      REQUIRE(first.has_value());
+      CHECK(**first == *scanned);
+
+      // An unchanged directory yields the very same snapshot.
+      CHECK(*cache.getSnapshot(directory) == *first);
+
+      std::ofstream(directory / "b.mp4") << "x";
+      std::filesystem::remove(directory / "c.png");
+      const auto second = cache.getSnapshot(directory);
+      REQUIRE(second.has_value());
+      CHECK(**second == std::vector<path_t>{ directory / "a.png", directory / "b.mp4" });
+      // Snapshots already handed out are left untouched.
+      CHECK(**first == *scanned);
+    }
+
+    SECTION("Polled") {
+      DirectorySnapshotCache cache(std::make_unique<PollingDirectoryWatcher>());
+      const auto first = cache.getSnapshot(directory);
+      REQUIRE(first.has_value());
+      CHECK(*cache.getSnapshot(directory) == *first);
+
+      std::ofstream(directory / "b.mp4") << "x";
+      CHECK((*cache.getSnapshot(directory))->size() == 3);
+    }
+
+    SECTION("Unwatched") {
+      DirectorySnapshotCache cache(nullptr);
+      const auto first = cache.getSnapshot(directory);
+      REQUIRE(first.has_value());
+      std::ofstream(directory / "b.mp4") << "x";
+      CHECK(**cache.getSnapshot(directory) == *scanned);
+
+      cache.invalidate();
+      CHECK((*cache.getSnapshot(directory))->size() == 3);
+    }
+
+    std::filesystem::remove_all(directory);
+  }
+
+  TEST_CASE("NavigationIndex findNeighbor(), updateFile()", "[all][NavigationIndex-1]") {
+    TagMap tag_map;
+    REQUIRE(tag_map.registerTag(L"red"));
+    const auto tag_fully = [&tag_map](const path_t& path) {
+      REQUIRE(tag_map.addFile(path));
+      REQUIRE(tag_map.setTag(path, L"red", TagSetting::YES));
+      };
+    tag_fully(L"a");
+    tag_fully(L"c");
+    REQUIRE(tag_map.addFile(L"d"));  // Untagged
+    // "b" and "e" aren't in the project at all, which also counts as untagged.
+
+    const auto snapshot = std::make_shared<const std::vector<path_t>>(
+      std::vector<path_t>{ L"a", L"b", L"c", L"d", L"e" });
+    NavigationIndex index;
+    CHECK_FALSE(index.isCurrent(snapshot));
+    index.rebuild(snapshot, tag_map);
+    CHECK(index.isCurrent(snapshot));
+    CHECK(index.numUntagged() == 3);
+
+    CHECK(index.findNeighbor(L"a", false, true) == path_t(L"b"));
+    CHECK(index.findNeighbor(L"a", false, false) == path_t(L"e"));
+    CHECK(index.findNeighbor(L"e", false, true) == path_t(L"a"));
+    CHECK(index.findNeighbor(L"a", true, true) == path_t(L"b"));
+    CHECK(index.findNeighbor(L"b", true, true) == path_t(L"d"));
+    CHECK(index.findNeighbor(L"e", true, true) == path_t(L"b"));
+    CHECK(index.findNeighbor(L"b", true, false) == path_t(L"e"));
+    CHECK(index.findNeighbor(L"d", true, false) == path_t(L"b"));
+
+    // An unlisted reference navigates from where it would be.
+    CHECK(index.findNeighbor(L"bb", false, true) == path_t(L"c"));
+    CHECK(index.findNeighbor(L"bb", false, false) == path_t(L"b"));
+    CHECK(index.findNeighbor(L"bb", true, true) == path_t(L"d"));
+
+    // Tagging a file removes it from untagged navigation once the index is told.
+    REQUIRE(tag_map.setTag(L"d", L"red", TagSetting::NO));
+    index.updateFile(L"d", tag_map);
+    CHECK(index.numUntagged() == 2);
+    CHECK(index.findNeighbor(L"b", true, true) == path_t(L"e"));
+
+    tag_fully(L"b");
+    tag_fully(L"e");
+    index.updateFile(L"b", tag_map);
+    index.updateFile(L"e", tag_map);
+    CHECK_FALSE(index.findNeighbor(L"a", true, true).has_value());
+    CHECK(index.findNeighbor(L"a", false, true) == path_t(L"b"));
+
+    index.invalidate();
+    CHECK_FALSE(index.isCurrent(snapshot));
+
+    // A lone untagged reference file is its own neighbor.
+    const auto lone = std::make_shared<const std::vector<path_t>>(std::vector<path_t>{ L"f" });
+    index.rebuild(lone, tag_map);
+    CHECK(index.findNeighbor(L"f", true, true) == path_t(L"f"));
+    CHECK(index.findNeighbor(L"f", false, false) == path_t(L"f"));
+  }
+  TEST_CASE("FileStatusCache prefetch(), isPresent(), invalidate()", "[all][FileStatusCache-1]") {
+    const path_t root = std::filesystem::temp_directory_path() / "ragtag_file_status_cache";
+    std::filesystem::remove_all(root);
+    REQUIRE(std::filesystem::create_directories(root / "first"));
+    REQUIRE(std::filesystem::create_directories(root / "second"));
+    std::ofstream(root / "first" / "a.png") << "x";
+    std::ofstream(root / "second" / "b.png") << "x";
+    const std::vector<path_t> paths{ root / "first" / "a.png", root / "first" / "missing.png",
+      root / "second" / "b.png", root / "nonexistent" / "c.png" };
+
+    SECTION("Trusted for time to live") {
+      FileStatusCache cache(std::chrono::hours(1));
+      cache.prefetch(paths);
+      CHECK(cache.isPresent(paths[0]));
+      CHECK_FALSE(cache.isPresent(paths[1]));
+      CHECK(cache.isPresent(paths[2]));
+      CHECK_FALSE(cache.isPresent(paths[3]));
+
+      // The stale listing is used until the cache is invalidated.
+      std::filesystem::remove(paths[0]);
+      CHECK(cache.isPresent(paths[0]));
+      cache.invalidate();
+      CHECK_FALSE(cache.isPresent(paths[0]));
+    }
+
+    SECTION("Revalidated by last-write time") {
+      FileStatusCache cache(std::chrono::milliseconds(0));
+      CHECK(cache.isPresent(paths[2]));
+      std::ofstream(paths[1]) << "x";
+      std::filesystem::remove(paths[2]);
+      cache.prefetch(paths);
+      CHECK(cache.isPresent(paths[1]));
+      CHECK_FALSE(cache.isPresent(paths[2]));
+    }
+
+    std::filesystem::remove_all(root);
+  }
+
+  TEST_CASE("FilterPlan addStage(), run(), getStageStats()", "[all][FilterPlan-1]") {
+    FilterPlan plan;
+    std::vector<std::string> order_of_evaluation;
+    std::vector<file_id_t> prepared_ids;
+    plan.addStage("expensive", 10.0, [&](file_id_t id) {
+      order_of_evaluation.push_back("expensive");
+      return id != 2;
+      }, [&](const std::vector<file_id_t>& ids) { prepared_ids = ids; });
+    plan.addStage("cheap", 1.0, [&](file_id_t id) {
+      order_of_evaluation.push_back("cheap");
+      return id % 2 == 0;
+      });
+    REQUIRE(plan.numStages() == 2);
+    CHECK(plan.getStageStats().empty());
+
+    // Survivors keep their original order, and the expensive stage only sees the cheap stage's
+    // survivors.
+    CHECK(plan.run({ 4, 1, 2, 3, 0 }) == std::vector<file_id_t>{ 4, 0 });
+    CHECK(prepared_ids == std::vector<file_id_t>{ 4, 2, 0 });
+    CHECK(order_of_evaluation == std::vector<std::string>{ "cheap", "cheap", "cheap", "cheap",
+      "cheap", "expensive", "expensive", "expensive" });
+
+    const auto& stats = plan.getStageStats();
+    REQUIRE(stats.size() == 2);
+    CHECK(stats[0].name == "cheap");
+    CHECK(stats[0].num_evaluated == 5);
+    CHECK(stats[0].num_passed == 3);
+    CHECK(stats[1].name == "expensive");
+    CHECK(stats[1].num_evaluated == 3);
+    CHECK(stats[1].num_passed == 2);
+    CHECK(plan.describeStageStats().find("cheap: 3/5 (60.0%)") != std::string::npos);
+
+    // A cancelled run produces nothing.
+    CHECK_FALSE(plan.run({ 4, 1, 2 }, []() { return true; }).has_value());
+
+    // An empty plan accepts everything.
+    CHECK(FilterPlan().run({ 3, 1 }) == std::vector<file_id_t>{ 3, 1 });
+
+    // Single files stop at the first stage that rejects them, without touching the statistics.
+    order_of_evaluation.clear();
+    plan.run({ 4, 1 });
+    CHECK(plan.accepts(4));
+    CHECK_FALSE(plan.accepts(1));
+    CHECK_FALSE(plan.accepts(2));
+    CHECK(order_of_evaluation == std::vector<std::string>{ "cheap", "cheap", "expensive",
+      "cheap", "expensive", "cheap", "cheap", "expensive" });
+    REQUIRE(plan.getStageStats().size() == 2);
+    CHECK(plan.getStageStats()[0].num_evaluated == 2);
+    CHECK(FilterPlan().accepts(7));
+  }
+
+  TEST_CASE("FilterPlan runProgressively()", "[all][FilterPlan-2]") {
+    FilterPlan plan;
+    plan.addStage("odd", 1.0, [](file_id_t id) { return id % 2 == 1; });
+    std::vector<file_id_t> candidates;
+    for (file_id_t id = 0; id < 20000; ++id) {
+      candidates.push_back(id);
+    }
+
+    // The first report comes once enough matches are found, and each report extends the last.
+    std::vector<std::vector<file_id_t>> reports;
+    const auto matches = plan.runProgressively(candidates, {},
+      [&](const std::vector<file_id_t>& matches_so_far) { reports.push_back(matches_so_far); }, 10);
+    REQUIRE(matches.has_value());
+    CHECK(matches->size() == 10000);
+    CHECK(matches->front() == 1);
+    CHECK(matches->back() == 19999);
+    REQUIRE_FALSE(reports.empty());
+    CHECK(reports.front().size() >= 10);
+    CHECK(reports.front().size() < matches->size());
+    CHECK(std::equal(reports.back().begin(), reports.back().end(), matches->begin()));
+
+    // Statistics cover the whole run.
+    REQUIRE(plan.getStageStats().size() == 1);
+    CHECK(plan.getStageStats()[0].num_evaluated == 20000);
+    CHECK(plan.getStageStats()[0].num_passed == 10000);
+
+    // A cancelled run produces nothing, and a small run needs no reports.
+    CHECK_FALSE(plan.runProgressively(candidates, []() { return true; }, {}, 10).has_value());
+    reports.clear();
+    CHECK(plan.runProgressively({ 1, 2, 3 }, {},
+      [&](const std::vector<file_id_t>& matches_so_far) { reports.push_back(matches_so_far); }, 1)
+      == std::vector<file_id_t>{ 1, 3 });
+    CHECK(reports.empty());
+    CHECK(plan.runProgressively({}, {}, {}, 1) == std::vector<file_id_t>{});
+    CHECK(plan.getStageStats().size() == 1);
+  }
+
+  TEST_CASE("RecomputeScheduler coalescing and cancellation", "[all][RecomputeScheduler-1]") {
+    std::atomic<int> num_notifications{ 0 };
+    RecomputeScheduler scheduler(std::chrono::milliseconds(50), [&]() { ++num_notifications; });
+    const auto wait_for_notification = [&]() {
+      const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+      while (num_notifications == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      }
+      };
+    CHECK(scheduler.isIdle());
+    CHECK_FALSE(scheduler.commitFinished());
+
+    // A burst of requests is coalesced into a single run of the last job.
+    std::atomic<int> num_runs{ 0 };
+    int committed_value = 0;
+    for (int i = 1; i <= 5; ++i) {
+      scheduler.schedule([&, i](const RecomputeScheduler::cancellation_t& is_cancelled) {
+        ++num_runs;
+        return RecomputeScheduler::commit_t([&, i]() { committed_value = i; });
+        });
+    }
+    CHECK_FALSE(scheduler.isIdle());
+    wait_for_notification();
+    CHECK(num_runs == 1);
+    REQUIRE(num_notifications == 1);
+    CHECK(committed_value == 0);  // Nothing is applied until committed on the owner's thread.
+    CHECK(scheduler.commitFinished());
+    CHECK(committed_value == 5);
+    CHECK_FALSE(scheduler.commitFinished());
+    CHECK(scheduler.isIdle());
+
+    // A running job sees that it has been superseded, and its result is never committed.
+    std::atomic<bool> has_started{ false };
+    std::atomic<bool> saw_cancellation{ false };
+    scheduler.schedule([&](const RecomputeScheduler::cancellation_t& is_cancelled) {
+      has_started = true;
+      while (!is_cancelled()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      saw_cancellation = true;
+      return RecomputeScheduler::commit_t([&]() { committed_value = -1; });
+      });
+    while (!has_started) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    scheduler.cancel();
+    while (!scheduler.isIdle()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(saw_cancellation);
+    CHECK_FALSE(scheduler.commitFinished());
+    CHECK(committed_value == 5);
+    CHECK(num_notifications == 1);
+
+    // Partial results are committed in order ahead of the final result.
+    std::vector<int> committed_values;
+    scheduler.schedule([&](const RecomputeScheduler::cancellation_t& is_cancelled) {
+      for (int i = 1; i <= 2; ++i) {
+        CHECK(scheduler.publish([&, i]() { committed_values.push_back(i); }));
+      }
+      return RecomputeScheduler::commit_t([&]() { committed_values.push_back(3); });
+      });
+    while (!scheduler.isIdle() && num_notifications < 4) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(scheduler.commitFinished());
+    CHECK(committed_values == std::vector<int>{ 1, 2, 3 });
+    CHECK_FALSE(scheduler.publish([]() {}));  // Not called from a running job.
+  }
+
+  TEST_CASE("SortEngine multi-key, stable, and parallel sorting", "[all][SortEngine-1]") {
+    TagMap tag_map;
+    REQUIRE(tag_map.registerTag(L"red"));
+    REQUIRE(tag_map.addFile(L"d"));
+    REQUIRE(tag_map.setTag(L"d", L"red", TagSetting::YES));
+    REQUIRE(tag_map.setRating(L"d", 2.0f));
+    REQUIRE(tag_map.addFile(L"b"));
+    REQUIRE(tag_map.setTag(L"b", L"red", TagSetting::YES));
+    REQUIRE(tag_map.setRating(L"b", 2.0f));
+    REQUIRE(tag_map.addFile(L"a"));
+    REQUIRE(tag_map.setTag(L"a", L"red", TagSetting::NO));
+    REQUIRE(tag_map.addFile(L"c"));
+    REQUIRE(tag_map.setTag(L"c", L"red", TagSetting::YES));
+    REQUIRE(tag_map.setRating(L"c", 4.0f));
+    const file_id_t a = *tag_map.getFileId(L"a");
+    const file_id_t b = *tag_map.getFileId(L"b");
+    const file_id_t c = *tag_map.getFileId(L"c");
+    const file_id_t d = *tag_map.getFileId(L"d");
+
+    using Field = SortEngine::Field;
+    const std::vector<file_id_t> ids{ d, b, a, c };
+    CHECK(SortEngine::sort(tag_map, ids, {}) == ids);
+    CHECK(SortEngine::sort(tag_map, ids, { {.field = Field::PATH } })
+      == std::vector<file_id_t>{ a, b, c, d });
+
+    // Tag descending, then rating descending, then path ascending.
+    CHECK(SortEngine::sort(tag_map, ids, {
+      {.field = Field::TAG, .tag = L"red", .ascending = false },
+      {.field = Field::RATING, .ascending = false },
+      {.field = Field::PATH } })
+      == std::vector<file_id_t>{ c, b, d, a });
+
+    // Files that tie by every key keep their relative order.
+    CHECK(SortEngine::sort(tag_map, ids, { {.field = Field::RATING } })
+      == std::vector<file_id_t>{ a, d, b, c });
+    CHECK(SortEngine::sort(tag_map, { b, d, a, c }, { {.field = Field::RATING } })
+      == std::vector<file_id_t>{ a, b, d, c });
+
+    // Large inputs are sorted in parallel with the same result as a serial sort.
+    std::vector<file_id_t> many;
+    for (size_t i = 0; i < SortEngine::PARALLEL_THRESHOLD + 1001; ++i) {
+      many.push_back(static_cast<file_id_t>((i * 7) % 4));
+    }
+    const auto sorted = SortEngine::sort(tag_map, many, { {.field = Field::RATING } });
+    REQUIRE(sorted.size() == many.size());
+    std::vector<file_id_t> expected = many;
+    std::stable_sort(expected.begin(), expected.end(), [&](file_id_t lhs, file_id_t rhs) {
+      return tag_map.getRating(lhs).value_or(-1.0f) < tag_map.getRating(rhs).value_or(-1.0f);
+      });
+    CHECK(sorted == expected);
+    const auto by_path = SortEngine::sort(tag_map, many, { {.field = Field::PATH,
+      .ascending = false } });
+    CHECK(std::is_sorted(by_path.begin(), by_path.end(), [&](file_id_t lhs, file_id_t rhs) {
+      return *tag_map.getFilePath(lhs) > *tag_map.getFilePath(rhs);
+      }));
+  }
+
+  TEST_CASE("FileSelection setSelected(), selectAll(), getSelectedIds()",
+    "[all][FileSelection-1]") {
+    FileSelection selection;
+    CHECK(selection.count() == 0);
+    CHECK_FALSE(selection.setSelected(0, true));
+
+    selection.reset(130);
+    CHECK(selection.idLimit() == 130);
+    CHECK(selection.setSelected(129, true));
+    CHECK_FALSE(selection.setSelected(129, true));
+    CHECK(selection.setSelected(3, true));
+    CHECK_FALSE(selection.setSelected(130, true));
+    CHECK_FALSE(selection.setSelected(-1, true));
+    CHECK(selection.isSelected(3));
+    CHECK_FALSE(selection.isSelected(4));
+    CHECK(selection.count() == 2);
+
+    selection.selectAll({ 64, 3, 65, 200 });
+    CHECK(selection.count() == 4);
+    CHECK(selection.getSelectedIds() == std::vector<file_id_t>{ 3, 64, 65, 129 });
+    CHECK(selection.countAmong({ 0, 3, 65, 128, 129 }) == 3);
+
+    CHECK(selection.setSelected(64, false));
+    CHECK(selection.count() == 3);
+    selection.clear();
+    CHECK(selection.count() == 0);
+    CHECK(selection.getSelectedIds().empty());
+  }
+
+  TEST_CASE("EllipsizationCache ellipsizeStart(), clear()", "[all][EllipsizationCache-1]") {
+    // Every character is ten pixels wide.
+    int num_measurements = 0;
+    EllipsizationCache cache([&](const std::wstring& text) {
+      ++num_measurements;
+      return static_cast<int>(text.size()) * 10;
+      }, 5);
+
+    CHECK(cache.ellipsizeStart(L"abcdef", 60) == L"abcdef");
+    CHECK(cache.ellipsizeStart(L"abcdefghij", 60) == L"...hij");
+    CHECK(cache.ellipsizeStart(L"abcdefghij", 65) == L"...hij");
+    CHECK(cache.ellipsizeStart(L"abcdefghij", 10) == EllipsizationCache::ELLIPSIS);
+    CHECK(cache.ellipsizeStart(L"", 0).empty());
+    CHECK(cache.size() == 5);
+
+    // Repeated requests are answered without measuring.
+    const int num_measurements_before = num_measurements;
+    CHECK(cache.ellipsizeStart(L"abcdefghij", 60) == L"...hij");
+    CHECK(num_measurements == num_measurements_before);
+
+    // Reaching capacity starts over.
+    CHECK(cache.ellipsizeStart(L"abcdefghij", 70) == L"...ghij");
+    CHECK(cache.size() == 1);
+    cache.clear();
+    CHECK(cache.size() == 0);
+  }
+
+  TEST_CASE("TagMap countTagSettings()", "[all][TagMap-9]") {
+    TagMap tag_map;
+    REQUIRE(tag_map.registerTag(L"red"));
+    REQUIRE(tag_map.registerTag(L"blue"));
+    for (int i = 0; i < 100; ++i) {
+      const path_t path = std::to_wstring(i);
+      REQUIRE(tag_map.addFile(path));
+      REQUIRE(tag_map.setTag(path, L"red", i % 2 == 0 ? TagSetting::YES : TagSetting::NO));
+      if (i % 10 == 0) {
+        REQUIRE(tag_map.setTag(path, L"blue", TagSetting::YES));
+      }
+    }
+
+    auto counts = tag_map.countTagSettings(tag_map.getAllFileIds());
+    REQUIRE(counts.size() == 2);
+    CHECK(counts[L"red"] == TagSettingCounts{ .yes = 50, .no = 50, .uncommitted = 0 });
+    CHECK(counts[L"blue"] == TagSettingCounts{ .yes = 10, .no = 0, .uncommitted = 90 });
+
+    // Only the selection is counted. Repeated and unknown IDs are ignored.
+    const file_id_t id_0 = *tag_map.getFileId(L"0");
+    const file_id_t id_1 = *tag_map.getFileId(L"1");
+    counts = tag_map.countTagSettings({ id_0, id_1, id_1, -1, 1000 });
+    CHECK(counts[L"red"] == TagSettingCounts{ .yes = 1, .no = 1, .uncommitted = 0 });
+    CHECK(counts[L"blue"] == TagSettingCounts{ .yes = 1, .no = 0, .uncommitted = 1 });
+
+    // Counts follow changes to settings, files, and tags.
+    REQUIRE(tag_map.clearTag(L"0", L"red"));
+    REQUIRE(tag_map.setTag(L"1", L"blue", TagSetting::NO));
+    counts = tag_map.countTagSettings({ id_0, id_1 });
+    CHECK(counts[L"red"] == TagSettingCounts{ .yes = 0, .no = 1, .uncommitted = 1 });
+    CHECK(counts[L"blue"] == TagSettingCounts{ .yes = 1, .no = 1, .uncommitted = 0 });
+
+    REQUIRE(tag_map.removeFile(L"1"));
+    REQUIRE(tag_map.renameTag(L"blue", L"green"));
+    const TagMap copy = tag_map;
+    counts = copy.countTagSettings({ id_0, id_1 });
+    REQUIRE(counts.size() == 2);
+    CHECK(counts[L"green"] == TagSettingCounts{ .yes = 1, .no = 0, .uncommitted = 0 });
+    CHECK(copy.countTagSettings(copy.getAllFileIds())[L"red"]
+      == TagSettingCounts{ .yes = 49, .no = 49, .uncommitted = 1 });
+  }
+
+  TEST_CASE("TagMap selectFileIdsByTags()", "[all][TagMap-10]") {
+    TagMap tag_map;
+    REQUIRE(tag_map.registerTag(L"red"));
+    REQUIRE(tag_map.registerTag(L"blue"));
+    for (int i = 0; i < 200; ++i) {
+      const path_t path = std::to_wstring(i);
+      REQUIRE(tag_map.addFile(path));
+      if (i % 2 == 0) {
+        REQUIRE(tag_map.setTag(path, L"red", TagSetting::YES));
+      }
+      if (i % 3 == 0) {
+        REQUIRE(tag_map.setTag(path, L"blue", TagSetting::YES));
+      }
+      else if (i % 3 == 1) {
+        REQUIRE(tag_map.setTag(path, L"blue", TagSetting::NO));
+      }
+    }
+    REQUIRE(tag_map.removeFile(L"6"));
+
+    const auto expected = [&](const std::function<bool(int)>& fn) {
+      std::vector<file_id_t> returning;
+      for (int i = 0; i < 200; ++i) {
+        if (i != 6 && fn(i)) {
+          returning.push_back(*tag_map.getFileId(std::to_wstring(i)));
+        }
+      }
+      std::sort(returning.begin(), returning.end());
+      return returning;
+      };
+
+    const TagConstraint has_red{ .tag = L"red", .has_tag = true };
+    const TagConstraint lacks_blue{ .tag = L"blue", .has_tag = false };
+    CHECK(tag_map.selectFileIdsByTags({ has_red, lacks_blue }, true)
+      == expected([](int i) { return i % 2 == 0 && i % 3 != 0; }));
+    CHECK(tag_map.selectFileIdsByTags({ has_red, lacks_blue }, false)
+      == expected([](int i) { return i % 2 == 0 || i % 3 != 0; }));
+    CHECK(tag_map.selectFileIdsByTags({ has_red }, true)
+      == expected([](int i) { return i % 2 == 0; }));
+    CHECK(tag_map.selectFileIdsByTags({}, true).size() == 199);
+    CHECK(tag_map.selectFileIdsByTags({}, false).empty());
+    CHECK(tag_map.selectFileIdsByTags({ {.tag = L"green", .has_tag = true } }, true).empty());
+    CHECK(tag_map.selectFileIdsByTags({ {.tag = L"green", .has_tag = false } }, true).size()
+      == 199);
+  }
+
+  TEST_CASE("RatingHistogram add(), remove(), countRated()", "[all][RatingHistogram-1]") {
+    RatingHistogram histogram(5);
+    CHECK(histogram.numRated() == 0);
+    CHECK(histogram.numUnrated() == 0);
+    CHECK(histogram.countRated(0.0, 5.0) == 0);
+
+    histogram.add(0.0);
+    histogram.add(1.5);
+    histogram.add(1.5);
+    histogram.add(3.0);
+    histogram.add(5.0);
+    histogram.add(7.0);  // Counted as 5 stars
+    histogram.add({});
+    histogram.add({});
+    CHECK(histogram.numRated() == 6);
+    CHECK(histogram.numUnrated() == 2);
+    CHECK(histogram.countRated(0.0, 5.0) == 6);
+    CHECK(histogram.countRated(1.0, 3.0) == 3);
+    CHECK(histogram.countRated(1.5, 1.5) == 2);
+    CHECK(histogram.countRated(2.0, 2.5) == 0);
+    CHECK(histogram.countRated(5.0, 5.0) == 2);
+    CHECK(histogram.countRated(0.0, 0.0) == 1);
+    CHECK(histogram.countRated(4.0, 2.0) == 0);
+
+    histogram.remove(1.5);
+    histogram.remove({});
+    CHECK(histogram.countRated(1.0, 3.0) == 2);
+    CHECK(histogram.numUnrated() == 1);
+
+    histogram.clear();
+    CHECK(histogram.numRated() == 0);
+    CHECK(histogram.numUnrated() == 0);
+    CHECK(histogram.countRated(0.0, 5.0) == 0);
+  }
+
+  TEST_CASE("TagMap queryFileIds()", "[all][TagMap-11]") {
+    TagMap tag_map;
+    REQUIRE(tag_map.registerTag(L"red"));
+    for (int i = 0; i < 300; ++i) {
+      const path_t path = std::to_wstring(i);
+      REQUIRE(tag_map.addFile(path));
+      if (i % 4 != 0) {
+        REQUIRE(tag_map.setRating(path, (i % 11) * 0.5f));
+      }
+      if (i % 3 != 2) {
+        REQUIRE(tag_map.setTag(path, L"red", i % 3 == 0 ? TagSetting::YES : TagSetting::NO));
+      }
+    }
+    REQUIRE(tag_map.removeFile(L"42"));
+
+    const TagMap::file_qualifier_t is_odd = [](const TagMap::FileInfo& info) {
+      return std::stoi(info.path.wstring()) % 2 == 1;
+      };
+
+    // Each window should match the corresponding slice of a full sort.
+    const auto check_windows = [&](const TagMap::file_qualifier_t& fn, const QueryOrder order,
+      const SortEngine::Field field, const bool ascending) {
+        const auto all = fn ? tag_map.selectFileIds(fn) : tag_map.getAllFileIds();
+        const auto sorted = SortEngine::sort(tag_map, all,
+          { {.field = field, .tag = L"red", .ascending = ascending } });
+        CHECK(tag_map.queryFileIds(fn, { .order = order, .tag = L"red", .ascending = ascending })
+          == sorted);
+        for (const int offset : { 0, 7, 140, 299 }) {
+          for (const int limit : { 1, 10, 50 }) {
+            const auto window = tag_map.queryFileIds(fn, { .order = order, .tag = L"red",
+              .ascending = ascending, .offset = offset, .limit = limit });
+            const size_t begin = std::min<size_t>(offset, sorted.size());
+            const size_t end = std::min<size_t>(offset + limit, sorted.size());
+            CHECK(window == std::vector<file_id_t>(sorted.begin() + begin, sorted.begin() + end));
+          }
+        }
+      };
+    for (const bool ascending : { true, false }) {
+      check_windows({}, QueryOrder::PATH, SortEngine::Field::PATH, ascending);
+      check_windows({}, QueryOrder::RATING, SortEngine::Field::RATING, ascending);
+      check_windows({}, QueryOrder::TAG, SortEngine::Field::TAG, ascending);
+      check_windows(is_odd, QueryOrder::PATH, SortEngine::Field::PATH, ascending);
+      check_windows(is_odd, QueryOrder::RATING, SortEngine::Field::RATING, ascending);
+    }
+
+    CHECK(tag_map.queryFileIds({}, { .limit = 0 }).empty());
+    CHECK(tag_map.queryFileIds({}, { .offset = 1000 }).empty());
+  }
+
+  TEST_CASE("RandomSampler sampleIndices()", "[all][RandomSampler-1]") {
+    CHECK(RandomSampler::sampleIndices(0, 5, 1).empty());
+    CHECK(RandomSampler::sampleIndices(10, 0, 1).empty());
+    CHECK(RandomSampler::sampleIndices(4, 10, 1) == std::vector<int>{ 0, 1, 2, 3 });
+
+    const auto sample = RandomSampler::sampleIndices(1000, 50, 7);
+    REQUIRE(sample.size() == 50);
+    CHECK(std::is_sorted(sample.begin(), sample.end()));
+    CHECK(std::adjacent_find(sample.begin(), sample.end()) == sample.end());
+    CHECK(sample.front() >= 0);
+    CHECK(sample.back() < 1000);
+    CHECK(RandomSampler::sampleIndices(1000, 50, 7) == sample);
+
+    // Every position should be chosen about equally often across many seeds.
+    std::vector<int> num_times_chosen(10, 0);
+    for (std::uint64_t seed = 0; seed < 10000; ++seed) {
+      for (const int index : RandomSampler::sampleIndices(10, 3, seed)) {
+        ++num_times_chosen[index];
+      }
+    }
+    for (const int num : num_times_chosen) {
+      CHECK(num > 2700);
+      CHECK(num < 3300);
+    }
+  }
+
+  TEST_CASE("TagMap sampleFileIds(), sampleFileIdsByTags()", "[all][TagMap-12]") {
+    TagMap tag_map;
+    REQUIRE(tag_map.registerTag(L"red"));
+    for (int i = 0; i < 500; ++i) {
+      const path_t path = std::to_wstring(i);
+      REQUIRE(tag_map.addFile(path));
+      if (i % 5 == 0) {
+        REQUIRE(tag_map.setTag(path, L"red", TagSetting::YES));
+        REQUIRE(tag_map.setRating(path, 4.0f));
+      }
+    }
+    REQUIRE(tag_map.removeFile(L"10"));
+
+    const TagMap::file_qualifier_t is_red = [](const TagMap::FileInfo& info) {
+      return info.f_tag_setting(L"red") == TagSetting::YES;
+      };
+    const auto red_ids = tag_map.selectFileIds(is_red);
+    REQUIRE(red_ids.size() == 99);
+    // Qualifiers can tell files apart by ID.
+    const auto first_red_id = red_ids.front();
+    CHECK(tag_map.sampleFileIds([=](const TagMap::FileInfo& info) {
+      return info.id == first_red_id;
+      }, 20, 3) == std::vector<file_id_t>{ first_red_id });
+    const auto is_red_id = [&](const file_id_t id) {
+      return std::find(red_ids.begin(), red_ids.end(), id) != red_ids.end();
+      };
+    const TagConstraint has_red{ .tag = L"red", .has_tag = true };
+
+    const auto scanned = tag_map.sampleFileIds(is_red, 20, 3);
+    REQUIRE(scanned.size() == 20);
+    CHECK(std::all_of(scanned.begin(), scanned.end(), is_red_id));
+    CHECK(tag_map.sampleFileIds(is_red, 20, 3) == scanned);
+    CHECK(tag_map.sampleFileIds(is_red, 200, 3) == red_ids);
+    CHECK(tag_map.sampleFileIds(is_red, 0, 3).empty());
+    CHECK(tag_map.sampleFileIds({}, 1000, 3).size() == 499);
+
+    const auto ranked = tag_map.sampleFileIdsByTags({ has_red }, true, 20, 3);
+    REQUIRE(ranked.size() == 20);
+    CHECK(std::is_sorted(ranked.begin(), ranked.end()));
+    CHECK(std::adjacent_find(ranked.begin(), ranked.end()) == ranked.end());
+    CHECK(std::all_of(ranked.begin(), ranked.end(), is_red_id));
+    CHECK(tag_map.sampleFileIdsByTags({ has_red }, true, 20, 3) == ranked);
+    auto sorted_red_ids = red_ids;
+    std::sort(sorted_red_ids.begin(), sorted_red_ids.end());
+    CHECK(tag_map.sampleFileIdsByTags({ has_red }, true, 200, 3) == sorted_red_ids);
+
+    // Both methods should favor no file over another.
+    std::map<file_id_t, int> scan_counts;
+    std::map<file_id_t, int> rank_counts;
+    for (std::uint64_t seed = 0; seed < 2000; ++seed) {
+      for (const file_id_t id : tag_map.sampleFileIds(is_red, 10, seed)) {
+        ++scan_counts[id];
+      }
+      for (const file_id_t id : tag_map.sampleFileIdsByTags({ has_red }, true, 10, seed)) {
+        ++rank_counts[id];
+      }
+    }
+    CHECK(scan_counts.size() == 99);
+    CHECK(rank_counts.size() == 99);
+    for (const auto& counts : { scan_counts, rank_counts }) {
+      for (const auto& [id, num] : counts) {
+        CHECK(num > 120);
+        CHECK(num < 290);
+      }
+    }
+  }
+
+  TEST_CASE("TagMap getTagSettingCounts(), countRatedFiles(), countFiles()", "[all][TagMap-13]") {
+    TagMap tag_map;
+    REQUIRE(tag_map.registerTag(L"red"));
+    REQUIRE(tag_map.registerTag(L"blue"));
+    for (int i = 0; i < 150; ++i) {
+      const path_t path = std::to_wstring(i);
+      REQUIRE(tag_map.addFile(path));
+      if (i % 3 == 0) {
+        REQUIRE(tag_map.setTag(path, L"red", TagSetting::YES));
+      }
+      else if (i % 3 == 1) {
+        REQUIRE(tag_map.setTag(path, L"red", TagSetting::NO));
+      }
+      if (i % 5 == 0) {
+        REQUIRE(tag_map.setTag(path, L"blue", TagSetting::YES));
+      }
+      if (i % 2 == 0) {
+        REQUIRE(tag_map.setRating(path, (i % 6) * 1.0f));
+      }
+    }
+    // Modifications should keep the counters in step.
+    REQUIRE(tag_map.setTag(L"0", L"red", TagSetting::NO));
+    REQUIRE(tag_map.setTag(L"0", L"red", TagSetting::NO));
+    REQUIRE(tag_map.clearTag(L"1", L"red"));
+    REQUIRE(tag_map.setRating(L"2", 5.0f));
+    REQUIRE(tag_map.clearRating(L"4"));
+    REQUIRE(tag_map.removeFile(L"6"));
+    REQUIRE(tag_map.removeFile(L"7"));
+    REQUIRE(tag_map.renameTag(L"blue", L"green"));
+
+    const auto check_counts = [](const TagMap& map) {
+      for (const auto& [tag, properties] : map.getAllTags()) {
+        TagSettingCounts expected;
+        for (const auto& path : map.getAllFiles()) {
+          const auto setting = *map.getTagSetting(path, tag);
+          ++(setting == TagSetting::YES ? expected.yes
+            : setting == TagSetting::NO ? expected.no : expected.uncommitted);
+        }
+        CHECK(map.getTagSettingCounts(tag) == expected);
+        CHECK(map.countFilesByTags({ {.tag = tag } }, true) == expected.yes);
+      }
+
+      for (float min_rating = 0.0f; min_rating <= 5.0f; min_rating += 1.0f) {
+        const auto is_in_range = [min_rating](const TagMap::FileInfo& info) {
+          return info.rating.has_value() && *info.rating >= min_rating && *info.rating <= 4.0f;
+          };
+        CHECK(map.countRatedFiles(min_rating, 4.0f) == map.selectFiles(is_in_range).size());
+        CHECK(map.countFiles(is_in_range) == map.selectFiles(is_in_range).size());
+      }
+      };
+    check_counts(tag_map);
+    check_counts(TagMap(tag_map));
+
+    CHECK(!tag_map.getTagSettingCounts(L"blue").has_value());
+    CHECK(tag_map.countRatedFiles(3.0f, 2.0f) == 0);
+    CHECK(tag_map.countFiles({}) == 148);
+    CHECK(tag_map.countFilesByTags({}, true) == 148);
+    CHECK(tag_map.countFilesByTags({}, false) == 0);
+  }
+
+  TEST_CASE("PathTrigramIndex add(), remove(), findCandidates()", "[all][PathTrigramIndex-1]") {
+    PathTrigramIndex index;
+    index.add(0, L"C:/Clips/Beach Sunset.mp4");
+    index.add(1, L"C:/Clips/beach_day.mov");
+    index.add(2, L"C:/Photos/Sunrise.jpg");
+    index.add(4, L"C:/Clips/Mountain.mp4");
+
+    CHECK(!index.findCandidates(L"").has_value());
+    CHECK(!index.findCandidates(L"be").has_value());
+    CHECK(index.findCandidates(L"BEACH") == std::vector<int>{ 0, 1 });
+    CHECK(index.findCandidates(L"sun") == std::vector<int>{ 0, 2 });
+    CHECK(index.findCandidates(L".mp4") == std::vector<int>{ 0, 4 });
+    CHECK(index.findCandidates(L"clips/") == std::vector<int>{ 0, 1, 4 });
+    CHECK(index.findCandidates(L"volcano")->empty());
+
+    // Candidates contain every trigram of the needle but needn't contain the needle itself.
+    index.add(3, L"abcd bcde");
+    CHECK(index.findCandidates(L"abcde") == std::vector<int>{ 3 });
+
+    index.remove(0, L"C:/Clips/Beach Sunset.mp4");
+    CHECK(index.findCandidates(L"beach") == std::vector<int>{ 1 });
+    CHECK(index.findCandidates(L"sunset")->empty());
+    index.add(0, L"C:/Clips/Beach Sunset.mp4");
+    CHECK(index.findCandidates(L"beach") == std::vector<int>{ 0, 1 });
+
+    index.clear();
+    CHECK(index.findCandidates(L"beach")->empty());
+    CHECK(PathTrigramIndex::foldCase(L"MiXeD") == L"mixed");
+  }
+
+  TEST_CASE("TagMap selectFileIdsByPath()", "[all][TagMap-14]") {
+    TagMap tag_map;
+    for (int i = 0; i < 300; ++i) {
+      REQUIRE(tag_map.addFile(L"Dir" + std::to_wstring(i % 7) + L"/Clip_" + std::to_wstring(i)
+        + (i % 2 == 0 ? L".MP4" : L".mov")));
+    }
+    REQUIRE(tag_map.removeFile(L"Dir0/Clip_0.MP4"));
+    REQUIRE(tag_map.removeFile(L"Dir3/Clip_3.mov"));
+
+    const auto expected = [&](const std::wstring& substring) {
+      std::vector<file_id_t> returning;
+      for (const auto& path : tag_map.getAllFiles()) {
+        if (PathTrigramIndex::foldCase(path.wstring()).find(PathTrigramIndex::foldCase(substring))
+          != std::wstring::npos) {
+          returning.push_back(*tag_map.getFileId(path));
+        }
+      }
+      std::sort(returning.begin(), returning.end());
+      return returning;
+      };
+    for (const std::wstring substring : { L"", L"3", L"_1", L"clip_2", L".mp4", L"DIR3/CLIP",
+      L"clip_3.mov", L"clip_0.mp4", L"nothing" }) {
+      CHECK(tag_map.selectFileIdsByPath(substring) == expected(substring));
+    }
+    CHECK(tag_map.selectFileIdsByPath(L"clip_0.mp4").empty());
+    CHECK(TagMap(tag_map).selectFileIdsByPath(L"dir2/") == expected(L"dir2/"));
+  }
+
+  TEST_CASE("FuzzyFinder build(), find()", "[all][FuzzyFinder-1]") {
+    const std::vector<path_t> paths = {
+      L"C:/Clips/clip_01.mp4",
+      L"C:/Clips/Beach/sunset.mp4",
+      L"C:/Clips/Beach/sunrise.MOV",
+      L"C:/Clips/clip_archive/notes.txt",
+      L"D:/Music/Sun Song.wav",
+      L"C:/Clips/beach_sunset_long_version.mp4",
+    };
+    FuzzyFinder finder;
+    finder.build(paths);
+    REQUIRE(finder.size() == paths.size());
+    const auto budget = std::chrono::seconds(10);
+    const auto indices_of = [](const FuzzyFinder::Result& result) {
+      std::vector<int> indices;
+      for (const auto& match : result.matches) {
+        indices.push_back(match.index);
+      }
+      return indices;
+      };
+
+    // Every path containing the characters in order matches, ignoring case.
+    const auto sunset = finder.find(L"SunSet", 10, budget);
+    CHECK(sunset.is_complete);
+    auto sunset_indices = indices_of(sunset);
+    std::sort(sunset_indices.begin(), sunset_indices.end());
+    CHECK(sunset_indices == std::vector<int>{ 1, 5 });
+    // A whole-word match within the file name beats a longer, scattered one.
+    CHECK(sunset.matches.front().index == 1);
+    CHECK(std::is_sorted(sunset.matches.begin(), sunset.matches.end(),
+      [](const FuzzyFinder::Match& lhs, const FuzzyFinder::Match& rhs) {
+        return lhs.score > rhs.score;
+      }));
+
+    // Matches within the file name beat matches within directory names.
+    CHECK(finder.find(L"clip", 10, budget).matches.front().index == 0);
+    CHECK(finder.find(L"ssw", 10, budget).matches.size() == 1);
+    CHECK(finder.find(L"zzz", 10, budget).matches.empty());
+    CHECK(finder.find(L"mp4", 2, budget).matches.size() == 2);
+    CHECK(finder.find(L"", 10, budget).matches.size() == paths.size());
+    CHECK(finder.find(L"clip", 0, budget).matches.empty());
+
+    // A search that runs out of time still returns what it found.
+    std::vector<path_t> many_paths;
+    for (int i = 0; i < 100000; ++i) {
+      many_paths.push_back(L"Folder" + std::to_wstring(i % 97) + L"/clip_" + std::to_wstring(i)
+        + L".mp4");
+    }
+    finder.build(many_paths);
+    CHECK(!finder.find(L"clip", 10, std::chrono::nanoseconds(0)).is_complete);
+    const auto all = finder.find(L"f9/clip_9", 10, budget);
+    CHECK(all.is_complete);
+    CHECK(all.matches.size() == 10);
+
+    // Resuming a search that ran out of time reaches every path and finds the same matches.
+    auto resumed = finder.find(L"f9/clip_9", 10, std::chrono::nanoseconds(0));
+    int num_resumes = 0;
+    while (!resumed.is_complete) {
+      const size_t next_index = resumed.next_index;
+      resumed = finder.resume(L"f9/clip_9", 10, std::chrono::nanoseconds(0), resumed);
+      CHECK((resumed.is_complete || resumed.next_index > next_index));
+      ++num_resumes;
+    }
+    CHECK(num_resumes > 0);
+    CHECK(indices_of(resumed) == indices_of(all));
+  }
+
+  TEST_CASE("CopyEngine start(), takeReport(), run()", "[all][CopyEngine-1]") {
+    const path_t root = std::filesystem::temp_directory_path() / "ragtag_copy_engine";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "a");
+    std::filesystem::create_directories(root / "b");
+    std::filesystem::create_directories(root / "out");
+    const std::string large_content(100000, 'x');
+    std::ofstream(root / "a" / "large.mp4", std::ios::binary) << large_content;
+    std::ofstream(root / "a" / "clip.mp4", std::ios::binary) << "first";
+    std::ofstream(root / "b" / "clip.mp4", std::ios::binary) << "second";
+    std::ofstream(root / "a" / "taken.mp4", std::ios::binary) << "newer";
+    std::ofstream(root / "out" / "taken.mp4", std::ios::binary) << "old";
+
+    const auto read_file = [](const path_t& path) {
+      std::ifstream in(path, std::ios::binary);
+      return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+      };
+    const std::vector<CopyJob> jobs = {
+      {root / "a" / "large.mp4", root / "out" / "large.mp4"},
+      {root / "a" / "clip.mp4", root / "out" / "clip.mp4"},
+      {root / "b" / "clip.mp4", root / "out" / "clip.mp4"},
+      {root / "a" / "taken.mp4", root / "out" / "taken.mp4"},
+      {root / "a" / "missing.mp4", root / "out" / "missing.mp4"},
+    };
+
+    for (const bool use_kernel_copy : {true, false}) {
+      std::filesystem::remove(root / "out" / "large.mp4");
+      std::filesystem::remove(root / "out" / "clip.mp4");
+      CopyOptions options;
+      options.num_threads = 3;
+      options.chunk_size = 4096;  // Many chunks per file
+      options.use_kernel_copy = use_kernel_copy;
+
+      CopyEngine engine(options);
+      engine.start(jobs);
+      const CopyReport report = engine.takeReport();
+      REQUIRE(report.results.size() == jobs.size());
+      CHECK(!report.was_canceled);
+      CHECK(report.results[0].outcome == CopyOutcome::COPIED);
+      CHECK(report.results[0].bytes == large_content.size());
+      CHECK(report.results[1].outcome == CopyOutcome::COPIED);
+      CHECK(report.results[2].outcome == CopyOutcome::CONFLICTED);
+      CHECK(report.results[3].outcome == CopyOutcome::CONFLICTED);
+      CHECK(report.results[4].outcome == CopyOutcome::FAILED);
+      CHECK(report.results[4].error);
+      CHECK(report.count(CopyOutcome::CONFLICTED) == 2);
+      CHECK(read_file(root / "out" / "large.mp4") == large_content);
+      CHECK(read_file(root / "out" / "clip.mp4") == "first");
+      CHECK(read_file(root / "out" / "taken.mp4") == "old");
+
+      const CopyProgress progress = engine.getProgress();
+      CHECK(progress.files_done == progress.files_total);
+      CHECK(progress.files_total == static_cast<int>(jobs.size()));
+      CHECK(progress.bytes_done == progress.bytes_total);
+      // The duplicate destination is turned away without its source being measured.
+      CHECK(progress.bytes_total == large_content.size() + 5 + 5);
+      CHECK(engine.takeReport().results.empty());
+    }
+
+    // Running the export again recognizes the copies already made.
+    const CopyReport rerun = CopyEngine::run({jobs[0], jobs[1]}, CopyOptions());
+    CHECK(rerun.count(CopyOutcome::SKIPPED) == 2);
+    CopyOptions strict_options;
+    strict_options.skip_identical = false;
+    CHECK(CopyEngine::run({jobs[0]}, strict_options).results[0].outcome
+      == CopyOutcome::CONFLICTED);
+
+    // A canceled batch leaves only complete copies behind.
+    std::vector<CopyJob> many_jobs;
+    for (int i = 0; i < 50; ++i) {
+      many_jobs.push_back({root / "a" / "large.mp4",
+        root / "out" / ("copy" + std::to_string(i) + ".mp4")});
+    }
+    CopyOptions slow_options;
+    slow_options.num_threads = 2;
+    slow_options.chunk_size = 1024;
+    slow_options.use_kernel_copy = false;
+    CopyEngine engine(slow_options);
+    engine.start(many_jobs);
+    engine.cancel();
+    const CopyReport canceled = engine.takeReport();
+    CHECK(canceled.count(CopyOutcome::COPIED) + canceled.count(CopyOutcome::CANCELED) == 50);
+    for (const auto& result : canceled.results) {
+      if (result.outcome == CopyOutcome::CANCELED) {
+        CHECK(!std::filesystem::exists(result.job.destination));
+      }
+      else {
+        CHECK(read_file(result.job.destination) == large_content);
+      }
+    }
+
+    std::filesystem::remove_all(root);
+  }
+
+  TEST_CASE("CopyEngine link modes and fallback", "[all][CopyEngine-2]") {
+    const path_t root = std::filesystem::temp_directory_path() / "ragtag_copy_engine_links";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "in");
+    std::filesystem::create_directories(root / "out");
+    const path_t source = root / "in" / "clip.mp4";
+    std::ofstream(source, std::ios::binary) << "contents";
+    const auto read_file = [](const path_t& path) {
+      std::ifstream in(path, std::ios::binary);
+      return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+      };
+
+    CopyOptions options;
+    options.mode = CopyMode::HARD_LINK;
+    const CopyResult hard = CopyEngine::run({{source, root / "out" / "hard.mp4"}}, options)
+      .results[0];
+    CHECK(hard.outcome == CopyOutcome::COPIED);
+    CHECK(hard.mode == CopyMode::HARD_LINK);
+    CHECK(!hard.fallback_reason);
+    CHECK(std::filesystem::equivalent(source, root / "out" / "hard.mp4"));
+    // An existing link to the same file counts as done.
+    CHECK(CopyEngine::run({{source, root / "out" / "hard.mp4"}}, options).results[0].outcome
+      == CopyOutcome::SKIPPED);
+
+    options.mode = CopyMode::SYMBOLIC_LINK;
+    const CopyResult symbolic = CopyEngine::run({{source, root / "out" / "symbolic.mp4"}},
+      options).results[0];
+    CHECK(symbolic.outcome == CopyOutcome::COPIED);
+    if (symbolic.mode == CopyMode::SYMBOLIC_LINK) {
+      CHECK(std::filesystem::is_symlink(root / "out" / "symbolic.mp4"));
+      CHECK(std::filesystem::read_symlink(root / "out" / "symbolic.mp4")
+        == std::filesystem::absolute(source));
+    }
+    else {
+      // Symbolic links may need privileges the test doesn't have.
+      CHECK(symbolic.fallback_reason);
+    }
+
+    // Reflinks work only on some file systems. Elsewhere, the file is copied and the reason noted.
+    options.mode = CopyMode::REFLINK;
+    const CopyResult reflink = CopyEngine::run({{source, root / "out" / "reflink.mp4"}},
+      options).results[0];
+    CHECK(reflink.outcome == CopyOutcome::COPIED);
+    CHECK((reflink.mode == CopyMode::REFLINK) != static_cast<bool>(reflink.fallback_reason));
+    CHECK(!std::filesystem::is_symlink(root / "out" / "reflink.mp4"));
+    CHECK(!std::filesystem::equivalent(source, root / "out" / "reflink.mp4"));
+    CHECK(read_file(root / "out" / "reflink.mp4") == "contents");
+
+    // Existing files still aren't replaced.
+    options.mode = CopyMode::HARD_LINK;
+    std::ofstream(root / "out" / "taken.mp4", std::ios::binary) << "something else";
+    CHECK(CopyEngine::run({{source, root / "out" / "taken.mp4"}}, options).results[0].outcome
+      == CopyOutcome::CONFLICTED);
+    CHECK(read_file(root / "out" / "taken.mp4") == "something else");
+
+    std::filesystem::remove_all(root);
+  }
+
+  TEST_CASE("CopyEngine verification and writeManifest()", "[all][CopyEngine-3]") {
+    const path_t root = std::filesystem::temp_directory_path() / "ragtag_copy_engine_verify";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "in");
+    std::filesystem::create_directories(root / "out");
+    const path_t check = root / "in" / "check.jpg";
+    const path_t other = root / "in" / "other.jpg";
+    std::ofstream(check, std::ios::binary) << "123456789";
+    std::ofstream(other, std::ios::binary) << "abcdefghi";
+    const auto read_file = [](const path_t& path) {
+      std::ifstream in(path, std::ios::binary);
+      return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+      };
+
+    CopyOptions options;
+    options.verify = true;
+    options.chunk_size = 4;  // Several chunks per file, so hashing overlaps with reading
+    CopyEngine engine(options);
+    engine.start({{check, root / "out" / "check.jpg"}, {other, root / "out" / "other.jpg"}});
+    const CopyReport report = engine.takeReport();
+    REQUIRE(report.results.size() == 2);
+    CHECK(report.count(CopyOutcome::COPIED) == 2);
+    // Verified bytes are counted once when copied and again when read back.
+    CHECK(engine.getProgress().bytes_total == 36);
+    CHECK(engine.getProgress().bytes_done == 36);
+    // The standard check value of CRC-32.
+    CHECK(report.results[0].checksum == 0xCBF43926u);
+    CHECK(report.results[0].destination_checksum == report.results[0].checksum);
+    CHECK(report.results[1].checksum == static_cast<std::uint32_t>(
+      crc32(0L, reinterpret_cast<const Bytef*>("abcdefghi"), 9)));
+    CHECK(read_file(root / "out" / "check.jpg") == "123456789");
+
+    // Unverified copies carry no checksums.
+    options.verify = false;
+    const CopyResult unverified = CopyEngine::run({{check, root / "out" / "plain.jpg"}}, options)
+      .results[0];
+    CHECK(unverified.outcome == CopyOutcome::COPIED);
+    CHECK(!unverified.checksum.has_value());
+
+    // A destination with the source's size and timestamp but different contents is skipped
+    // unless verifying.
+    std::ofstream(root / "out" / "other.jpg", std::ios::binary | std::ios::trunc) << "ABCDEFGHI";
+    std::filesystem::last_write_time(root / "out" / "other.jpg",
+      std::filesystem::last_write_time(other));
+    CHECK(CopyEngine::run({{other, root / "out" / "other.jpg"}}, options).results[0].outcome
+      == CopyOutcome::SKIPPED);
+    options.verify = true;
+    const CopyReport rerun = CopyEngine::run(
+      {{check, root / "out" / "check.jpg"}, {other, root / "out" / "other.jpg"}}, options);
+    CHECK(rerun.results[0].outcome == CopyOutcome::SKIPPED);
+    CHECK(rerun.results[0].checksum == 0xCBF43926u);
+    CHECK(rerun.results[1].outcome == CopyOutcome::CONFLICTED);
+    CHECK(rerun.results[1].destination_checksum != rerun.results[1].checksum);
+    CHECK(read_file(root / "out" / "other.jpg") == "ABCDEFGHI");
+
+    // Links are checksummed too.
+    options.mode = CopyMode::HARD_LINK;
+    const CopyResult link = CopyEngine::run({{check, root / "out" / "link.jpg"}}, options)
+      .results[0];
+    CHECK(link.outcome == CopyOutcome::COPIED);
+    CHECK(link.checksum == 0xCBF43926u);
+
+    // Only files known to match their checksums are listed, relative to the manifest.
+    CHECK(CopyEngine::writeManifest(rerun, root / "out" / "manifest.sfv"));
+    CHECK(read_file(root / "out" / "manifest.sfv")
+      == "; Generated by RagTag\ncheck.jpg CBF43926\n");
+    CHECK(CopyEngine::writeManifest(report, root / "manifest.sfv"));
+    const std::string manifest = read_file(root / "manifest.sfv");
+    CHECK(manifest.find("out/check.jpg CBF43926\n") != std::string::npos);
+    CHECK(manifest.find("out/other.jpg ") != std::string::npos);
+    CHECK(!CopyEngine::writeManifest(report, root / "missing" / "manifest.sfv"));
+
+    std::filesystem::remove_all(root);
+  }
+
+  TEST_CASE("ExportNamer planNames(), countNameCollisions()", "[all][ExportNamer-1]") {
+    const std::vector<path_t> sources = {
+      "/clips/2023/beach/clip.mp4",
+      "/clips/2024/beach/clip.mp4",
+      "/clips/2024/park/clip.mp4",
+      "/clips/2024/park/sunset.mp4",
+      "/clips/beach_clip.mp4",
+    };
+    CHECK(ExportNamer::countNameCollisions(sources) == 3);
+    CHECK(ExportNamer::countNameCollisions({sources[0], sources[3]}) == 0);
+
+    const auto numbered = ExportNamer::planNames(sources, ExportNaming::NUMBERED);
+    CHECK(numbered == std::vector<path_t>{"clip.mp4", "clip (2).mp4", "clip (3).mp4", "sunset.mp4",
+      "beach_clip.mp4"});
+
+    // Prefixes grow only until names are distinct, and unique names are left alone.
+    const auto prefixed = ExportNamer::planNames(sources, ExportNaming::PARENT_PREFIX);
+    CHECK(prefixed == std::vector<path_t>{"2023_beach_clip.mp4", "2024_beach_clip.mp4",
+      "park_clip.mp4", "sunset.mp4", "beach_clip.mp4"});
+
+    const auto hashed = ExportNamer::planNames(sources, ExportNaming::PATH_HASH);
+    REQUIRE(hashed.size() == sources.size());
+    CHECK(hashed[3] == "sunset.mp4");
+    CHECK(hashed[4] == "beach_clip.mp4");
+    for (int i = 0; i < 3; ++i) {
+      CHECK(hashed[i].extension() == ".mp4");
+      CHECK(hashed[i].stem().string().size() == std::string("clip_01234567").size());
+    }
+    CHECK(std::set<path_t>(hashed.begin(), hashed.end()).size() == sources.size());
+    // The same file gets the same name whatever else is exported alongside it.
+    CHECK(ExportNamer::planNames({sources[2], sources[0]}, ExportNaming::PATH_HASH)[1]
+      == hashed[0]);
+
+    const auto mirrored = ExportNamer::planNames(sources, ExportNaming::MIRRORED_TREE);
+    CHECK(mirrored == std::vector<path_t>{path_t("2023") / "beach" / "clip.mp4",
+      path_t("2024") / "beach" / "clip.mp4", path_t("2024") / "park" / "clip.mp4",
+      path_t("2024") / "park" / "sunset.mp4", "beach_clip.mp4"});
+    CHECK(ExportNamer::planNames({"/clips/a/x.mp4"}, ExportNaming::MIRRORED_TREE)
+      == std::vector<path_t>{"x.mp4"});
+
+    // Counters never take a name that another file already has.
+    CHECK(ExportNamer::planNames({"/a/clip.mp4", "/b/clip.mp4", "/c/clip (2).mp4"},
+      ExportNaming::NUMBERED) == std::vector<path_t>{"clip.mp4", "clip (3).mp4", "clip (2).mp4"});
+    CHECK(ExportNamer::planNames({}, ExportNaming::PARENT_PREFIX).empty());
+  }
+
+  TEST_CASE("ZipExporter start(), takeReport(), isStoredFormat()", "[all][ZipExporter-1]") {
+    const path_t root = std::filesystem::temp_directory_path() / "ragtag_zip_exporter";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "in");
+    std::string notes;
+    for (int i = 0; notes.size() < 300000; ++i) {
+      notes += "Take " + std::to_string(i) + ": the light was better this time.\n";
+    }
+    std::string clip;
+    std::uint32_t state = 12345;
+    for (int i = 0; i < 100000; ++i) {
+      state = state * 1103515245 + 12345;
+      clip += static_cast<char>(state >> 24);
+    }
+    std::ofstream(root / "in" / "notes.txt", std::ios::binary) << notes;
+    std::ofstream(root / "in" / "clip.MP4", std::ios::binary) << clip;
+    std::ofstream(root / "in" / "empty.txt", std::ios::binary);
+
+    CHECK(ZipExporter::isStoredFormat("a/clip.MP4"));
+    CHECK(ZipExporter::isStoredFormat("photo.jpeg"));
+    CHECK(!ZipExporter::isStoredFormat("notes.txt"));
+    CHECK(!ZipExporter::isStoredFormat("raw.wav"));
+
+    ZipOptions options;
+    options.num_threads = 3;
+    options.block_size = 65536;  // Several rounds of several blocks
+    const path_t archive = root / "out.zip";
+    const CopyReport report = ZipExporter::run({
+      {root / "in" / "notes.txt", path_t("day 1") / "notes.txt"},
+      {root / "in" / "clip.MP4", "clip.MP4"},
+      {root / "in" / "missing.mp4", "missing.mp4"},
+      {root / "in" / "empty.txt", "empty.txt"},
+      {root / "in" / "clip.MP4", "clip.MP4"},
+      }, archive, options);
+    REQUIRE(report.results.size() == 5);
+    CHECK(report.results[0].outcome == CopyOutcome::COPIED);
+    CHECK(report.results[1].outcome == CopyOutcome::COPIED);
+    CHECK(report.results[2].outcome == CopyOutcome::FAILED);
+    CHECK(report.results[3].outcome == CopyOutcome::COPIED);
+    CHECK(report.results[4].outcome == CopyOutcome::CONFLICTED);
+
+    // Read the archive back through its ZIP64 end records and central directory.
+    std::ifstream in(archive, std::ios::binary);
+    const std::string zip((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const auto get = [&zip](const size_t offset, const int size) {
+      std::uint64_t value = 0;
+      for (int i = size - 1; i >= 0; --i) {
+        value = (value << 8) | static_cast<unsigned char>(zip[offset + i]);
+      }
+      return value;
+      };
+    REQUIRE(zip.size() > 98);
+    const size_t end_offset = zip.size() - 22;
+    CHECK(get(end_offset, 4) == 0x06054b50);
+    CHECK(get(end_offset - 20, 4) == 0x07064b50);
+    const size_t zip64_end_offset = get(end_offset - 20 + 8, 8);
+    CHECK(get(zip64_end_offset, 4) == 0x06064b50);
+    CHECK(get(zip64_end_offset + 32, 8) == 3);
+
+    std::map<std::string, std::string> contents;
+    std::map<std::string, std::uint64_t> methods;
+    size_t entry_offset = get(zip64_end_offset + 48, 8);
+    for (int i = 0; i < 3; ++i) {
+      REQUIRE(get(entry_offset, 4) == 0x02014b50);
+      const auto method = get(entry_offset + 10, 2);
+      const auto crc = get(entry_offset + 16, 4);
+      const size_t name_length = get(entry_offset + 28, 2);
+      const size_t extra_length = get(entry_offset + 30, 2);
+      const std::string name = zip.substr(entry_offset + 46, name_length);
+      const size_t extra_offset = entry_offset + 46 + name_length;
+      CHECK(get(extra_offset, 2) == 1);
+      const auto size = get(extra_offset + 4, 8);
+      const auto compressed_size = get(extra_offset + 12, 8);
+      const size_t local_offset = get(extra_offset + 20, 8);
+      REQUIRE(get(local_offset, 4) == 0x04034b50);
+      const size_t data_offset = local_offset + 30 + get(local_offset + 26, 2)
+        + get(local_offset + 28, 2);
+      const std::string data = zip.substr(data_offset, compressed_size);
+
+      std::string extracted = data;
+      if (method == 8) {
+        extracted.assign(size, '\0');
+        z_stream stream{};
+        REQUIRE(inflateInit2(&stream, -MAX_WBITS) == Z_OK);
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        stream.avail_in = static_cast<uInt>(data.size());
+        stream.next_out = reinterpret_cast<Bytef*>(extracted.data());
+        stream.avail_out = static_cast<uInt>(extracted.size());
+        CHECK(inflate(&stream, Z_FINISH) == Z_STREAM_END);
+        CHECK(stream.total_out == size);
+        inflateEnd(&stream);
+      }
+      CHECK(crc32(0L, reinterpret_cast<const Bytef*>(extracted.data()),
+        static_cast<uInt>(extracted.size())) == crc);
+      contents[name] = extracted;
+      methods[name] = method;
+      entry_offset = extra_offset + extra_length;
+    }
+    CHECK(contents["day 1/notes.txt"] == notes);
+    CHECK(contents["clip.MP4"] == clip);
+    CHECK(contents["empty.txt"].empty());
+    CHECK(methods["day 1/notes.txt"] == 8);
+    CHECK(methods["clip.MP4"] == 0);
+    // Text compresses well even in independent blocks.
+    CHECK(zip.size() < notes.size() / 4 + clip.size() + 1000);
+
+    // A canceled archive is deleted.
+    ZipExporter exporter(options);
+    exporter.start({{root / "in" / "notes.txt", "notes.txt"}}, root / "canceled.zip");
+    exporter.cancel();
+    if (exporter.takeReport().was_canceled) {
+      CHECK(!std::filesystem::exists(root / "canceled.zip"));
+    }
+
+    std::filesystem::remove_all(root);
+  }
+
+  TEST_CASE("CopyEngine throughput", "[.][benchmark][CopyEngine-Benchmark]") {
+    const path_t root = std::filesystem::temp_directory_path() / "ragtag_copy_benchmark";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "in");
+    const std::string content(4 << 20, 'x');
+    std::vector<path_t> sources;
+    for (int i = 0; i < 32; ++i) {
+      sources.push_back(root / "in" / ("clip" + std::to_string(i) + ".mp4"));
+      std::ofstream(sources.back(), std::ios::binary) << content;
+    }
+
+    // Each run copies the whole set into a fresh directory so that nothing is skipped.
+    const auto make_jobs = [&](const int run) {
+      const path_t directory = root / ("out" + std::to_string(run));
+      std::filesystem::remove_all(directory);
+      std::filesystem::create_directories(directory);
+      std::vector<CopyJob> jobs;
+      for (const auto& source : sources) {
+        jobs.push_back({source, directory / source.filename()});
+      }
+      return jobs;
+      };
+    const auto benchmark_engine = [&](Catch::Benchmark::Chronometer meter,
+      const CopyOptions& options) {
+        std::vector<std::vector<CopyJob>> jobs_per_run;
+        for (int i = 0; i < meter.runs(); ++i) {
+          jobs_per_run.push_back(make_jobs(i));
+        }
+        meter.measure([&](const int run) {
+          return CopyEngine::run(jobs_per_run[run], options).count(CopyOutcome::COPIED);
+          });
+      };
+
+    BENCHMARK_ADVANCED("std::filesystem::copy_file, one file at a time")(
+      Catch::Benchmark::Chronometer meter) {
+      std::vector<std::vector<CopyJob>> jobs_per_run;
+      for (int i = 0; i < meter.runs(); ++i) {
+        jobs_per_run.push_back(make_jobs(i));
+      }
+      meter.measure([&](const int run) {
+        int num_copied = 0;
+        for (const auto& job : jobs_per_run[run]) {
+          num_copied += std::filesystem::copy_file(job.source, job.destination) ? 1 : 0;
+        }
+        return num_copied;
+        });
+    };
+    for (const int num_threads : {1, 4}) {
+      for (const bool use_kernel_copy : {false, true}) {
+        CopyOptions options;
+        options.num_threads = num_threads;
+        options.use_kernel_copy = use_kernel_copy;
+        BENCHMARK_ADVANCED("CopyEngine, " + std::to_string(num_threads) + " thread(s), "
+          + (use_kernel_copy ? "kernel copy" : "buffered"))(Catch::Benchmark::Chronometer meter) {
+          benchmark_engine(meter, options);
+        };
+      }
+    }
+    const std::vector<std::pair<CopyMode, std::string>> link_modes = {
+      {CopyMode::REFLINK, "reflinks"},
+      {CopyMode::HARD_LINK, "hard links"},
+      {CopyMode::SYMBOLIC_LINK, "symbolic links"},
+    };
+    for (const auto& [mode, name] : link_modes) {
+      CopyOptions options;
+      options.mode = mode;
+      BENCHMARK_ADVANCED("CopyEngine, " + name)(Catch::Benchmark::Chronometer meter) {
+        benchmark_engine(meter, options);
+      };
+    }
+    CopyOptions verified_options;
+    verified_options.num_threads = 4;
+    verified_options.verify = true;
+    BENCHMARK_ADVANCED("CopyEngine, 4 thread(s), verified")(Catch::Benchmark::Chronometer meter) {
+      benchmark_engine(meter, verified_options);
+    };
+
+    std::filesystem::remove_all(root);
+  }
+
 }  // namespace ragtag